@@ -8,23 +8,33 @@ APP_VERSION = "0.9"
 TARGET = $$APP_NAME
 TEMPLATE = app
 
+include(core.pri)
+
 SOURCES += \
+    src/accumulator.cpp \
     src/actionbutton.cpp \
-    src/crc.cpp \
     src/find.cpp \
     src/labelled.cpp \
+    src/linebuffer.cpp \
+    src/logfile.cpp \
     src/main.cpp \
     src/mainwindow.cpp \
     src/console.cpp \
+    src/searcher.cpp \
+    src/sessions.cpp \
     src/settings.cpp
 
 HEADERS += \
+    src/accumulator.h \
     src/actionbutton.h \
-    src/crc.h \
     src/find.h \
     src/labelled.h \
+    src/linebuffer.h \
+    src/logfile.h \
     src/mainwindow.h \
     src/console.h \
+    src/searcher.h \
+    src/sessions.h \
     src/settings.h
 
 FORMS += \
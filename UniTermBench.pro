@@ -0,0 +1,52 @@
+QT += widgets
+
+APP_NAME = "UniTerm"
+APP_DESCRIPTION = "Universal terminal (benchmark)"
+APP_COPYRIGHT = "Copyright 2024 Oleg Bolshakov"
+APP_VERSION = "0.9"
+
+TARGET = UniTermBench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(core.pri)
+
+SOURCES += \
+    src/accumulator.cpp \
+    src/bench.cpp \
+    src/benchmain.cpp \
+    src/console.cpp \
+    src/linebuffer.cpp \
+    src/logfile.cpp \
+    src/searcher.cpp
+
+HEADERS += \
+    src/accumulator.h \
+    src/bench.h \
+    src/console.h \
+    src/linebuffer.h \
+    src/logfile.h \
+    src/searcher.h
+
+DEFINES += \
+    APP_NAME=\\\"$$APP_NAME\\\" \
+    APP_VERSION=\\\"$$APP_VERSION\\\"
+
+unix:!macx: LIBS += -lutil
+
+Release:DESTDIR = release
+Release:OBJECTS_DIR = release/.obj-bench
+Release:MOC_DIR = release/.moc-bench
+
+Debug:DESTDIR = debug
+Debug:OBJECTS_DIR = debug/.obj-bench
+Debug:MOC_DIR = debug/.moc-bench
+
+win32 {
+    QMAKE_TARGET_COMPANY = $$APP_NAME
+    QMAKE_TARGET_DESCRIPTION = $$APP_DESCRIPTION
+    QMAKE_TARGET_COPYRIGHT = $$APP_COPYRIGHT
+    QMAKE_TARGET_PRODUCT = $$APP_NAME
+    VERSION = $$APP_VERSION
+}
@@ -0,0 +1,40 @@
+QT -= gui
+
+APP_NAME = "UniTerm"
+APP_DESCRIPTION = "Universal terminal (console)"
+APP_COPYRIGHT = "Copyright 2024 Oleg Bolshakov"
+APP_VERSION = "0.9"
+
+TARGET = UniTermCli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(core.pri)
+
+SOURCES += \
+    src/cli.cpp \
+    src/climain.cpp
+
+HEADERS += \
+    src/cli.h
+
+DEFINES += \
+    APP_NAME=\\\"$$APP_NAME\\\" \
+    APP_VERSION=\\\"$$APP_VERSION\\\"
+
+Release:DESTDIR = release
+Release:OBJECTS_DIR = release/.obj-cli
+Release:MOC_DIR = release/.moc-cli
+
+Debug:DESTDIR = debug
+Debug:OBJECTS_DIR = debug/.obj-cli
+Debug:MOC_DIR = debug/.moc-cli
+
+win32 {
+    QMAKE_TARGET_COMPANY = $$APP_NAME
+    QMAKE_TARGET_DESCRIPTION = $$APP_DESCRIPTION
+    QMAKE_TARGET_COPYRIGHT = $$APP_COPYRIGHT
+    QMAKE_TARGET_PRODUCT = $$APP_NAME
+    VERSION = $$APP_VERSION
+}
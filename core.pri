@@ -0,0 +1,44 @@
+# Ядро без виджетов: подключение, кадры, преобразование, CRC, команды, перебор, автоответчик, журнал сеанса.
+# Общее для UniTerm.pro (окно) и UniTermCli.pro (консольный режим).
+
+QT += serialport network
+
+INCLUDEPATH += $$PWD/src
+
+SOURCES += \
+    $$PWD/src/bridge.cpp \
+    $$PWD/src/capture.cpp \
+    $$PWD/src/command.cpp \
+    $$PWD/src/converter.cpp \
+    $$PWD/src/crc.cpp \
+    $$PWD/src/enumerator.cpp \
+    $$PWD/src/filesender.cpp \
+    $$PWD/src/framer.cpp \
+    $$PWD/src/hexformatter.cpp \
+    $$PWD/src/iopool.cpp \
+    $$PWD/src/latency.cpp \
+    $$PWD/src/responder.cpp \
+    $$PWD/src/scheduler.cpp \
+    $$PWD/src/sessionlog.cpp \
+    $$PWD/src/timestamp.cpp \
+    $$PWD/src/transport.cpp
+
+HEADERS += \
+    $$PWD/src/bridge.h \
+    $$PWD/src/capture.h \
+    $$PWD/src/command.h \
+    $$PWD/src/connection.h \
+    $$PWD/src/converter.h \
+    $$PWD/src/crc.h \
+    $$PWD/src/enumerator.h \
+    $$PWD/src/filesender.h \
+    $$PWD/src/framer.h \
+    $$PWD/src/hexformatter.h \
+    $$PWD/src/iopool.h \
+    $$PWD/src/latency.h \
+    $$PWD/src/responder.h \
+    $$PWD/src/scheduler.h \
+    $$PWD/src/sessionlog.h \
+    $$PWD/src/spscqueue.h \
+    $$PWD/src/timestamp.h \
+    $$PWD/src/transport.h
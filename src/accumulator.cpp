@@ -0,0 +1,50 @@
+#include "accumulator.h"
+
+#include <QTimer>
+
+#define DEFAULT_REFRESH_RATE    60
+
+Accumulator::Accumulator(QObject *parent):
+    QObject(parent),
+    m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &Accumulator::flush);
+    setRate(DEFAULT_REFRESH_RATE);
+}
+
+int Accumulator::rate() const {
+    return m_rate;
+}
+
+void Accumulator::setRate(int fps) {
+    m_rate = qMax(0, fps);
+    m_interval = m_rate ? 1000000000LL / m_rate : 0;
+}
+
+void Accumulator::append(const QByteArray &data) {
+    if (data.isEmpty()) return;
+    m_data.append(data);
+    if (m_timer->isActive()) return;
+
+    const qint64 elapsed = m_last.isValid() ? m_last.nsecsElapsed() : m_interval;
+    if (elapsed >= m_interval) {
+        flush();                                    // редкие данные - без задержки
+    } else {
+        m_timer->start(int((m_interval - elapsed + 999999) / 1000000));
+    }
+}
+
+qsizetype Accumulator::pending() const {
+    return m_data.size();
+}
+
+void Accumulator::flush() {
+    m_timer->stop();
+    m_last.start();
+    if (m_data.isEmpty()) return;
+    QByteArray data;
+    data.swap(m_data);
+    emit ready(data);
+}
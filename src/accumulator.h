@@ -0,0 +1,38 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class QTimer;
+
+// Накопление данных для консоли: не чаще одного обновления за кадр.
+// Если данные приходят реже частоты кадров - передаются сразу.
+class Accumulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Accumulator(QObject *parent = nullptr);
+
+    int rate() const;
+    void setRate(int fps);                          // 0 - без ограничения
+
+    void append(const QByteArray &data);
+    qsizetype pending() const;                      // байт ожидает вывода
+
+public slots:
+    void flush();
+
+signals:
+    void ready(const QByteArray &data);
+
+private:
+    QByteArray m_data;
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_last;                           // время последнего вывода
+    int m_rate = 0;
+    qint64 m_interval = 0;                          // нс
+};
+
+#endif // ACCUMULATOR_H
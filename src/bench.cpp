@@ -0,0 +1,639 @@
+#include "bench.h"
+#include "transport.h"
+#include "accumulator.h"
+#include "console.h"
+#include "iopool.h"
+#include "timestamp.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <cstring>
+#include <utility>
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#else
+#include <sys/resource.h>
+#include <termios.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#if defined(Q_OS_MACOS)
+#include <util.h>
+#elif defined(Q_OS_LINUX)
+#include <pty.h>
+#else
+#include <libutil.h>
+#endif
+#endif
+
+#define DEFAULT_BAUD_RATE       115200              // псевдотерминал скорость не ограничивает
+#define DEFAULT_LINEFEED_CHAR   10
+
+// Генератор
+
+BenchGenerator::BenchGenerator(QObject *parent):
+    QObject(parent),
+    m_timer(new QTimer(this)),
+    m_server(new QTcpServer(this)),
+    m_udp(new QUdpSocket(this))
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(BENCH_TICK);
+    connect(m_timer, &QTimer::timeout, this, &BenchGenerator::tick);
+
+    connect(m_server, &QTcpServer::newConnection, this, [=]() {
+        while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+            if (m_peer) {
+                socket->abort();
+                socket->deleteLater();
+                continue;
+            }
+            m_peer = socket;
+            m_peer->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            // очередь сокета освободилась - не ждать следующего такта
+            connect(m_peer, &QTcpSocket::bytesWritten, this, &BenchGenerator::tick);
+        }
+    });
+}
+
+const std::vector<qint64> &BenchGenerator::sendTimes() const {
+    return m_sendTimes;
+}
+
+qint64 BenchGenerator::sent() const {
+    return m_sent;
+}
+
+quint16 BenchGenerator::setup(Connection::Type type, int fd, quint16 port) {
+    close();
+    m_type = type;
+    m_fd = fd;
+    m_port = port;
+    m_rest.clear();
+    m_sendTimes.clear();
+    m_sent = 0;
+    switch (m_type) {
+    case Connection::Tcp:
+        if (!m_server->listen(QHostAddress::LocalHost, 0)) return 0;
+        return m_server->serverPort();
+    case Connection::UdpUnicast:
+        return m_port;
+    default: // Connection::Serial
+#if !defined(Q_OS_WIN)
+        ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+#endif
+        return 0;
+    }
+}
+
+void BenchGenerator::start(qint64 rate, int size) {
+    // номер, пробел, печатные символы, перевод строки: разбор не зависит от вида вывода
+    m_packet.resize(size);
+    char *p = m_packet.data();
+    for (int i = BENCH_HEADER; i < size - 2; ++i) p[i] = (i == BENCH_HEADER) ? ' ' : char('a' + (i % 26));
+    p[size - 2] = '\r';
+    p[size - 1] = '\n';
+
+    m_rate = rate;
+    m_started = Timestamp::now();
+    m_timer->start();
+    tick();
+}
+
+void BenchGenerator::stop() {
+    m_timer->stop();
+}
+
+void BenchGenerator::close() {
+    stop();
+    if (m_peer) {
+        m_peer->abort();
+        m_peer->deleteLater();
+        m_peer = nullptr;
+    }
+    m_server->close();
+    m_fd = -1;
+}
+
+void BenchGenerator::tick() {
+    if (!m_timer->isActive()) return;
+    if (!m_rest.isEmpty()) {
+        const QByteArray rest = std::exchange(m_rest, QByteArray());
+        if (!writeSerial(rest.constData(), rest.size())) return;
+    }
+
+    qint64 budget = BENCH_BURST;
+    if (m_rate > 0) {
+        // отстав, генератор догоняет заданную скорость, но не более BENCH_BURST за такт
+        const qint64 elapsed = (Timestamp::now() - m_started) / 1000; // мкс
+        budget = qMin(budget, elapsed * m_rate / 1000000 - m_sent);
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    const int size = m_packet.size();
+    char *p = m_packet.data();
+    while (budget >= size && writable()) {
+        quint64 seq = m_sendTimes.size();
+        for (int i = BENCH_HEADER - 1; i >= 0; --i, seq >>= 4) p[i] = digits[seq & 0xf];
+        m_sendTimes.push_back(Timestamp::now());
+
+        if (m_type == Connection::Tcp) {
+            m_peer->write(p, size);
+        } else if (m_type == Connection::UdpUnicast) {
+            if (m_udp->writeDatagram(p, size, QHostAddress::LocalHost, m_port) < 0) {
+                m_sendTimes.pop_back();             // буфер сокета заполнен - повтор в следующем такте
+                break;
+            }
+        } else {
+            writeSerial(p, size);
+        }
+        m_sent += size;
+        budget -= size;
+    }
+}
+
+bool BenchGenerator::writable() const {
+    switch (m_type) {
+    case Connection::Tcp:
+        return m_peer && (m_peer->bytesToWrite() < BENCH_BACKLOG);
+    case Connection::UdpUnicast:
+        return true;
+    default: // Connection::Serial
+        return (m_fd >= 0) && m_rest.isEmpty();
+    }
+}
+
+bool BenchGenerator::writeSerial(const char *data, qint64 size) {
+#if defined(Q_OS_WIN)
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return false;
+#else
+    qint64 written = ::write(m_fd, data, size);
+    if (written < 0) written = 0;                   // EAGAIN - буфер псевдотерминала заполнен
+    if (written == size) return true;
+    m_rest = QByteArray(data + written, size - written);
+    return false;
+#endif
+}
+
+// Нагрузочный тест
+
+Bench::Bench(QObject *parent):
+    QObject(parent),
+    m_pool(new IoPool(this)),
+    m_threadGenerator(new QThread(this)),
+    m_generator(new BenchGenerator),
+    m_accumulator(new Accumulator(this)),
+    m_console(new Console),
+    m_timerDuration(new QTimer(this)),
+    m_timerDrain(new QTimer(this))
+{
+    m_generator->moveToThread(m_threadGenerator);
+    connect(m_threadGenerator, &QThread::finished, m_generator, &QObject::deleteLater);
+    m_threadGenerator->start(QThread::TimeCriticalPriority);
+
+    m_timerDuration->setSingleShot(true);
+    m_timerDuration->setTimerType(Qt::PreciseTimer);
+    m_timerDrain->setInterval(BENCH_DRAIN_CHECK);
+    connect(m_timerDuration, &QTimer::timeout, this, &Bench::stopGenerator);
+    connect(m_timerDrain, &QTimer::timeout, this, &Bench::drain);
+
+    // конец измерения задержки - передача в консоль; отрисовка выполняется позже в цикле событий
+    connect(m_accumulator, &Accumulator::ready, this, [=](const QByteArray &data) {
+        m_console->putData(data);
+        m_flushes.push_back({Timestamp::now(), m_received});
+    });
+
+    m_console->resize(800, 600);
+}
+
+Bench::~Bench() {
+    closeEndpoint();
+    m_threadGenerator->quit();
+    m_threadGenerator->wait();
+    delete m_console;
+}
+
+int Bench::start(const QStringList &arguments) {
+    const int code = parse(arguments);
+    if (code >= 0) return code;
+
+    if (!m_csv.fileName().isEmpty()) {
+        if (!m_csv.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            print(tr("Ошибка записи в '%1': %2").arg(m_csv.fileName(), m_csv.errorString()));
+            return ExitUsage;
+        }
+        m_csv.write(tr("Транспорт;Вид;Пакет, байт;Задано, байт/с;Отправлено;Принято;Потеряно;"
+                       "Байт/с;CPU, %;p50, мкс;p99, мкс;p99.9, мкс;Макс., мкс;Ошибка\n").toUtf8());
+    }
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                           .arg(tr("Транспорт"), -9).arg(tr("Вид"), -6)
+                           .arg(tr("Отправлено"), 12).arg(tr("Потеряно"), 10)
+                           .arg(tr("МБ/с"), 8).arg(tr("CPU,%"), 6)
+                           .arg(tr("p50,мкс"), 9).arg(tr("p99,мкс"), 9).arg(tr("p99.9,мкс"), 10)
+                        << " " << QString("%1").arg(tr("Макс.,мкс"), 10) << Qt::endl;
+
+    m_console->show();
+    QTimer::singleShot(0, this, &Bench::runNext);
+    return -1;
+}
+
+int Bench::parse(const QStringList &arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("%1 - нагрузочный тест приёма").arg(QCoreApplication::applicationName()));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+#if defined(Q_OS_WIN)
+    const QString transports = "tcp,udp";
+#else
+    const QString transports = "serial,tcp,udp";
+#endif
+    const QCommandLineOption transport(QStringList() << "t" << "transport", tr("Транспорты через запятую: serial (псевдотерминал), tcp, udp."), "list", transports);
+    const QCommandLineOption mode(QStringList() << "m" << "mode", tr("Виды вывода через запятую: text, hex, hexall, time."), "list", "text,hex,hexall,time");
+    const QCommandLineOption size(QStringList() << "s" << "size", tr("Размер пакета, байт."), "bytes", "64");
+    const QCommandLineOption rate(QStringList() << "r" << "rate", tr("Скорость отправки, байт/с, 0 - без ограничения."), "bytes", "1000000");
+    const QCommandLineOption duration(QStringList() << "d" << "duration", tr("Длительность сценария, мс."), "ms", "2000");
+    const QCommandLineOption refresh("refresh", tr("Частота обновления консоли, Гц, 0 - без ограничения."), "fps", "60");
+    const QCommandLineOption csv("csv", tr("Сохранить результаты в CSV."), "file");
+
+    parser.addOptions({transport, mode, size, rate, duration, refresh, csv});
+
+    if (!parser.parse(arguments)) {
+        print(parser.errorText());
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+    if (parser.isSet("version")) {
+        QTextStream(stdout) << QCoreApplication::applicationName() << " " << QCoreApplication::applicationVersion() << Qt::endl;
+        return ExitOk;
+    }
+
+    bool valid = true;
+    auto number = [&](const QCommandLineOption &option, qint64 min, qint64 max) -> qint64 {
+        bool ok;
+        const qint64 value = parser.value(option).toLongLong(&ok, 0);
+        if (!ok || value < min || value > max) {
+            print(tr("Недопустимое значение --%1: %2").arg(option.names().constLast(), parser.value(option)));
+            valid = false;
+        }
+        return value;
+    };
+    auto list = [&](const QCommandLineOption &option, const QStringList &values) -> QVector<int> {
+        QVector<int> res;
+        for (const QString &value : parser.value(option).toLower().split(',', Qt::SkipEmptyParts)) {
+            const int idx = values.indexOf(value.trimmed());
+            if (idx < 0) {
+                print(tr("Недопустимое значение --%1: %2").arg(option.names().constLast(), value));
+                valid = false;
+            } else if (!res.contains(idx)) {
+                res.append(idx);
+            }
+        }
+        if (res.isEmpty()) valid = false;
+        return res;
+    };
+
+    const QStringList types = {"serial", "tcp", "udp"};    // Connection::Type
+    const QStringList modes = {"text", "hex", "hexall", "time"};
+    const QVector<int> selectedTypes = list(transport, types);
+    const QVector<int> selectedModes = list(mode, modes);
+    m_size = int(number(size, BENCH_MIN_SIZE, 60000));      // датаграмма без фрагментации IPv4 - до 65507
+    m_rate = number(rate, 0, 10LL * 1000 * 1000 * 1000);
+    m_duration = int(number(duration, 100, 3600000));
+    m_refresh = int(number(refresh, 0, 1000));
+    if (!valid) return ExitUsage;
+#if defined(Q_OS_WIN)
+    if (selectedTypes.contains(Connection::Serial)) {
+        print(tr("Псевдотерминалы не поддерживаются"));
+        return ExitUsage;
+    }
+#endif
+
+    for (int type : selectedTypes) {
+        for (int idx : selectedModes) m_scenarios.append({Connection::Type(type), modes.at(idx)});
+    }
+    if (parser.isSet(csv)) m_csv.setFileName(parser.value(csv));
+    return -1;
+}
+
+void Bench::runNext() {
+    closeEndpoint();
+    m_accumulator->flush();                         // остаток прошлого сценария
+    if (++m_index >= m_scenarios.size()) {
+        m_csv.close();
+        emit finished(m_failed ? ExitOpen : ExitOk);
+        return;
+    }
+    const Scenario &scenario = m_scenarios.at(m_index);
+
+    m_sent = 0;
+    m_received = 0;
+    m_drained = 0;
+    m_idle = 0;
+    m_started = 0;
+    m_lastReceived = 0;
+    m_finished = 0;
+    m_offset = 0;
+    m_arrivals.clear();
+    m_flushes.clear();
+
+    Connection::Settings settings = defaultSettings();
+    settings.type = scenario.type;
+    settings.hexLog = (scenario.mode == "hex") || (scenario.mode == "hexall");
+    settings.hexAll = (scenario.mode == "hexall");
+    settings.timeStamp = (scenario.mode == "time");
+    settings.timeDelta = settings.timeStamp;
+    const QString error = openEndpoint(scenario, settings);
+    if (!error.isEmpty()) {
+        openError(error);
+        return;
+    }
+    m_converter.setSettings(settings);
+    m_converter.reset();
+    m_accumulator->setRate(m_refresh);
+    m_console->clear();
+
+    m_threadIo = m_pool->acquire();
+    m_transport = new Transport;
+    m_transport->moveToThread(m_threadIo);
+    connect(m_transport, &Transport::opened, this, &Bench::opened);
+    connect(m_transport, &Transport::readyRead, this, &Bench::transportReadyRead);
+    connect(m_transport, &Transport::openError, this, &Bench::openError);
+    connect(m_transport, &Transport::socketErrorOccurred, this, &Bench::socketError);
+    QMetaObject::invokeMethod(m_transport, [=]() { m_transport->open(settings); });
+}
+
+void Bench::opened() {
+    m_started = Timestamp::now();
+    m_cpuStart = cpuTime();
+    const qint64 rate = m_rate;
+    const int size = m_size;
+    QMetaObject::invokeMethod(m_generator, [=]() { m_generator->start(rate, size); });
+    m_timerDuration->start(m_duration);
+}
+
+void Bench::openError(const QString &message) {
+    ++m_failed;
+    report(message);
+    QTimer::singleShot(0, this, &Bench::runNext);
+}
+
+void Bench::socketError(QAbstractSocket::SocketError error, const QString &message) {
+    Q_UNUSED(error);
+    if (m_started == 0) openError(message);         // после подключения разрыв отражается в потерях
+}
+
+void Bench::transportReadyRead() {
+    Transport::Chunk chunk;
+    while (m_transport->read(chunk)) {
+        if (chunk.direction != Capture::Rx) continue;
+        parsePackets(chunk.data);
+        m_received += chunk.data.size();
+        m_lastReceived = Timestamp::now();
+        m_accumulator->append(m_converter.convert(chunk.data, Timestamp::toNSecsSinceEpoch(chunk.timestamp)));
+    }
+}
+
+void Bench::stopGenerator() {
+    QMetaObject::invokeMethod(m_generator, &BenchGenerator::stop, Qt::BlockingQueuedConnection);
+    m_sent = m_generator->sent();
+    m_drained = m_received;
+    m_timerDrain->start();
+}
+
+void Bench::drain() {
+    if (m_received == m_drained) {
+        ++m_idle;
+    } else {
+        m_idle = 0;
+        m_drained = m_received;
+    }
+    if (m_received >= m_sent || m_idle >= BENCH_DRAIN_IDLE) finish();
+}
+
+void Bench::finish() {
+    m_timerDrain->stop();
+    m_accumulator->flush();
+    m_finished = Timestamp::now();
+    m_cpuEnd = cpuTime();
+    report();
+    QTimer::singleShot(0, this, &Bench::runNext);
+}
+
+QString Bench::openEndpoint(const Scenario &scenario, Connection::Settings &settings) {
+    quint16 port = 0;
+    switch (scenario.type) {
+    case Connection::Tcp:
+        QMetaObject::invokeMethod(m_generator, [&]() {
+            port = m_generator->setup(Connection::Tcp, -1, 0);
+        }, Qt::BlockingQueuedConnection);
+        if (port == 0) return tr("Ошибка открытия сервера TCP");
+        settings.host = "127.0.0.1";
+        settings.port = port;
+        return QString();
+
+    case Connection::UdpUnicast: {
+        // свободный порт: занять и сразу освободить, транспорт откроет его повторно
+        QUdpSocket socket;
+        if (!socket.bind(QHostAddress::LocalHost, 0)) return socket.errorString();
+        port = socket.localPort();
+        socket.close();
+        QMetaObject::invokeMethod(m_generator, [&]() {
+            m_generator->setup(Connection::UdpUnicast, -1, port);
+        }, Qt::BlockingQueuedConnection);
+        settings.host = "127.0.0.1";
+        settings.port = port;
+        return QString();
+    }
+
+    default: // Connection::Serial
+#if defined(Q_OS_WIN)
+        return tr("Псевдотерминалы не поддерживаются");
+#else
+        if (::openpty(&m_fdMaster, &m_fdSlave, nullptr, nullptr, nullptr) != 0) {
+            return tr("Ошибка создания псевдотерминала: %1").arg(QString::fromLocal8Bit(::strerror(errno)));
+        }
+        // подчинённая сторона остаётся открытой, пока сценарий не завершён: иначе ведущая получает разрыв
+        struct termios raw;
+        if (::tcgetattr(m_fdSlave, &raw) == 0) {
+            ::cfmakeraw(&raw);
+            ::tcsetattr(m_fdSlave, TCSANOW, &raw);
+        }
+        settings.name = QString::fromLocal8Bit(::ttyname(m_fdSlave));
+        const int fd = m_fdMaster;
+        QMetaObject::invokeMethod(m_generator, [&]() {
+            m_generator->setup(Connection::Serial, fd, 0);
+        }, Qt::BlockingQueuedConnection);
+        return QString();
+#endif
+    }
+}
+
+void Bench::closeEndpoint() {
+    m_timerDuration->stop();
+    m_timerDrain->stop();
+    // разрыв при закрытии генератора - не ошибка сценария
+    if (m_transport) disconnect(m_transport, nullptr, this, nullptr);
+    // генератор - первым: не писать в закрытый дескриптор
+    QMetaObject::invokeMethod(m_generator, &BenchGenerator::close, Qt::BlockingQueuedConnection);
+    if (m_transport) {
+        QMetaObject::invokeMethod(m_transport, &Transport::close, Qt::BlockingQueuedConnection);
+        m_transport->deleteLater();
+        m_transport = nullptr;
+        m_pool->release(m_threadIo);
+        m_threadIo = nullptr;
+    }
+#if !defined(Q_OS_WIN)
+    if (m_fdMaster >= 0) ::close(m_fdMaster);
+    if (m_fdSlave >= 0) ::close(m_fdSlave);
+#endif
+    m_fdMaster = -1;
+    m_fdSlave = -1;
+}
+
+// Границы пакетов - по смещению в потоке: все пакеты одного размера, номер - в начале
+void Bench::parsePackets(const QByteArray &data) {
+    const char *p = data.constData();
+    qsizetype left = data.size();
+    qint64 position = m_received;
+    while (left > 0) {
+        const qsizetype n = qMin<qsizetype>(left, m_size - m_offset);
+        if (m_offset < BENCH_HEADER) {
+            std::memcpy(m_header + m_offset, p, qMin<qsizetype>(n, BENCH_HEADER - m_offset));
+        }
+        m_offset += n;
+        p += n;
+        left -= n;
+        position += n;
+        if (m_offset == m_size) {
+            bool ok;
+            const qint64 seq = QByteArray::fromRawData(m_header, BENCH_HEADER).toLongLong(&ok, 16);
+            if (ok) m_arrivals.push_back({seq, position});
+            m_offset = 0;
+        }
+    }
+}
+
+void Bench::report(const QString &error) {
+    const Scenario &scenario = m_scenarios.at(m_index);
+    const QString name = typeName(scenario.type);
+
+    // пакет выведен первым обновлением консоли, включившим его последний байт
+    LatencyHistogram latency;
+    const std::vector<qint64> &sendTimes = m_generator->sendTimes();
+    size_t flush = 0;
+    if (error.isEmpty()) {
+        for (const Arrival &arrival : m_arrivals) {
+            while (flush < m_flushes.size() && m_flushes[flush].received < arrival.end) ++flush;
+            if (flush == m_flushes.size()) break;
+            if (arrival.seq >= 0 && arrival.seq < qint64(sendTimes.size())) {
+                latency.record(m_flushes[flush].time - sendTimes[arrival.seq]);
+            }
+        }
+    }
+
+    const qint64 lost = qMax<qint64>(m_sent - m_received, 0);
+    const qint64 wall = m_lastReceived - m_started;
+    const double throughput = (wall > 0) ? m_received * 1e9 / wall : 0;
+    const qint64 elapsed = m_finished - m_started;
+    const double cpu = (elapsed > 0) ? (m_cpuEnd - m_cpuStart) * 100.0 / elapsed : 0;
+    auto us = [](qint64 ns) { return QString::number(ns / 1000.0, 'f', 1); };
+
+    QTextStream out(stdout);
+    if (!error.isEmpty()) {
+        out << QString("%1 %2 ").arg(name, -9).arg(scenario.mode, -6) << error << Qt::endl;
+    } else {
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+               .arg(name, -9).arg(scenario.mode, -6)
+               .arg(m_sent, 12).arg(lost, 10)
+               .arg(throughput / 1e6, 8, 'f', 2).arg(cpu, 6, 'f', 1)
+               .arg(us(latency.percentile(50)), 9).arg(us(latency.percentile(99)), 9).arg(us(latency.percentile(99.9)), 10)
+            << " " << QString("%1").arg(us(latency.max()), 10) << Qt::endl;
+    }
+
+    if (m_csv.isOpen()) {
+        QStringList fields = {name, scenario.mode, QString::number(m_size), QString::number(m_rate)};
+        if (error.isEmpty()) {
+            fields << QString::number(m_sent) << QString::number(m_received) << QString::number(lost)
+                   << QString::number(qint64(throughput)) << QString::number(cpu, 'f', 1)
+                   << us(latency.percentile(50)) << us(latency.percentile(99)) << us(latency.percentile(99.9))
+                   << us(latency.max()) << QString();
+        } else {
+            fields << QString() << QString() << QString() << QString() << QString()
+                   << QString() << QString() << QString() << QString() << error;
+        }
+        m_csv.write(fields.join(';').append('\n').toUtf8());
+    }
+}
+
+Connection::Settings Bench::defaultSettings() {
+    Connection::Settings settings;
+    settings.type = Connection::Serial;
+    settings.timeoutWrite = 0;
+    settings.baudRate = DEFAULT_BAUD_RATE;
+    settings.dataBits = QSerialPort::Data8;
+    settings.parity = QSerialPort::NoParity;
+    settings.stopBits = QSerialPort::OneStop;
+    settings.flowControl = QSerialPort::NoFlowControl;
+    settings.dtr = false;
+    settings.rts = false;
+    settings.port = 0;
+    settings.localEcho = false;
+    settings.timeStamp = false;
+    settings.timeDelta = false;
+    settings.gapThreshold = 0;
+    settings.hexLog = false;
+    settings.hexAll = false;
+    settings.linefeed = true;                       // в шестнадцатеричном виде - строка на пакет
+    settings.linefeedChar = DEFAULT_LINEFEED_CHAR;
+    settings.scrollback = 0;
+    settings.refreshRate = 0;
+    settings.framing = Connection::FrameNone;
+    settings.frameLengthOffset = 0;
+    settings.frameLengthSize = 1;
+    settings.frameLengthBigEndian = false;
+    settings.frameLengthAdjust = 0;
+    settings.frameGap = 0;
+    settings.frameCrc = 0;
+    return settings;
+}
+
+QString Bench::typeName(Connection::Type type) {
+    switch (type) {
+    case Connection::Tcp: return "tcp";
+    case Connection::UdpUnicast: return "udp";
+    default: return "serial";
+    }
+}
+
+void Bench::print(const QString &message) {
+    QTextStream(stderr) << message << Qt::endl;
+}
+
+qint64 Bench::cpuTime() {
+#if defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+    auto ticks = [](const FILETIME &time) {
+        return (qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) * 100;     // интервалы по 100 нс
+#else
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000000LL +
+           (qint64(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) * 1000LL;
+#endif
+}
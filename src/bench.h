@@ -0,0 +1,175 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <QObject>
+#include <QFile>
+#include <QVector>
+#include <QAbstractSocket>
+#include <vector>
+#include "connection.h"
+#include "converter.h"
+#include "latency.h"
+
+QT_BEGIN_NAMESPACE
+
+class QThread;
+class QTimer;
+class QTcpServer;
+class QTcpSocket;
+class QUdpSocket;
+
+QT_END_NAMESPACE
+
+class Transport;
+class Accumulator;
+class Console;
+class IoPool;
+
+#define BENCH_HEADER            16                  // номер пакета, шестнадцатеричные цифры
+#define BENCH_MIN_SIZE          (BENCH_HEADER + 2)  // с переводом строки в конце
+#define BENCH_BURST             (256 * 1024)        // байт за такт генератора, не более
+#define BENCH_BACKLOG           (1024 * 1024)       // байт в очереди сокета генератора, не более
+#define BENCH_TICK              1                   // мс, такт генератора
+#define BENCH_DRAIN_CHECK       50                  // мс между проверками приёма после остановки генератора
+#define BENCH_DRAIN_IDLE        4                   // проверок без новых данных - приём завершён
+
+// Источник данных в отдельном потоке: пакеты фиксированного размера с номером,
+// отправляемые с заданной скоростью в ведущую сторону псевдотерминала, TCP-клиенту или по UDP
+class BenchGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BenchGenerator(QObject *parent = nullptr);
+
+    // после stop() с Qt::BlockingQueuedConnection
+    const std::vector<qint64> &sendTimes() const;   // Timestamp::now() отправки пакета по номеру
+    qint64 sent() const;
+
+public slots:
+    // поток генератора; fd - Serial, port - UdpUnicast. Возвращает порт сервера Tcp, 0 - ошибка
+    quint16 setup(Connection::Type type, int fd, quint16 port);
+    void start(qint64 rate, int size);              // rate - байт/с, 0 - без ограничения
+    void stop();
+    void close();
+
+private slots:
+    void tick();
+
+private:
+    bool writable() const;
+    bool writeSerial(const char *data, qint64 size); // false - остаток сохранён в m_rest
+
+    QTimer *m_timer = nullptr;
+    QTcpServer *m_server = nullptr;
+    QTcpSocket *m_peer = nullptr;
+    QUdpSocket *m_udp = nullptr;
+    Connection::Type m_type = Connection::Serial;
+    int m_fd = -1;                                  // ведущая сторона псевдотерминала
+    quint16 m_port = 0;
+    QByteArray m_packet;
+    QByteArray m_rest;                              // не записанный в псевдотерминал остаток
+    qint64 m_rate = 0;
+    qint64 m_started = 0;
+    qint64 m_sent = 0;
+    std::vector<qint64> m_sendTimes;
+};
+
+// Нагрузочный тест тракта приёма: транспорт -> преобразование -> консоль.
+// Для каждого сочетания транспорта и вида вывода - пропускная способность, потери,
+// процессорное время и задержка от отправки пакета до передачи в консоль.
+class Bench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Bench(QObject *parent = nullptr);
+    ~Bench();
+
+    typedef enum {
+        ExitOk = 0,
+        ExitUsage = 1,                              // ошибка в параметрах
+        ExitOpen = 2                                // не удалось подготовить хотя бы один сценарий
+    } ExitCode;
+
+    int start(const QStringList &arguments);        // -1 - работа продолжается, иначе код завершения
+
+signals:
+    void finished(int code);
+
+private slots:
+    void runNext();
+    void opened();
+    void openError(const QString &message);
+    void transportReadyRead();
+    void stopGenerator();
+    void drain();
+    void socketError(QAbstractSocket::SocketError error, const QString &message);
+
+private:
+    typedef struct {
+        Connection::Type type;
+        QString mode;
+    } Scenario;
+
+    typedef struct {
+        qint64 seq;
+        qint64 end;                                 // принято байт к концу пакета
+    } Arrival;
+
+    typedef struct {
+        qint64 time;
+        qint64 received;                            // принято байт к моменту вывода
+    } Flush;
+
+    int parse(const QStringList &arguments);
+    QString openEndpoint(const Scenario &scenario, Connection::Settings &settings); // пусто - успешно
+    void closeEndpoint();
+    void parsePackets(const QByteArray &data);
+    void finish();
+    void report(const QString &error = QString());
+    static Connection::Settings defaultSettings();
+    static QString typeName(Connection::Type type);
+    static void print(const QString &message);      // в stderr
+    static qint64 cpuTime();                        // нс процессорного времени процесса
+
+    IoPool *m_pool = nullptr;
+    QThread *m_threadGenerator = nullptr;
+    BenchGenerator *m_generator = nullptr;
+    QThread *m_threadIo = nullptr;
+    Transport *m_transport = nullptr;
+    Converter m_converter;
+    Accumulator *m_accumulator = nullptr;
+    Console *m_console = nullptr;
+    QTimer *m_timerDuration = nullptr;
+    QTimer *m_timerDrain = nullptr;
+    QFile m_csv;
+
+    QVector<Scenario> m_scenarios;
+    int m_index = -1;
+    int m_failed = 0;
+    qint64 m_rate = 1000000;
+    int m_size = 64;
+    int m_duration = 2000;                          // мс
+    int m_refresh = 60;                             // Гц
+
+    int m_fdMaster = -1;
+    int m_fdSlave = -1;
+
+    // текущий сценарий
+    qint64 m_sent = 0;
+    qint64 m_received = 0;
+    qint64 m_drained = 0;                           // m_received при прошлой проверке
+    int m_idle = 0;                                 // проверок без новых данных
+    qint64 m_started = 0;                           // Timestamp::now() подключения, 0 - не подключено
+    qint64 m_lastReceived = 0;
+    qint64 m_finished = 0;
+    qint64 m_cpuStart = 0;
+    qint64 m_cpuEnd = 0;
+    qsizetype m_offset = 0;                         // позиция в текущем пакете
+    char m_header[BENCH_HEADER];
+    std::vector<Arrival> m_arrivals;
+    std::vector<Flush> m_flushes;
+};
+
+#endif // BENCH_H
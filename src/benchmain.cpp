@@ -0,0 +1,18 @@
+#include <QApplication>
+#include "bench.h"
+
+int main(int argc, char *argv[]) {
+    // консоль отрисовывается без окна на экране, если платформа не задана явно
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication::setOrganizationName(APP_NAME);
+    QApplication::setApplicationName(APP_NAME);
+    QApplication::setApplicationVersion(APP_VERSION);
+
+    QApplication a(argc, argv);
+    Bench b;
+    QObject::connect(&b, &Bench::finished, &a, &QApplication::exit, Qt::QueuedConnection);
+    const int code = b.start(a.arguments());
+    if (code >= 0) return code;
+    return a.exec();
+}
@@ -0,0 +1,295 @@
+#include "bridge.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QTimer>
+
+#define BRIDGE_DATAGRAM         1400                // байт порта в одну датаграмму, без фрагментации
+#define BRIDGE_RECONNECT        1000                // мс до повторного подключения клиента
+
+Bridge::Bridge(QObject *parent):
+    QObject(parent),
+    m_serial(new QSerialPort(this)),
+    m_server(new QTcpServer(this)),
+    m_client(new QTcpSocket(this)),
+    m_udp(new QUdpSocket(this))
+{
+    connect(m_serial, &QSerialPort::readyRead, this, &Bridge::serialReadyRead);
+    connect(m_serial, &QSerialPort::errorOccurred, this, &Bridge::serialErrorOccurred);
+    // запись в порт освободила место - продолжить чтение сети
+    connect(m_serial, &QSerialPort::bytesWritten, this, &Bridge::networkReadyRead);
+
+    connect(m_server, &QTcpServer::newConnection, this, &Bridge::newConnection);
+    connect(m_client, &QTcpSocket::connected, this, [=]() { setPeer(m_client); });
+    connect(m_client, &QTcpSocket::errorOccurred, this, [=]() {
+        if (!m_peer) reconnect();                   // сервер недоступен
+    });
+    connect(m_udp, &QUdpSocket::readyRead, this, &Bridge::networkReadyRead);
+}
+
+bool Bridge::isActive() const {
+    return m_active.load(std::memory_order_acquire);
+}
+
+qint64 Bridge::forwarded(Capture::Direction direction) const {
+    return m_forwarded[direction].load(std::memory_order_relaxed);
+}
+
+qint64 Bridge::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+qint64 Bridge::unsent() const {
+    return m_unsent.load(std::memory_order_relaxed);
+}
+
+bool Bridge::read(Transport::Chunk &chunk) {
+    if (m_queue.pop(chunk)) return true;
+    m_notified.store(false, std::memory_order_release);
+    return m_queue.pop(chunk); // данные могли прийти до сброса флага
+}
+
+void Bridge::start(const Connection::Settings &serial, const Bridge::Settings &settings) {
+    stop();
+    m_settings = settings;
+    m_address.clear();
+    m_forwarded[Capture::Rx].store(0, std::memory_order_relaxed);
+    m_forwarded[Capture::Tx].store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_unsent.store(0, std::memory_order_relaxed);
+    m_tokens = m_settings.tapRate;
+    m_refilled = Timestamp::now();
+    if (m_buffer.size() != BRIDGE_BUFFER) m_buffer.resize(BRIDGE_BUFFER);
+
+    m_serial->setPortName(serial.name);
+    m_serial->setBaudRate(serial.baudRate);
+    m_serial->setDataBits(serial.dataBits);
+    m_serial->setParity(serial.parity);
+    m_serial->setStopBits(serial.stopBits);
+    m_serial->setFlowControl(serial.flowControl);
+    if (!m_serial->open(QIODevice::ReadWrite)) {
+        emit errorOccurred(tr("Ошибка открытия порта '%1': %2").arg(m_serial->portName(), m_serial->errorString()));
+        return;
+    }
+    m_serial->setDataTerminalReady(serial.dtr);
+    m_serial->setRequestToSend(serial.rts);
+    openNetwork();
+}
+
+void Bridge::openNetwork() {
+    bool ok = true;
+    switch (m_settings.mode) {
+    case TcpClient:
+        m_client->connectToHost(m_settings.host, m_settings.port);
+        break;
+    case Udp:
+        if (m_address.isNull()) m_address = QHostAddress(m_settings.host);
+        if (m_address.isNull()) {
+            // имя узла, а не адрес: мост запускается после разрешения, поток не ждёт DNS
+            m_lookup = QHostInfo::lookupHost(m_settings.host, this, &Bridge::hostFound);
+            return;
+        }
+        ok = m_udp->bind(m_settings.port, QUdpSocket::ShareAddress);
+        break;
+    default: // TcpServer
+        ok = m_server->listen(QHostAddress::Any, m_settings.port);
+    }
+    if (!ok) {
+        const QString error = (m_settings.mode == Udp) ? m_udp->errorString() : m_server->errorString();
+        m_serial->close();
+        emit errorOccurred(tr("Ошибка открытия порта %1: %2").arg(m_settings.port).arg(error));
+        return;
+    }
+    m_active.store(true, std::memory_order_release);
+    emit started();
+}
+
+void Bridge::hostFound(const QHostInfo &info) {
+    if (info.lookupId() != m_lookup) return;        // запуск отменён
+    m_lookup = -1;
+    const QList<QHostAddress> addresses = info.addresses();
+    if (info.error() != QHostInfo::NoError || addresses.isEmpty()) {
+        m_serial->close();
+        emit errorOccurred(tr("Узел '%1' не найден: %2").arg(m_settings.host, info.errorString()));
+        return;
+    }
+    m_address = addresses.constFirst();
+    for (const QHostAddress &address : addresses) {
+        if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+            m_address = address;                    // сокет привязан к любому адресу, IPv4 - надёжнее
+            break;
+        }
+    }
+    openNetwork();
+}
+
+void Bridge::stop() {
+    if (m_lookup >= 0) {
+        QHostInfo::abortHostLookup(m_lookup);
+        m_lookup = -1;
+        m_serial->close();
+        return;
+    }
+    if (!isActive()) return;
+    m_active.store(false, std::memory_order_release);
+    if (m_peer) releasePeer();
+    m_client->abort();
+    m_server->close();
+    m_udp->close();
+    m_serial->close();
+    emit stopped();
+}
+
+void Bridge::startCapture(const QString &fileName) {
+    if (!m_capture.open(fileName)) {
+        emit captureError(tr("Ошибка записи в '%1': %2").arg(fileName, m_capture.errorString()));
+    }
+}
+
+void Bridge::stopCapture() {
+    if (!m_capture.isOpen()) return;
+    m_capture.close();
+    if (m_capture.dropped() > 0) emit captureError(tr("Захват неполон: диск не успевал, потеряно %1 байт").arg(m_capture.dropped()));
+}
+
+void Bridge::serialReadyRead() {
+    QIODevice *out = network();
+    const qint64 max = (m_settings.mode == Udp) ? BRIDGE_DATAGRAM : BRIDGE_BUFFER;
+    // очередь записи в сеть переполнена - остаток ждёт bytesWritten
+    while (!out || (out->bytesToWrite() < BRIDGE_BACKLOG)) {
+        const qint64 size = m_serial->read(m_buffer.data(), max);
+        if (size <= 0) break;
+        const qint64 timestamp = Timestamp::now();
+        if (m_settings.mode == Udp) {
+            if (m_udp->writeDatagram(m_buffer.constData(), size, m_address, m_settings.port) == size) {
+                m_forwarded[Capture::Rx].fetch_add(size, std::memory_order_relaxed);
+            } else if (m_udp->error() == QAbstractSocket::ConnectionRefusedError) {
+                m_unsent.fetch_add(size, std::memory_order_relaxed); // получатель ещё не слушает
+            } else {
+                emit errorOccurred(tr("Ошибка отправки на %1:%2: %3").arg(m_address.toString()).arg(m_settings.port).arg(m_udp->errorString()));
+                stop();
+                return;
+            }
+        } else if (out) {
+            out->write(m_buffer.constData(), size);
+            m_forwarded[Capture::Rx].fetch_add(size, std::memory_order_relaxed);
+        }
+        // без подключения с сетевой стороны данные порта только отводятся
+        tap(Capture::Rx, m_buffer.constData(), size, timestamp);
+    }
+}
+
+void Bridge::networkReadyRead() {
+    if (!isActive()) return;
+    if (m_settings.mode == Udp) {
+        // датаграммы не ждут: задержка записи в порт только растит очередь ядра
+        while (m_udp->hasPendingDatagrams()) {
+            const qint64 size = m_udp->readDatagram(m_buffer.data(), m_buffer.size());
+            if (size <= 0) continue;
+            const qint64 timestamp = Timestamp::now();
+            m_serial->write(m_buffer.constData(), size);
+            m_forwarded[Capture::Tx].fetch_add(size, std::memory_order_relaxed);
+            tap(Capture::Tx, m_buffer.constData(), size, timestamp);
+        }
+        return;
+    }
+    if (!m_peer) return;
+    // порт медленнее сети: TCP сам приостановит отправителя, пока данные ждут в сокете
+    while (m_serial->bytesToWrite() < BRIDGE_BACKLOG) {
+        const qint64 size = m_peer->read(m_buffer.data(), m_buffer.size());
+        if (size <= 0) break;
+        const qint64 timestamp = Timestamp::now();
+        m_serial->write(m_buffer.constData(), size);
+        m_forwarded[Capture::Tx].fetch_add(size, std::memory_order_relaxed);
+        tap(Capture::Tx, m_buffer.constData(), size, timestamp);
+    }
+}
+
+void Bridge::serialErrorOccurred(QSerialPort::SerialPortError error) {
+    if (error == QSerialPort::ResourceError) {
+        emit errorOccurred(m_serial->errorString());
+        stop();
+    }
+}
+
+void Bridge::newConnection() {
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        if (m_peer) {
+            socket->abort();                        // порт занят другим клиентом
+            socket->deleteLater();
+        } else {
+            setPeer(socket);
+        }
+    }
+}
+
+void Bridge::peerDisconnected() {
+    if (!m_peer || (sender() != m_peer)) return;
+    releasePeer();
+    if (m_settings.mode == TcpClient) reconnect();
+}
+
+QIODevice *Bridge::network() const {
+    if (m_settings.mode == Udp) return nullptr;
+    return m_peer;
+}
+
+void Bridge::setPeer(QTcpSocket *peer) {
+    m_peer = peer;
+    peer->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(peer, &QTcpSocket::readyRead, this, &Bridge::networkReadyRead);
+    connect(peer, &QTcpSocket::disconnected, this, &Bridge::peerDisconnected);
+    // запись в сеть освободила место - продолжить чтение порта
+    connect(peer, &QTcpSocket::bytesWritten, this, &Bridge::serialReadyRead);
+    emit peerChanged(QString("%1:%2").arg(peer->peerAddress().toString()).arg(peer->peerPort()));
+    networkReadyRead();
+}
+
+// Принятые сервером сокеты удаляются, сокет клиента переподключается
+void Bridge::releasePeer() {
+    QTcpSocket *peer = m_peer;
+    m_peer = nullptr;
+    disconnect(peer, &QTcpSocket::readyRead, this, &Bridge::networkReadyRead);
+    disconnect(peer, &QTcpSocket::disconnected, this, &Bridge::peerDisconnected);
+    disconnect(peer, &QTcpSocket::bytesWritten, this, &Bridge::serialReadyRead);
+    if (peer != m_client) {
+        peer->abort();
+        peer->deleteLater();
+    }
+    emit peerChanged(QString());
+}
+
+void Bridge::reconnect() {
+    QTimer::singleShot(BRIDGE_RECONNECT, this, [=]() {
+        if (isActive() && (m_client->state() == QAbstractSocket::UnconnectedState)) {
+            m_client->connectToHost(m_settings.host, m_settings.port);
+        }
+    });
+}
+
+void Bridge::tap(Capture::Direction direction, const char *data, qint64 size, qint64 timestamp) {
+    if (m_settings.tapRate <= 0) return;
+    // ведро маркеров: не более tapRate байт в секунду, запас - на одну секунду
+    const qint64 gained = qMin<qint64>(timestamp - m_refilled, 1000000000) * m_settings.tapRate / 1000000000;
+    if (gained > 0) {
+        m_tokens = qMin<qint64>(m_tokens + gained, m_settings.tapRate);
+        m_refilled = timestamp;
+    }
+    const qint64 taken = qMin(size, m_tokens);
+    m_tokens -= taken;
+    if (taken < size) m_dropped.fetch_add(size - taken, std::memory_order_relaxed);
+    if (taken <= 0) return;
+
+    if (m_capture.isOpen() && !m_capture.write(direction, Connection::Serial, timestamp, data, taken)) {
+        emit captureError(tr("Ошибка записи захвата: %1").arg(m_capture.errorString()));
+        m_capture.close();
+    }
+    if (!m_queue.push({QByteArray(data, taken), timestamp, direction, Crc::CheckNone})) {
+        m_dropped.fetch_add(taken, std::memory_order_relaxed); // консоль не успевает
+        return;
+    }
+    if (!m_notified.exchange(true, std::memory_order_acq_rel)) emit readyRead();
+}
@@ -0,0 +1,107 @@
+#ifndef BRIDGE_H
+#define BRIDGE_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <QHostAddress>
+#include <atomic>
+#include "connection.h"
+#include "transport.h"
+
+QT_BEGIN_NAMESPACE
+
+class QHostInfo;
+class QTcpServer;
+class QTcpSocket;
+class QUdpSocket;
+
+QT_END_NAMESPACE
+
+#define BRIDGE_BUFFER           65536               // байт за одно чтение
+#define BRIDGE_BACKLOG          (1024 * 1024)       // байт в очереди записи, выше - чтение приостанавливается
+#define BRIDGE_QUEUE_SIZE       256
+
+// Мост последовательного порта с TCP (сервер или клиент) или UDP в потоке ввода-вывода.
+// Данные пересылаются через постоянные буферы без разбора и форматирования;
+// отвод (tap) копирует часть трафика в очередь для консоли и в захват с ограничением скорости.
+class Bridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef enum {
+        TcpServer = 0,
+        TcpClient = 1,
+        Udp = 2
+    } Mode;
+
+    typedef struct {
+        Mode mode;
+        QString host;                               // TcpClient, Udp
+        quint16 port;
+        int tapRate;                                // байт/с в отвод, 0 - без отвода
+    } Settings;
+
+    explicit Bridge(QObject *parent = nullptr);
+
+    // из любого потока
+    bool isActive() const;
+    qint64 forwarded(Capture::Direction direction) const; // Rx - из порта в сеть, Tx - из сети в порт
+    qint64 dropped() const;                         // байт, не попавших в отвод
+    qint64 unsent() const;                          // байт порта, не отправленных получателем датаграмм
+
+    bool read(Transport::Chunk &chunk);             // забрать блок отвода (поток GUI)
+
+public slots:
+    void start(const Connection::Settings &serial, const Bridge::Settings &settings);
+    void stop();
+    void startCapture(const QString &fileName);
+    void stopCapture();
+
+signals:
+    void started();
+    void stopped();
+    void peerChanged(const QString &peer);          // пусто - нет подключения с сетевой стороны
+    void readyRead();                               // в очереди отвода есть данные
+    void errorOccurred(const QString &message);
+    void captureError(const QString &message);
+
+private slots:
+    void serialReadyRead();
+    void networkReadyRead();
+    void serialErrorOccurred(QSerialPort::SerialPortError error);
+    void newConnection();
+    void peerDisconnected();
+    void hostFound(const QHostInfo &info);
+
+private:
+    void openNetwork();                             // порт открыт: сетевая сторона, затем started()
+    QIODevice *network() const;                     // сетевая сторона для записи, nullptr - нет
+    void setPeer(QTcpSocket *peer);
+    void releasePeer();
+    void reconnect();                               // повтор подключения клиента, пока мост работает
+    void tap(Capture::Direction direction, const char *data, qint64 size, qint64 timestamp);
+
+    Settings m_settings;
+    QSerialPort *m_serial = nullptr;
+    QTcpServer *m_server = nullptr;
+    QTcpSocket *m_client = nullptr;                 // TcpClient
+    QTcpSocket *m_peer = nullptr;                   // подключённый сокет TcpServer/TcpClient
+    QUdpSocket *m_udp = nullptr;
+    QHostAddress m_address;                         // получатель датаграмм Udp
+    int m_lookup = -1;                              // идёт разрешение имени получателя Udp
+
+    QByteArray m_buffer;                            // BRIDGE_BUFFER, выделяется один раз
+    qint64 m_tokens = 0;                            // байт, разрешённых в отвод
+    qint64 m_refilled = 0;                          // Timestamp::now() пополнения m_tokens
+
+    CaptureWriter m_capture;
+    SpscQueue<Transport::Chunk, BRIDGE_QUEUE_SIZE> m_queue;
+    std::atomic<bool> m_notified{false};
+    std::atomic<bool> m_active{false};
+    std::atomic<qint64> m_forwarded[2] = {{0}, {0}};
+    std::atomic<qint64> m_dropped{0};
+    std::atomic<qint64> m_unsent{0};
+};
+
+#endif // BRIDGE_H
@@ -0,0 +1,254 @@
+#include "capture.h"
+
+#include "timestamp.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QtEndian>
+#include <cstring>
+
+bool Capture::isCapture(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray magic = file.read(CAPTURE_MAGIC_SIZE);
+    return (magic == QByteArray(CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE)) || (magic == QByteArray(CAPTURE_MAGIC_Z, CAPTURE_MAGIC_SIZE));
+}
+
+void Capture::fileHeader(uchar *header, qint64 start) {
+    memcpy(header, CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE);
+    qToLittleEndian<qint64>(Timestamp::toNSecsSinceEpoch(start) / 1000000, header + CAPTURE_MAGIC_SIZE);
+}
+
+void Capture::chunkHeader(uchar *header, qint64 timestamp, qint64 size, Direction direction, int transport) {
+    qToLittleEndian<qint64>(timestamp, header);
+    qToLittleEndian<quint32>(quint32(size), header + 8);
+    header[12] = quint8(direction);
+    header[13] = quint8(transport);
+    qToLittleEndian<quint16>(0, header + 14);
+}
+
+// CaptureWriter
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const QString &fileName) {
+    close();
+    m_file.setFileName(fileName);
+    const QMutexLocker locker(&m_mutex);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    uchar header[CAPTURE_FILE_HEADER_SIZE];
+    m_start = Timestamp::now();
+    Capture::fileHeader(header, m_start);
+    if (m_file.write(reinterpret_cast<const char *>(header), sizeof(header)) != sizeof(header)) {
+        m_error = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_error.clear();
+    m_stop = false;
+    m_failed.store(false, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+    return true;
+}
+
+void CaptureWriter::close() {
+    if (!m_thread) return;
+    {
+        const QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_wake.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_file.close();
+}
+
+bool CaptureWriter::isOpen() const {
+    return m_thread != nullptr;
+}
+
+QString CaptureWriter::errorString() const {
+    const QMutexLocker locker(&m_mutex);
+    return m_error;
+}
+
+bool CaptureWriter::write(Capture::Direction direction, int transport, qint64 timestamp, const char *data, qint64 size) {
+    if (!m_thread || size <= 0) return true;
+    if (m_failed.load(std::memory_order_relaxed)) return false;
+    uchar header[CAPTURE_CHUNK_HEADER_SIZE];
+    Capture::chunkHeader(header, timestamp - m_start, size, direction, transport);
+
+    const QMutexLocker locker(&m_mutex);
+    const qint64 used = m_active.size();
+    if (used + CAPTURE_CHUNK_HEADER_SIZE + size > CAPTURE_BUFFER) {
+        m_dropped.fetch_add(size, std::memory_order_relaxed); // диск не успевает - ввод-вывод не ждёт
+        return true;
+    }
+    m_active.append(reinterpret_cast<const char *>(header), CAPTURE_CHUNK_HEADER_SIZE);
+    m_active.append(data, size);
+    if (used < CAPTURE_FLUSH_SIZE && m_active.size() >= CAPTURE_FLUSH_SIZE) m_wake.wakeOne();
+    return true;
+}
+
+qint64 CaptureWriter::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void CaptureWriter::run() {
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        if (!m_stop && m_active.size() < CAPTURE_FLUSH_SIZE) m_wake.wait(&m_mutex, CAPTURE_FLUSH_TIME);
+        // заполненный буфер уходит на запись, пустой - под новые блоки
+        m_spare.swap(m_active);
+        const bool stop = m_stop;
+        locker.unlock();
+
+        if (!m_spare.isEmpty() && !m_failed.load(std::memory_order_relaxed) &&
+            ((m_file.write(m_spare) != m_spare.size()) || !m_file.flush())) {
+            locker.relock();
+            m_error = m_file.errorString();
+            m_failed.store(true, std::memory_order_relaxed);
+            locker.unlock();
+        }
+        m_spare.resize(0);                          // ёмкость сохраняется
+
+        locker.relock();
+        if (stop && m_active.isEmpty()) break;      // после остановки блоки не добавляются
+    }
+}
+
+// CaptureReader
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+bool CaptureReader::open(const QString &fileName) {
+    close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size < CAPTURE_FILE_HEADER_SIZE) {
+        m_error = QObject::tr("Файл повреждён");
+        close();
+        return false;
+    }
+    m_map = m_file.map(0, m_size);
+    if (!m_map) {
+        m_error = m_file.errorString();
+        close();
+        return false;
+    }
+    if (memcmp(m_map, CAPTURE_MAGIC_Z, CAPTURE_MAGIC_SIZE) == 0 && !inflate()) {
+        m_error = QObject::tr("Сжатый захват больше %1 МБ после распаковки").arg(CAPTURE_MAX_INFLATED / (1024 * 1024));
+        close();
+        return false;
+    }
+    if (m_size < CAPTURE_FILE_HEADER_SIZE || memcmp(m_map, CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE) != 0) {
+        m_error = QObject::tr("Неизвестный формат файла");
+        close();
+        return false;
+    }
+    m_startTime = qFromLittleEndian<qint64>(m_map + CAPTURE_MAGIC_SIZE);
+    m_error.clear();
+    rewind();
+    return true;
+}
+
+// Кадры распаковываются подряд; оборванный кадр в конце - конец захвата
+bool CaptureReader::inflate() {
+    QByteArray inflated;
+    qint64 pos = CAPTURE_MAGIC_SIZE;
+    while (m_size - pos >= 4) {
+        const quint32 size = qFromLittleEndian<quint32>(m_map + pos);
+        if (m_size - pos - 4 < qint64(size)) break;
+        // qUncompress() хранит размер распакованного кадра в первых 4 байтах, big-endian
+        if (size >= 4 && inflated.size() + qint64(qFromBigEndian<quint32>(m_map + pos + 4)) > CAPTURE_MAX_INFLATED) return false;
+        const QByteArray part = qUncompress(m_map + pos + 4, size);
+        if (part.isEmpty()) break;
+        inflated.append(part);
+        pos += 4 + size;
+    }
+    m_file.unmap(const_cast<uchar *>(m_map));
+    m_file.close();
+    m_inflated = inflated;
+    m_map = reinterpret_cast<const uchar *>(m_inflated.constData());
+    m_size = m_inflated.size();
+    return true;
+}
+
+void CaptureReader::close() {
+    if (m_map && m_file.isOpen()) m_file.unmap(const_cast<uchar *>(m_map)); // распакованный захват - файл уже закрыт
+    m_map = nullptr;
+    m_inflated.clear();
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_pos = 0;
+}
+
+bool CaptureReader::isOpen() const {
+    return m_map != nullptr;
+}
+
+QString CaptureReader::errorString() const {
+    return m_error;
+}
+
+qint64 CaptureReader::startTime() const {
+    return m_startTime;
+}
+
+qint64 CaptureReader::size() const {
+    return m_size;
+}
+
+qint64 CaptureReader::position() const {
+    return m_pos;
+}
+
+void CaptureReader::rewind() {
+    m_pos = CAPTURE_FILE_HEADER_SIZE;
+}
+
+bool CaptureReader::header(Capture::ChunkHeader &header) const {
+    if (!m_map || m_size - m_pos < CAPTURE_CHUNK_HEADER_SIZE) return false;
+    const uchar *p = m_map + m_pos;
+    header.timestamp = qFromLittleEndian<qint64>(p);
+    header.size = qFromLittleEndian<quint32>(p + 8);
+    header.direction = p[12];
+    header.transport = p[13];
+    header.reserved = qFromLittleEndian<quint16>(p + 14);
+    return (m_size - m_pos - CAPTURE_CHUNK_HEADER_SIZE) >= qint64(header.size); // неполный блок - конец
+}
+
+bool CaptureReader::next(Capture::Chunk &chunk) {
+    Capture::ChunkHeader h;
+    if (!header(h)) return false;
+    chunk.timestamp = h.timestamp;
+    chunk.direction = (h.direction == Capture::Tx) ? Capture::Tx : Capture::Rx;
+    chunk.transport = h.transport;
+    chunk.data = reinterpret_cast<const char *>(m_map + m_pos + CAPTURE_CHUNK_HEADER_SIZE);
+    chunk.size = h.size;
+    m_pos += CAPTURE_CHUNK_HEADER_SIZE + h.size;
+    return true;
+}
+
+bool CaptureReader::skip(qint64 *payload) {
+    Capture::ChunkHeader h;
+    if (!header(h)) return false;
+    if (payload) *payload = h.size;
+    m_pos += CAPTURE_CHUNK_HEADER_SIZE + h.size;
+    return true;
+}
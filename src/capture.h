@@ -0,0 +1,127 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+#define CAPTURE_MAGIC           "UTCAP\x01\r\n"     // 8 байт, версия 1
+#define CAPTURE_MAGIC_Z         "UTCAPZ\x01\n"      // 8 байт, сжатый захват
+#define CAPTURE_MAGIC_SIZE      8
+#define CAPTURE_FILE_HEADER_SIZE    (CAPTURE_MAGIC_SIZE + 8)
+#define CAPTURE_CHUNK_HEADER_SIZE   16
+#define CAPTURE_EXTENSION       "ucap"
+#define CAPTURE_BUFFER          (8 * 1024 * 1024)   // байт в буфере записи; диск не успевает - блоки отбрасываются
+#define CAPTURE_FLUSH_SIZE      (256 * 1024)        // байт в буфере, при которых запись начинается сразу
+#define CAPTURE_FLUSH_TIME      500                 // мс, наибольшая задержка записи на диск
+#define CAPTURE_MAX_INFLATED    (256 * 1024 * 1024) // байт, наибольший сжатый захват после распаковки: читается в память целиком
+
+// Формат захвата (little-endian), только дописывание:
+//   FileHeader, далее ChunkHeader + данные, ChunkHeader + данные, ...
+// Оборванная запись в конце файла (аварийное завершение) при чтении игнорируется.
+// Сжатый захват: CAPTURE_MAGIC_Z, далее кадры quint32 размер + qCompress(часть захвата);
+// кадры сжаты независимо, вместе распаковываются в обычный захват.
+class Capture
+{
+public:
+    typedef enum {
+        Rx = 0,
+        Tx = 1
+    } Direction;
+
+    typedef struct {
+        char magic[CAPTURE_MAGIC_SIZE];
+        qint64 startTime;                           // мс с 1970-01-01 UTC
+    } FileHeader;
+
+    typedef struct {
+        qint64 timestamp;                           // нс от начала записи, монотонное
+        quint32 size;                               // байт данных
+        quint8 direction;                           // Direction
+        quint8 transport;                           // Connection::Type
+        quint16 reserved;
+    } ChunkHeader;
+
+    typedef struct {
+        qint64 timestamp;
+        Direction direction;
+        int transport;
+        const char *data;
+        qint64 size;
+    } Chunk;
+
+    static bool isCapture(const QString &fileName); // проверка сигнатуры
+    // start - Timestamp::now() начала записи, timestamp - нс от него
+    static void fileHeader(uchar *header, qint64 start);
+    static void chunkHeader(uchar *header, qint64 timestamp, qint64 size, Direction direction, int transport);
+};
+
+// Запись захвата (поток ввода-вывода): блок копируется в буфер, на диск его пишет свой поток,
+// поэтому задержки диска не останавливают приём и передачу
+class CaptureWriter
+{
+public:
+    ~CaptureWriter();
+
+    bool open(const QString &fileName);
+    void close();                                   // буфер дописывается на диск
+    bool isOpen() const;
+    QString errorString() const;
+
+    // timestamp - Timestamp::now() в момент чтения/записи; false - ошибка записи на диск
+    bool write(Capture::Direction direction, int transport, qint64 timestamp, const char *data, qint64 size);
+    qint64 dropped() const;                         // байт блоков, не поместившихся в буфер
+
+private:
+    void run();                                     // поток записи
+
+    QFile m_file;                                   // после открытия - только поток записи
+    qint64 m_start = 0;                             // Timestamp::now() в момент открытия
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_failed{false};
+    std::atomic<qint64> m_dropped{0};
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QByteArray m_active;                            // под m_mutex: заполняется блоками
+    QString m_error;                                // под m_mutex
+    bool m_stop = false;                            // под m_mutex
+    QByteArray m_spare;                             // записывается на диск
+};
+
+// Чтение захвата через отображение файла в память; сжатый захват распаковывается в память целиком
+class CaptureReader
+{
+public:
+    ~CaptureReader();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    qint64 startTime() const;                       // мс с 1970-01-01 UTC
+    qint64 size() const;                            // байт в файле
+    qint64 position() const;                        // смещение следующего блока
+
+    void rewind();
+    bool next(Capture::Chunk &chunk);               // false - конец файла
+    bool skip(qint64 *payload = nullptr);           // пропустить блок, не читая данные
+
+private:
+    bool header(Capture::ChunkHeader &header) const;
+    bool inflate();                                 // false - больше CAPTURE_MAX_INFLATED
+
+    QFile m_file;
+    QString m_error;
+    const uchar *m_map = nullptr;
+    QByteArray m_inflated;                          // распакованный сжатый захват
+    qint64 m_size = 0;
+    qint64 m_pos = 0;
+    qint64 m_startTime = 0;
+};
+
+#endif // CAPTURE_H
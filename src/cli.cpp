@@ -0,0 +1,531 @@
+#include "cli.h"
+#include "transport.h"
+#include "crc.h"
+#include "enumerator.h"
+#include "bridge.h"
+#include "sessionlog.h"
+#include "timestamp.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSerialPortInfo>
+#include <QTextStream>
+#include <QTimer>
+
+#define DEFAULT_TIMEOUT_WRITE               5000
+#define DEFAULT_HOST                        "localhost"
+#define DEFAULT_PORT                        2000
+#define DEFAULT_LINEFEED_CHAR               13
+
+Cli::Cli(QObject *parent):
+    QObject(parent),
+    m_transport(new Transport(this)),
+    m_crc(new Crc(this)),
+    m_enumerator(new Enumerator(this)),
+    m_bridge(new Bridge(this)),
+    m_sessionLog(new SessionLog(0, this)),
+    m_timerSend(new QTimer(this)),
+    m_timerWait(new QTimer(this)),
+    m_timerLimit(new QTimer(this))
+{
+    m_timerSend->setSingleShot(true);
+    m_timerSend->setTimerType(Qt::PreciseTimer);
+    m_timerWait->setSingleShot(true);
+    m_timerLimit->setSingleShot(true);
+
+    connect(m_timerSend, &QTimer::timeout, this, &Cli::sendNext);
+    connect(m_timerWait, &QTimer::timeout, this, &Cli::expired);
+    connect(m_timerLimit, &QTimer::timeout, this, &Cli::expired);
+
+    connect(m_transport, &Transport::opened, this, &Cli::connected);
+    connect(m_transport, &Transport::closed, this, &Cli::disconnected);
+    connect(m_transport, &Transport::readyRead, this, &Cli::readyRead);
+    connect(m_transport, &Transport::openError, this, &Cli::openError);
+    connect(m_transport, &Transport::writeError, this, &Cli::ioError);
+    connect(m_transport, &Transport::errorOccurred, this, &Cli::ioError);
+    connect(m_transport, &Transport::captureError, this, &Cli::ioError);
+    connect(m_sessionLog, &SessionLog::error, this, &Cli::ioError);
+    connect(m_transport, &Transport::socketErrorOccurred, this, [=](QAbstractSocket::SocketError, const QString &message) {
+        if (m_connected) ioError(message); else openError(message);
+    });
+
+    connect(m_enumerator, &Enumerator::writeData, m_transport, &Transport::write);
+    connect(m_enumerator, &Enumerator::finished, this, &Cli::enumerationFinished);
+
+    connect(m_bridge, &Bridge::started, this, [=]() {
+        m_connected = true;
+        print(tr("Мост запущен: %1").arg(m_settings.name));
+    });
+    connect(m_bridge, &Bridge::stopped, this, &Cli::disconnected);
+    connect(m_bridge, &Bridge::peerChanged, this, [=](const QString &peer) {
+        print(peer.isEmpty() ? tr("Сеть отключена") : tr("Сеть подключена: %1").arg(peer));
+    });
+    connect(m_bridge, &Bridge::readyRead, this, &Cli::bridgeReadyRead);
+    connect(m_bridge, &Bridge::captureError, this, &Cli::ioError);
+    connect(m_bridge, &Bridge::errorOccurred, this, [=](const QString &message) {
+        if (m_connected) ioError(message); else openError(message);
+    });
+}
+
+int Cli::start(const QStringList &arguments) {
+    const int code = parse(arguments);
+    if (code >= 0) return code;
+
+    if (!m_out.open(stdout, QIODevice::WriteOnly)) {
+        print(m_out.errorString());
+        return ExitIo;
+    }
+    m_converter.setSettings(m_settings);
+    if (m_bridging) {
+        if (!m_capture.isEmpty()) m_bridge->startCapture(m_capture);
+        if (m_finished) return -1;
+        if (m_limit > 0) m_timerLimit->start(m_limit);
+        m_bridge->start(m_settings, m_bridgeSettings);
+        return -1;
+    }
+    if (!m_capture.isEmpty()) {
+        m_transport->startCapture(m_capture);
+        if (m_finished) return -1;                  // ошибка уже передана через finished
+    }
+    if (m_limit > 0) m_timerLimit->start(m_limit);
+    m_transport->open(m_settings);
+    return -1;
+}
+
+int Cli::parse(const QStringList &arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("%1 - консольный режим").arg(QCoreApplication::applicationName()));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption listPorts("list-ports", tr("Список последовательных портов."));
+    const QCommandLineOption listCrc("list-crc", tr("Список контрольных сумм."));
+    // подключение
+    const QCommandLineOption type(QStringList() << "t" << "type", tr("Тип подключения: serial, tcp, udp, broadcast."), "type", "serial");
+    const QCommandLineOption device(QStringList() << "d" << "device", tr("Последовательный порт."), "name");
+    const QCommandLineOption baud(QStringList() << "b" << "baud", tr("Скорость."), "rate", QString::number(QSerialPort::Baud38400));
+    const QCommandLineOption dataBits("data-bits", tr("Бит данных: 5..8."), "bits", "8");
+    const QCommandLineOption parity("parity", tr("Чётность: none, even, odd, space, mark."), "parity", "none");
+    const QCommandLineOption stopBits("stop-bits", tr("Стоп-бит: 1, 1.5, 2."), "bits", "1");
+    const QCommandLineOption flow("flow", tr("Управление потоком: none, hardware, software."), "flow", "none");
+    const QCommandLineOption dtr("dtr", tr("Установить DTR."));
+    const QCommandLineOption rts("rts", tr("Установить RTS."));
+    const QCommandLineOption host(QStringList() << "H" << "host", tr("Адрес TCP/UDP."), "host", DEFAULT_HOST);
+    const QCommandLineOption port(QStringList() << "p" << "port", tr("Порт TCP/UDP."), "port", QString::number(DEFAULT_PORT));
+    const QCommandLineOption timeoutWrite("write-timeout", tr("Таймаут записи в последовательный порт, мс."), "ms", QString::number(DEFAULT_TIMEOUT_WRITE));
+    // вывод
+    const QCommandLineOption quiet(QStringList() << "q" << "quiet", tr("Не выводить принятые данные."));
+    const QCommandLineOption echo("echo", tr("Выводить отправленные данные."));
+    const QCommandLineOption hex("hex", tr("Управляющие символы в шестнадцатеричном виде."));
+    const QCommandLineOption hexAll("hex-all", tr("Все символы в шестнадцатеричном виде."));
+    const QCommandLineOption linefeed("linefeed", tr("Перевод строки после символа с кодом, none - выкл."), "code", QString::number(DEFAULT_LINEFEED_CHAR));
+    const QCommandLineOption timeStamp("timestamp", tr("Метка времени блоков."));
+    const QCommandLineOption timeDelta("delta", tr("Интервал от предыдущего блока."));
+    const QCommandLineOption gap("gap", tr("Новая строка после паузы, мс."), "ms", "0");
+    const QCommandLineOption capture(QStringList() << "c" << "capture", tr("Записать захват в файл."), "file");
+    // журнал сеанса
+    const QCommandLineOption sessionLog("session-log", tr("Непрерывный журнал сеанса: сегменты захвата в папке."), "dir");
+    const QCommandLineOption logSegment("log-segment", tr("Размер сегмента журнала, МБ, 0 - без ограничения."), "mb", "64");
+    const QCommandLineOption logPeriod("log-period", tr("Период сегмента журнала, мин, 0 - без ограничения."), "min", "60");
+    const QCommandLineOption logKeep("log-keep", tr("Хранимых сегментов журнала, 0 - все."), "count", "100");
+    const QCommandLineOption logCompress("log-compress", tr("Сжимать журнал."));
+    // кадры
+    const QCommandLineOption frame("frame", tr("Разбиение приёма на кадры: none, delimiter, length, gap, slip, cobs."), "mode", "none");
+    const QCommandLineOption frameDelimiter("frame-delimiter", tr("Разделитель кадров (\\XX - байт)."), "delimiter", "\\0D\\0A");
+    const QCommandLineOption lengthOffset("length-offset", tr("Байт заголовка перед полем длины."), "bytes", "0");
+    const QCommandLineOption lengthSize("length-size", tr("Размер поля длины: 1, 2, 4."), "bytes", "1");
+    const QCommandLineOption lengthBigEndian("length-be", tr("Поле длины - старший байт первым."));
+    const QCommandLineOption lengthAdjust("length-adjust", tr("Поправка: кадр = заголовок + длина + поправка."), "bytes", "0");
+    const QCommandLineOption frameGap("frame-gap", tr("Пауза, завершающая кадр, мс."), "ms", "20");
+    const QCommandLineOption frameCrc("frame-crc", tr("Проверять контрольную сумму в конце кадра (список: --list-crc)."), "name");
+    // команды
+    const QCommandLineOption send(QStringList() << "s" << "send", tr("Команда (\\XX - байт, \\\\ - \\), можно несколько."), "command");
+    const QCommandLineOption file(QStringList() << "f" << "file", tr("Файл команд, по одной в строке."), "file");
+    const QCommandLineOption crc("crc", tr("Добавить контрольную сумму."), "name");
+    const QCommandLineOption interval(QStringList() << "i" << "interval", tr("Интервал между командами, мс."), "ms", "100");
+    const QCommandLineOption repeat(QStringList() << "n" << "repeat", tr("Повторов списка команд, 0 - бесконечно."), "count", "1");
+    const QCommandLineOption wait(QStringList() << "w" << "wait", tr("Ожидание после отправки, мс."), "ms", "1000");
+    const QCommandLineOption expect(QStringList() << "e" << "expect", tr("Завершить при получении образца, иначе - код 4."), "pattern");
+    const QCommandLineOption limit("limit", tr("Ограничение времени работы, мс."), "ms", "0");
+    const QCommandLineOption respond("respond", tr("Автоответчик: файл правил образец<TAB>ответ[<TAB>задержка, мс[<TAB>CRC]]."), "file");
+    // перебор
+    const QCommandLineOption enumerate("enumerate", tr("Перебор значений по формату (\\# - значение)."), "format");
+    const QCommandLineOption valueType("value-type", tr("Вид значения: dec, hex, binle, binbe."), "type", "dec");
+    const QCommandLineOption digits("digits", tr("Разрядов значения, для binle и binbe - байт (1..4)."), "count", "2");
+    const QCommandLineOption from("from", tr("Начальное значение."), "value", "0");
+    const QCommandLineOption to("to", tr("Конечное значение."), "value", "99");
+    const QCommandLineOption response("response", tr("Образец ответа (\\# - значение), без образца - принятый кадр (--frame)."), "pattern");
+    const QCommandLineOption window("window", tr("Запросов, одновременно ожидающих ответа."), "count", "1");
+    const QCommandLineOption timeout("timeout", tr("Ожидание ответа на значение, мс."), "ms", "100");
+    const QCommandLineOption hits("hits", tr("Сохранить ответившие значения в CSV."), "file");
+    // мост
+    const QCommandLineOption bridge("bridge", tr("Мост порта с сетью (--host, --port): tcp-server, tcp-client, udp."), "mode");
+    const QCommandLineOption tapRate("tap-rate", tr("Отвод моста в вывод и захват, байт/с, 0 - выкл."), "bytes", "16384");
+
+    parser.addOptions({listPorts, listCrc,
+                       type, device, baud, dataBits, parity, stopBits, flow, dtr, rts, host, port, timeoutWrite,
+                       quiet, echo, hex, hexAll, linefeed, timeStamp, timeDelta, gap, capture,
+                       sessionLog, logSegment, logPeriod, logKeep, logCompress,
+                       frame, frameDelimiter, lengthOffset, lengthSize, lengthBigEndian, lengthAdjust, frameGap, frameCrc,
+                       send, file, crc, interval, repeat, wait, expect, limit, respond,
+                       enumerate, valueType, digits, from, to, response, window, timeout, hits,
+                       bridge, tapRate});
+
+    if (!parser.parse(arguments)) {
+        print(parser.errorText());
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+    if (parser.isSet("version")) {
+        QTextStream(stdout) << QCoreApplication::applicationName() << " " << QCoreApplication::applicationVersion() << Qt::endl;
+        return ExitOk;
+    }
+    if (parser.isSet(listPorts)) {
+        QTextStream out(stdout);
+        for (const QSerialPortInfo &info : QSerialPortInfo::availablePorts()) {
+            out << info.portName() << "\t" << info.description() << Qt::endl;
+        }
+        return ExitOk;
+    }
+    if (parser.isSet(listCrc)) {
+        QTextStream out(stdout);
+        for (const QString &name : m_crc->list()) out << name << Qt::endl;
+        return ExitOk;
+    }
+
+    // числа: ошибка разбора - код ExitUsage
+    bool valid = true;
+    auto number = [&](const QCommandLineOption &option, qint64 min, qint64 max) -> qint64 {
+        bool ok;
+        const qint64 value = parser.value(option).toLongLong(&ok, 0); // 0x - шестнадцатеричное
+        if (!ok || value < min || value > max) {
+            print(tr("Недопустимое значение --%1: %2").arg(option.names().constLast(), parser.value(option)));
+            valid = false;
+        }
+        return value;
+    };
+
+    const QStringList types = {"serial", "tcp", "udp", "broadcast"};
+    const QStringList parities = {"none", "", "even", "odd", "space", "mark"}; // QSerialPort::Parity
+    const QStringList stops = {"", "1", "2", "1.5"};                            // QSerialPort::StopBits
+    const QStringList flows = {"none", "hardware", "software"};                // QSerialPort::FlowControl
+    const QStringList valueTypes = {"dec", "hex", "binle", "binbe"};           // Command::ValueType
+    const QStringList bridgeModes = {"tcp-server", "tcp-client", "udp"};       // Bridge::Mode
+    const QStringList framings = {"none", "delimiter", "length", "gap", "slip", "cobs"}; // Connection::Framing
+    const QStringList lengthSizes = {"", "1", "2", "", "4"};                   // байт
+    auto choice = [&](const QCommandLineOption &option, const QStringList &values) -> int {
+        const int idx = values.indexOf(parser.value(option).toLower());
+        if (idx < 0 || values.at(idx).isEmpty()) {
+            print(tr("Недопустимое значение --%1: %2").arg(option.names().constLast(), parser.value(option)));
+            valid = false;
+        }
+        return idx;
+    };
+
+    m_settings.type = Connection::Type(choice(type, types));
+    m_settings.timeoutWrite = int(number(timeoutWrite, 1, INT_MAX));
+    m_settings.name = parser.value(device);
+    m_settings.baudRate = qint32(number(baud, 1, INT_MAX));
+    m_settings.dataBits = QSerialPort::DataBits(number(dataBits, 5, 8));
+    m_settings.parity = QSerialPort::Parity(choice(parity, parities));
+    m_settings.stopBits = QSerialPort::StopBits(choice(stopBits, stops));
+    m_settings.flowControl = QSerialPort::FlowControl(choice(flow, flows));
+    m_settings.dtr = parser.isSet(dtr);
+    m_settings.rts = parser.isSet(rts);
+    m_settings.host = parser.value(host);
+    m_settings.port = quint16(number(port, 0, 65535));
+    m_settings.localEcho = parser.isSet(echo);
+    m_settings.timeStamp = parser.isSet(timeStamp);
+    m_settings.timeDelta = parser.isSet(timeDelta);
+    m_settings.gapThreshold = int(number(gap, 0, 60000));
+    m_settings.hexLog = parser.isSet(hex) || parser.isSet(hexAll);
+    m_settings.hexAll = parser.isSet(hexAll);
+    m_settings.linefeed = (parser.value(linefeed).toLower() != "none");
+    m_settings.linefeedChar = m_settings.linefeed ? char(number(linefeed, 0, 255)) : 0;
+    m_settings.scrollback = 0;
+    m_settings.refreshRate = 0;
+    m_settings.framing = Connection::Framing(choice(frame, framings));
+    m_settings.frameDelimiter = parser.value(frameDelimiter);
+    m_settings.frameLengthOffset = int(number(lengthOffset, 0, 1024));
+    m_settings.frameLengthSize = choice(lengthSize, lengthSizes);
+    m_settings.frameLengthBigEndian = parser.isSet(lengthBigEndian);
+    m_settings.frameLengthAdjust = int(number(lengthAdjust, -1024, 1024));
+    m_settings.frameGap = int(number(frameGap, 1, 60000));
+    m_settings.frameCrc = 0;
+    if (parser.isSet(frameCrc)) {
+        m_settings.frameCrc = m_crc->list().indexOf(parser.value(frameCrc));
+        if (m_settings.frameCrc < 0) {
+            print(tr("Неизвестная контрольная сумма: %1 (список: --list-crc)").arg(parser.value(frameCrc)));
+            valid = false;
+        }
+    }
+    m_settings.sessionLog = parser.isSet(sessionLog);
+    m_settings.sessionLogDir = parser.value(sessionLog);
+    m_settings.sessionLogSegmentSize = int(number(logSegment, 0, 65536));
+    m_settings.sessionLogSegmentTime = int(number(logPeriod, 0, 10080));
+    m_settings.sessionLogKeep = int(number(logKeep, 0, INT_MAX));
+    m_settings.sessionLogCompress = parser.isSet(logCompress);
+
+    m_quiet = parser.isSet(quiet);
+    m_capture = parser.value(capture);
+    m_interval = int(number(interval, 0, INT_MAX));
+    m_repeat = int(number(repeat, 0, INT_MAX));
+    m_wait = int(number(wait, 0, INT_MAX));
+    m_limit = int(number(limit, 0, INT_MAX));
+    m_expect = Command::fromString(parser.value(expect));
+
+    if (parser.isSet(crc)) {
+        m_crcIdx = m_crc->list().indexOf(parser.value(crc));
+        if (m_crcIdx < 0) {
+            print(tr("Неизвестная контрольная сумма: %1 (список: --list-crc)").arg(parser.value(crc)));
+            valid = false;
+        }
+    }
+
+    m_enumerate = parser.isSet(enumerate);
+    if (m_enumerate) {
+        m_format = parser.value(enumerate);
+        m_response = parser.value(response);
+        m_type = Command::ValueType(choice(valueType, valueTypes));
+        const bool binary = (m_type == Command::BinLittleEndian) || (m_type == Command::BinBigEndian);
+        m_digits = int(number(digits, 1, binary ? COMMAND_BINARY_DIGITS : 10));
+        m_from = number(from, INT_MIN, UINT_MAX);
+        m_to = number(to, m_from, UINT_MAX);
+        m_window = int(number(window, 1, 256));
+        m_timeout = int(number(timeout, 1, INT_MAX));
+        m_hits = parser.value(hits);
+        if (m_response.isEmpty() && (m_settings.framing == Connection::FrameNone)) {
+            print(tr("Перебору нужен образец ответа (--response) или разбиение на кадры (--frame)"));
+            valid = false;
+        }
+    }
+
+    m_bridging = parser.isSet(bridge);
+    if (m_bridging) {
+        m_bridgeSettings.mode = Bridge::Mode(choice(bridge, bridgeModes));
+        m_bridgeSettings.host = m_settings.host;
+        m_bridgeSettings.port = m_settings.port;
+        m_bridgeSettings.tapRate = int(number(tapRate, 0, INT_MAX));
+        if (m_quiet && m_capture.isEmpty()) m_bridgeSettings.tapRate = 0; // отвод некуда выводить
+        if ((m_settings.type != Connection::Serial) || m_enumerate || parser.isSet(send) || parser.isSet(file)) {
+            print(tr("Мост соединяет последовательный порт с сетью, отправка команд и перебор недоступны"));
+            valid = false;
+        }
+        if (m_settings.sessionLog) {
+            print(tr("Журнал сеанса недоступен в режиме моста, используйте --capture"));
+            valid = false;
+        }
+    }
+
+    if (!valid) return ExitUsage;
+
+    // команды: из параметров, затем из файла
+    QStringList commands = parser.values(send);
+    if (parser.isSet(file)) {
+        QFile f(parser.value(file));
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            print(tr("Ошибка открытия '%1': %2").arg(f.fileName(), f.errorString()));
+            return ExitUsage;
+        }
+        while (!f.atEnd()) {
+            const QString line = QString::fromLocal8Bit(f.readLine()).remove('\n');
+            if (!line.isEmpty()) commands << line;
+        }
+    }
+    for (const QString &command : std::as_const(commands)) {
+        QByteArray cmd = Command::fromString(command);
+        m_commands << m_crc->addCrc(cmd, m_crcIdx);
+    }
+
+    m_responding = parser.isSet(respond);
+    if (m_responding) {
+        if (m_bridging) {
+            print(tr("Автоответчик недоступен в режиме моста"));
+            return ExitUsage;
+        }
+        Responder::Rules rules;
+        const QString error = Responder::load(parser.value(respond), rules);
+        if (!error.isEmpty()) {
+            print(error);
+            return ExitUsage;
+        }
+        m_transport->setResponder(rules);
+    }
+
+    if (m_settings.sessionLog) {
+        m_sessionLog->setSettings(m_settings);
+        m_transport->setSessionLog(m_sessionLog);
+    }
+
+    if ((m_settings.type == Connection::Serial) && m_settings.name.isEmpty()) {
+        print(tr("Не задан последовательный порт (--device)"));
+        return ExitUsage;
+    }
+    return -1;
+}
+
+void Cli::stop() {
+    finish(m_expect.isEmpty() ? ExitOk : ExitTimeout);
+}
+
+void Cli::connected() {
+    m_connected = true;
+    if (m_enumerate) {
+        const QString format = m_format;
+        const QString response = m_response;
+        const Command::ValueType type = m_type;
+        const int digits = m_digits;
+        const int crc = m_crcIdx;
+        Enumerator::Builder expected;
+        if (!response.isEmpty()) expected = [=](qint64 addr) { return Command::fromFormat(response, addr, type, digits); };
+        m_enumerator->start(m_from, m_to, m_window, qint64(m_timeout) * 1000000,
+                            [=](qint64 addr) {
+                                QByteArray cmd = Command::fromFormat(format, addr, type, digits);
+                                return m_crc->addCrc(cmd, crc);
+                            },
+                            expected, m_settings.framing != Connection::FrameNone);
+    } else if (!m_commands.isEmpty()) {
+        sendNext();
+    }
+    // без команд - приём до --limit, образца --expect или прерывания
+}
+
+void Cli::disconnected() {
+    if (m_connected) finish(ExitIo, tr("Соединение разорвано"));
+}
+
+void Cli::readyRead() {
+    Transport::Chunk chunk;
+    QByteArray out;
+    while (m_transport->read(chunk)) {
+        if (chunk.direction == Capture::Rx) {
+            if (m_enumerator->isActive()) m_enumerator->receivedData(chunk.data, chunk.timestamp);
+            if (!m_expect.isEmpty()) m_buffer.append(chunk.data);
+        } else if (!m_settings.localEcho) {
+            continue;
+        }
+        if (!m_quiet) out.append(m_converter.convert(chunk.data, Timestamp::toNSecsSinceEpoch(chunk.timestamp), chunk.check));
+    }
+    if (!out.isEmpty()) {
+        m_out.write(out);
+        m_out.flush();
+    }
+    if (!m_expect.isEmpty() && !m_finished) {
+        if (m_buffer.contains(m_expect)) {
+            finish(ExitOk);
+        } else if (m_buffer.size() > m_expect.size()) {
+            m_buffer.remove(0, m_buffer.size() - m_expect.size()); // образец может начинаться в хвосте
+        }
+    }
+}
+
+void Cli::bridgeReadyRead() {
+    Transport::Chunk chunk;
+    QByteArray out;
+    while (m_bridge->read(chunk)) {
+        if (!m_quiet) out.append(m_converter.convert(chunk.data, Timestamp::toNSecsSinceEpoch(chunk.timestamp)));
+    }
+    if (!out.isEmpty()) {
+        m_out.write(out);
+        m_out.flush();
+    }
+}
+
+void Cli::sendNext() {
+    if (m_finished) return;
+    m_transport->write(m_commands.at(m_next));
+    if (++m_next >= m_commands.size()) {
+        m_next = 0;
+        if ((m_repeat > 0) && (++m_round >= m_repeat)) {
+            done();
+            return;
+        }
+    }
+    m_timerSend->start(m_interval);
+}
+
+void Cli::enumerationFinished() {
+    if (m_finished) return;
+    print(tr("Перебор: отправлено %1, ответили %2, без ответа %3, время %4 с")
+          .arg(m_enumerator->sent())
+          .arg(m_enumerator->hits().size())
+          .arg(m_enumerator->timeouts())
+          .arg(m_enumerator->elapsed() / 1000000000.0, 0, 'f', 3));
+    const int base = (m_type == Command::Dec) ? 10 : 16;
+    for (const Enumerator::Hit &hit : m_enumerator->hits()) {
+        print(tr("%1 - %2 мс").arg(Enumerator::addrToString(hit.addr, base)).arg(hit.latency / 1000000.0, 0, 'f', 3));
+    }
+    if (!m_hits.isEmpty() && !m_enumerator->exportHits(m_hits, base)) {
+        finish(ExitIo, tr("Ошибка записи в '%1': %2").arg(m_hits, m_enumerator->errorString()));
+        return;
+    }
+    done();
+}
+
+void Cli::expired() {
+    if (m_expect.isEmpty()) {
+        finish(ExitOk);
+    } else {
+        finish(ExitTimeout, tr("Ответ не получен"));
+    }
+}
+
+void Cli::openError(const QString &message) {
+    finish(ExitOpen, message);
+}
+
+void Cli::ioError(const QString &message) {
+    finish(ExitIo, message);
+}
+
+void Cli::done() {
+    m_timerWait->start(m_wait);
+}
+
+void Cli::finish(int code, const QString &message) {
+    if (m_finished) return;
+    m_finished = true;
+    if (!message.isEmpty()) print(message);
+    m_timerSend->stop();
+    m_timerWait->stop();
+    m_timerLimit->stop();
+    m_connected = false;                            // закрытие ниже - не разрыв
+    m_enumerator->stop();
+    readyRead();                                    // остаток очереди
+    m_transport->stopCapture();
+    m_transport->close();
+    if (m_settings.frameCrc > 0) {
+        // не более одной ошибки на кадр - оценка BER снизу
+        const Transport::Statistics statistics = m_transport->statistics();
+        const double bits = statistics.crcBytes * 8.0;
+        print(tr("CRC: верно %1, ошибка %2, проверено %3 байт, BER не менее %4")
+              .arg(statistics.crcOk)
+              .arg(statistics.crcFailed)
+              .arg(statistics.crcBytes)
+              .arg((bits > 0) ? statistics.crcFailed / bits : 0.0, 0, 'e', 2));
+    }
+    if (m_responding) print(tr("Автоответов: %1").arg(m_transport->statistics().responses));
+    if (m_settings.sessionLog) {
+        m_transport->setSessionLog(nullptr);
+        print(tr("Журнал сеанса: %1, потеряно %2 байт").arg(m_settings.sessionLogDir).arg(m_sessionLog->dropped()));
+    }
+    if (m_bridging) {
+        bridgeReadyRead();
+        m_bridge->stopCapture();
+        m_bridge->stop();
+        print(tr("Мост: порт -> сеть %1 байт, сеть -> порт %2 байт, мимо отвода %3 байт, не отправлено %4 байт")
+              .arg(m_bridge->forwarded(Capture::Rx))
+              .arg(m_bridge->forwarded(Capture::Tx))
+              .arg(m_bridge->dropped())
+              .arg(m_bridge->unsent()));
+    }
+    m_out.flush();
+    emit finished(code);
+}
+
+void Cli::print(const QString &message) {
+    QTextStream(stderr) << message << Qt::endl;
+}
@@ -0,0 +1,104 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <QObject>
+#include <QFile>
+#include "connection.h"
+#include "converter.h"
+#include "command.h"
+#include "bridge.h"
+
+class QTimer;
+class Transport;
+class Crc;
+class Enumerator;
+class SessionLog;
+
+// Консольный режим без виджетов: подключение по параметрам командной строки,
+// отправка списка команд или перебор, вывод приёма в stdout и/или захват;
+// либо мост последовательного порта с сетью с выводом отвода.
+class Cli : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef enum {
+        ExitOk = 0,
+        ExitUsage = 1,                              // ошибка в параметрах
+        ExitOpen = 2,                               // не удалось подключиться
+        ExitIo = 3,                                 // ошибка чтения/записи, разрыв связи
+        ExitTimeout = 4                             // ожидаемый ответ не получен
+    } ExitCode;
+
+    explicit Cli(QObject *parent = nullptr);
+
+    int start(const QStringList &arguments);        // -1 - работа продолжается, иначе код завершения
+
+public slots:
+    void stop();                                    // прерывание пользователем
+
+signals:
+    void finished(int code);
+
+private slots:
+    void connected();
+    void disconnected();
+    void readyRead();
+    void sendNext();
+    void enumerationFinished();
+    void bridgeReadyRead();
+    void expired();                                 // истекло ожидание или ограничение времени
+    void openError(const QString &message);
+    void ioError(const QString &message);
+
+private:
+    int parse(const QStringList &arguments);
+    void finish(int code, const QString &message = QString());
+    void done();                                    // всё отправлено - ожидание ответа
+    static void print(const QString &message);      // в stderr
+
+    Connection::Settings m_settings;
+    Transport *m_transport = nullptr;
+    Crc *m_crc = nullptr;
+    Enumerator *m_enumerator = nullptr;
+    Bridge *m_bridge = nullptr;
+    SessionLog *m_sessionLog = nullptr;
+    Converter m_converter;
+    QTimer *m_timerSend = nullptr;
+    QTimer *m_timerWait = nullptr;
+    QTimer *m_timerLimit = nullptr;
+    QFile m_out;
+
+    QList<QByteArray> m_commands;                   // с CRC, готовые к отправке
+    int m_next = 0;
+    int m_repeat = 1;                               // 0 - бесконечно
+    int m_round = 0;
+    int m_interval = 100;                           // мс между командами
+    int m_wait = 1000;                              // мс ожидания после отправки
+    int m_limit = 0;                                // мс на всю работу, 0 - без ограничения
+    int m_crcIdx = 0;
+    QByteArray m_expect;
+    QByteArray m_buffer;                            // приём для поиска m_expect
+    bool m_quiet = false;
+    QString m_capture;
+
+    bool m_enumerate = false;
+    QString m_format;
+    QString m_response;
+    Command::ValueType m_type = Command::Dec;
+    int m_digits = 2;
+    qint64 m_from = 0;
+    qint64 m_to = 0;
+    int m_window = 1;
+    int m_timeout = 100;                            // мс ожидания ответа на значение
+    QString m_hits;
+
+    bool m_bridging = false;
+    bool m_responding = false;
+    Bridge::Settings m_bridgeSettings;
+
+    bool m_connected = false;
+    bool m_finished = false;
+};
+
+#endif // CLI_H
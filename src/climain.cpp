@@ -0,0 +1,64 @@
+#include <QCoreApplication>
+#include "cli.h"
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#else
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Прерывание (Ctrl+C, SIGTERM) - штатное завершение с закрытием захвата
+
+static Cli *cli = nullptr;
+
+#if defined(Q_OS_WIN)
+static BOOL WINAPI consoleHandler(DWORD type) {
+    if (type != CTRL_C_EVENT && type != CTRL_BREAK_EVENT && type != CTRL_CLOSE_EVENT) return FALSE;
+    QMetaObject::invokeMethod(cli, &Cli::stop, Qt::QueuedConnection); // обработчик - в отдельном потоке
+    return TRUE;
+}
+
+static void installInterruptHandler() {
+    SetConsoleCtrlHandler(consoleHandler, TRUE);
+}
+#else
+static int signalFd[2] = {-1, -1};
+
+static void signalHandler(int) {
+    const char c = 1;
+    if (::write(signalFd[0], &c, 1) < 0) {} // только async-signal-safe вызовы
+}
+
+static void installInterruptHandler() {
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalFd) != 0) return;
+    QSocketNotifier *notifier = new QSocketNotifier(signalFd[1], QSocketNotifier::Read, cli);
+    QObject::connect(notifier, &QSocketNotifier::activated, cli, [=]() {
+        char c;
+        if (::read(signalFd[1], &c, 1) > 0) cli->stop();
+    });
+    struct sigaction action = {};
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    QCoreApplication::setOrganizationName(APP_NAME);
+    QCoreApplication::setApplicationName(APP_NAME);
+    QCoreApplication::setApplicationVersion(APP_VERSION);
+
+    QCoreApplication a(argc, argv);
+    Cli c;
+    cli = &c;
+    QObject::connect(&c, &Cli::finished, &a, &QCoreApplication::exit, Qt::QueuedConnection);
+    const int code = c.start(a.arguments());
+    if (code >= 0) return code;
+    installInterruptHandler();
+    return a.exec();
+}
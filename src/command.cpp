@@ -0,0 +1,103 @@
+#include "command.h"
+
+QByteArray Command::fromString(const QString &value) {
+    QByteArray result;
+    int idx=0;
+    while (idx < value.length()) {
+        if (value.at(idx) == '\\' && idx + 1 < value.length()) {
+            if (value.at(idx+1) == '\\') {
+                result += '\\';
+                idx+=1;
+            } else {
+                result += value.mid(idx+1,2).toInt(nullptr, 16);
+                idx+=2;
+            }
+        } else {
+            result.append(QString(value.at(idx)).toLocal8Bit());
+        }
+        idx++;
+    }
+    return result;
+}
+
+QByteArray Command::fromFormat(const QString &format, qint64 value, ValueType type, int digits) {
+    QByteArray result;
+    int idx=0;
+    while (idx < format.length()) {
+        if (format.at(idx) == '\\' && idx + 1 < format.length()) {
+            if (format.at(idx+1) == '\\') {
+                result += '\\';
+                idx+=1;
+            } else if (format.at(idx+1) == '#') {
+                switch (type) {
+                case Hex: result.append(QStringLiteral("%1").arg(value, digits, 16, QLatin1Char('0')).toLocal8Bit()); break;
+                case BinLittleEndian: result.append(toBinary(value, digits, QDataStream::LittleEndian)); break;
+                case BinBigEndian: result.append(toBinary(value, digits, QDataStream::BigEndian)); break;
+                default: result.append(QString("%1").arg(value, digits, 10, QLatin1Char('0')).toLocal8Bit()); break; // Dec
+                }
+                idx+=1;
+            } else {
+                result += format.mid(idx+1,2).toInt(nullptr, 16);
+                idx+=2;
+            }
+        } else {
+            result.append(QString(format.at(idx)).toLocal8Bit());
+        }
+        idx++;
+    }
+    return result;
+}
+
+QByteArray Command::toBinary(qint64 value, int digits, QDataStream::ByteOrder byteOrder) {
+    QByteArray bin, res;
+    QDataStream ds(&bin, QIODevice::ReadWrite);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(value);
+
+    switch (digits) {
+    case 1: switch (byteOrder) {
+        case QDataStream::LittleEndian:
+        case QDataStream::BigEndian:
+            res.append(bin.at(3));
+            break;
+        }
+        break;
+    case 2: switch (byteOrder) {
+        case QDataStream::LittleEndian:
+            res.append(bin.at(3));
+            res.append(bin.at(2));
+            break;
+        case QDataStream::BigEndian:
+            res.append(bin.at(2));
+            res.append(bin.at(3));
+            break;
+        }
+        break;
+    case 3: switch (byteOrder) {
+        case QDataStream::LittleEndian:
+            res.append(bin.at(3));
+            res.append(bin.at(2));
+            res.append(bin.at(1));
+            break;
+        case QDataStream::BigEndian:
+            res.append(bin.at(1));
+            res.append(bin.at(2));
+            res.append(bin.at(3));
+            break;
+        }
+        break;
+    case 4: switch (byteOrder) {
+        case QDataStream::LittleEndian:
+            res.append(bin.at(3));
+            res.append(bin.at(2));
+            res.append(bin.at(1));
+            res.append(bin.at(0));
+            break;
+        case QDataStream::BigEndian:
+            res.append(bin);
+            break;
+        }
+        break;
+    }
+    return res;
+}
@@ -0,0 +1,30 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <QByteArray>
+#include <QString>
+#include <QDataStream>
+
+#define COMMAND_BINARY_DIGITS   4                   // наибольшее число байт двоичного значения перебора
+
+// Разбор текстовой записи команд:
+//   \XX - байт в шестнадцатеричном виде, \\ - обратная косая черта,
+//   \# - значение перебора (только в формате перебора).
+// Обратная косая черта в конце строки - сама себя.
+class Command
+{
+public:
+    // Представление значения перебора (индексы списка типов в окне)
+    typedef enum {
+        Dec = 0,
+        Hex = 1,
+        BinLittleEndian = 2,
+        BinBigEndian = 3
+    } ValueType;
+
+    static QByteArray fromString(const QString &value);
+    static QByteArray fromFormat(const QString &format, qint64 value, ValueType type, int digits);
+    static QByteArray toBinary(qint64 value, int digits, QDataStream::ByteOrder byteOrder); // digits - 1..COMMAND_BINARY_DIGITS
+};
+
+#endif // COMMAND_H
@@ -0,0 +1,79 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <QString>
+#include <QSerialPort>
+
+// Параметры подключения и вывода без зависимости от виджетов:
+// общие для окна настроек, транспорта и консольного режима.
+class Connection
+{
+public:
+    typedef enum {
+        Serial = 0,
+        Tcp = 1,
+        UdpUnicast = 2,
+        UdpBroadcast = 3
+    } Type;
+
+    typedef enum {
+        FrameNone = 0,
+        FrameDelimiter = 1,         // до разделителя включительно
+        FrameLength = 2,            // длина в заголовке
+        FrameGap = 3,               // по паузе между байтами
+        FrameSlip = 4,              // RFC 1055
+        FrameCobs = 5
+    } Framing;
+
+    typedef struct {
+        Type type;
+        int timeoutWrite;
+
+        // comport
+        QString name;
+        qint32 baudRate;
+        QSerialPort::DataBits dataBits;
+        QSerialPort::Parity parity;
+        QSerialPort::StopBits stopBits;
+        QSerialPort::FlowControl flowControl;
+        bool dtr;
+        bool rts;
+
+        // tcp
+        QString host;
+        quint16 port;
+
+        // terminal
+        bool localEcho;
+        bool timeStamp;
+        bool timeDelta;             // интервал от предыдущего блока
+        int gapThreshold;           // мс, пауза начала новой строки, 0 - выкл.
+        bool hexLog;
+        bool hexAll;
+        bool linefeed;
+        char linefeedChar;
+        int scrollback;             // МБ
+        int refreshRate;            // Гц, 0 - без ограничения
+
+        // framing
+        Framing framing;
+        QString frameDelimiter;     // как в командах: \XX - байт
+        int frameLengthOffset;      // байт перед полем длины
+        int frameLengthSize;        // 1, 2, 4
+        bool frameLengthBigEndian;
+        int frameLengthAdjust;      // кадр = заголовок + значение длины + поправка
+        int frameGap;               // мс
+        int frameCrc;               // индекс в Crc::list(), 0 - без проверки
+
+        // session log
+        bool sessionLog;
+        QString sessionLogDir;
+        int sessionLogSegmentSize;  // МБ на диске, 0 - без ограничения
+        int sessionLogSegmentTime;  // мин, 0 - без ограничения
+        int sessionLogKeep;         // сегментов, 0 - все
+        bool sessionLogCompress;
+
+    } Settings;
+};
+
+#endif // CONNECTION_H
@@ -1,39 +1,573 @@
 #include "console.h"
 #include <QScrollBar>
 #include <QFont>
+#include <QFontDatabase>
+#include <QPainter>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QApplication>
+#include <QClipboard>
+#include <QThread>
+#include <climits>
+#include <algorithm>
 
-Console::Console(QWidget *parent): QPlainTextEdit(parent) {
+#define CONSOLE_MARGIN      4       ///< Отступ текста от края
+#define CONSOLE_LONG_LINE   4096    ///< Длина строки, после которой считаем ширину символа постоянной
+#define CONSOLE_PRUNE       4096    ///< Вхождений в вытесненных строках, после которого они удаляются
+
+Console::Console(QWidget *parent): QAbstractScrollArea(parent) {
     const QFont fixedFont = QFontDatabase::systemFont(QFontDatabase::FixedFont);
-    document()->setDefaultFont(fixedFont);
+    setFont(fixedFont);
 
     setBackgroundRole(QPalette::Base);
     setAutoFillBackground(true);
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    verticalScrollBar()->setSingleStep(1);
+
+    connect(&m_log, &LogFile::indexChanged, this, &Console::logIndexChanged);
 
-    setReadOnly(true);
+    updateMetrics();
+    updateScrollBars();
 }
 
-void Console::putData(const QByteArray &data) {    
-    QTextCursor cursor = textCursor();
-    cursor.movePosition(QTextCursor::End);
-    setTextCursor(cursor);
-    insertPlainText(QString::fromLocal8Bit(data));
+Console::~Console() {
+    if (!m_searchThread) return;
+    m_searcher->restart();                          // прервать текущий проход
+    m_searchThread->quit();
+    m_searchThread->wait();
+    delete m_searcher;
+}
+
+void Console::putData(const QByteArray &data) {
+    if (data.isEmpty()) return;
+    if (m_log.isOpen()) closeLog();
     QScrollBar *bar = verticalScrollBar();
-    bar->setValue(bar->maximum());
+    const bool atBottom = (bar->value() >= bar->maximum());
+    const qint64 dropped = m_buffer.droppedLines();
+    const int value = bar->value();
+
+    m_buffer.append(data);
+    if (m_searchMirror) {
+        Searcher *searcher = m_searcher;
+        const int generation = m_searchGeneration;
+        QMetaObject::invokeMethod(searcher, [=]() { searcher->append(data, generation); });
+    }
+    updateScrollBars();
+    if (atBottom) {
+        bar->setValue(bar->maximum());
+    } else {
+        bar->setValue(value - int(m_buffer.droppedLines() - dropped)); // удержать видимые строки на месте
+    }
+    viewport()->update();
+    emit textChanged();
+}
+
+bool Console::isEmpty() const {
+    return m_log.isOpen() ? (m_log.size() == 0) : m_buffer.isEmpty();
+}
+
+qsizetype Console::scrollback() const {
+    return m_buffer.capacity();
+}
+
+void Console::setScrollback(qsizetype bytes) {
+    if (bytes == m_buffer.capacity()) return;
+    if (m_log.isOpen()) {
+        m_buffer.setCapacity(bytes);                // пока открыт файл, буфер пуст
+        return;
+    }
+    QByteArray content;
+    for (qsizetype i = 0; i < m_buffer.lineCount(); ++i) {
+        if (i) content.append('\n');
+        content.append(m_buffer.line(i));
+    }
+    m_buffer.setCapacity(bytes);
+    if (m_searchMirror) {                           // копия пересобирается из того же содержимого в putData()
+        Searcher *searcher = m_searcher;
+        QMetaObject::invokeMethod(searcher, [=]() { searcher->setCapacity(bytes); });
+    }
+    m_anchor = m_cursor = {0, 0};
+    putData(content);
+    if (m_searchGeneration) restartSearch();
+}
+
+QString Console::toPlainText() const {
+    QByteArray content;
+    content.reserve(m_log.isOpen() ? m_log.size() : m_buffer.size());
+    for (qsizetype i = 0; i < lineCount(); ++i) {
+        if (i) content.append('\n');
+        content.append(lineBytes(i));
+    }
+    return QString::fromLocal8Bit(content);
+}
+
+void Console::setPlainText(const QString &text) {
+    clear();
+    putData(text.toLocal8Bit());
+}
+
+bool Console::openLog(const QString &fileName) {
+    clear();
+    if (!m_log.open(fileName)) return false;
+    // строки появляются по мере индексации, первая страница - почти сразу
+    if (m_searchGeneration) restartSearch();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+    emit textChanged();
+    return true;
+}
+
+void Console::closeLog() {
+    if (!m_log.isOpen()) return;
+    const bool hadSelection = hasSelection();
+    m_log.close();                                  // отображение освобождает поиск, если он ещё идёт
+    m_anchor = m_cursor = {0, 0};
+    if (m_searchGeneration) restartSearch();
+    updateScrollBars();
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    viewport()->update();
+    emit textChanged();
+    if (hadSelection) emit copyAvailable(false);
+}
+
+QString Console::logFileName() const {
+    return m_log.fileName();
+}
+
+QString Console::logErrorString() const {
+    return m_log.errorString();
+}
+
+void Console::logIndexChanged() {
+    updateScrollBars();
+    viewport()->update();
+    emit logIndexed(m_log.indexedSize(), m_log.size(), m_log.isIndexed());
+}
+
+void Console::startSearch(const QRegularExpression &re) {
+    if (!m_searchThread) {
+        m_searchThread = new QThread(this);
+        m_searcher = new Searcher;
+        m_searcher->moveToThread(m_searchThread);
+        connect(m_searcher, &Searcher::readyRead, this, &Console::searchReadyRead);
+        m_searchThread->start(QThread::LowPriority);
+    }
+    m_searchRe = re;
+    restartSearch();
+}
+
+void Console::stopSearch() {
+    if (!m_searchGeneration) return;
+    Searcher *searcher = m_searcher;
+    const int generation = searcher->restart();
+    QMetaObject::invokeMethod(searcher, [=]() { searcher->stop(generation); });
+    m_searchGeneration = 0;
+    m_searchMirror = false;
+    m_pendingFind = 0;
+    m_matches.clear();
+    m_matches.squeeze();
+    viewport()->update();
+    emit matchesChanged(0, true);
+}
+
+bool Console::findMatch(bool backward) {
+    if (!m_searchGeneration) return false;
+    const bool forwardOrder = (m_anchor.line < m_cursor.line) || ((m_anchor.line == m_cursor.line) && (m_anchor.column <= m_cursor.column));
+    Position start;
+    if (backward) {
+        start = forwardOrder ? m_anchor : m_cursor;
+    } else {
+        start = forwardOrder ? m_cursor : m_anchor;
+    }
+
+    // первое вхождение, начинающееся не раньше start
+    const Searcher::Matches::const_iterator first = firstMatch(droppedLines());
+    Searcher::Matches::const_iterator it = std::lower_bound(first, m_matches.cend(), start,
+        [](const Searcher::Match &match, const Position &position) {
+            return (match.line < position.line) || ((match.line == position.line) && (match.column < position.column));
+        });
+    if (backward) {
+        if (!m_searchDone && (m_searchScanned <= start.line)) {
+            m_pendingFind = -1;                     // до start ещё не всё просмотрено
+            return true;
+        }
+        if (it == first) return false;
+        --it;
+    } else if (it == m_matches.cend()) {
+        if (m_searchDone) return false;
+        m_pendingFind = 1;
+        return true;
+    }
+    setSelection({it->line, it->column}, {it->line, it->column + it->length});
+    ensureVisible(m_cursor);
+    return true;
+}
+
+void Console::setHighlightAll(bool enabled) {
+    if (enabled == m_highlightAll) return;
+    m_highlightAll = enabled;
+    viewport()->update();
+}
+
+qsizetype Console::matchCount() const {
+    return m_matches.cend() - firstMatch(droppedLines());
+}
+
+void Console::searchReadyRead() {
+    Searcher::Batch batch;
+    bool changed = false;
+    while (m_searcher->read(batch)) {
+        if (batch.generation != m_searchGeneration) continue;
+        // вхождения в просмотренной заново последней строке заменяются
+        m_matches.erase(firstMatch(batch.from), m_matches.cend());
+        m_matches.append(batch.matches);
+        m_searchScanned = batch.scanned;
+        m_searchDone = batch.done;
+        changed = true;
+    }
+    if (!changed) return;
+
+    const Searcher::Matches::const_iterator first = firstMatch(droppedLines());
+    if (first - m_matches.cbegin() > CONSOLE_PRUNE) m_matches.erase(m_matches.cbegin(), first);
+    if (m_pendingFind) {
+        const bool backward = (m_pendingFind < 0);
+        m_pendingFind = 0;
+        findMatch(backward);
+    }
+    if (m_highlightAll) viewport()->update();
+    emit matchesChanged(matchCount(), m_searchDone);
+}
+
+void Console::restartSearch() {
+    m_searchGeneration = m_searcher->restart();
+    m_matches.clear();
+    m_searchScanned = droppedLines();
+    m_searchDone = false;
+    m_pendingFind = 0;
+    Searcher *searcher = m_searcher;
+    const QRegularExpression re = m_searchRe;
+    const int generation = m_searchGeneration;
+    if (m_log.isOpen()) {
+        const LogFile::MappingPtr log = m_log.mapping();
+        QMetaObject::invokeMethod(searcher, [=]() { searcher->startLog(log, re, generation); });
+        m_searchMirror = false;                     // startLog() освобождает копию
+    } else if (m_searchMirror) {
+        QMetaObject::invokeMethod(searcher, [=]() { searcher->rescan(re, generation); });
+    } else {
+        // единственное полное копирование за поиск; дальше копию ведут putData(), clear() и setScrollback()
+        const LineBuffer snapshot = m_buffer;
+        QMetaObject::invokeMethod(searcher, [=]() { searcher->start(snapshot, re, generation); });
+        m_searchMirror = true;
+    }
+    viewport()->update();
+    emit matchesChanged(0, false);
+}
+
+Searcher::Matches::const_iterator Console::firstMatch(qint64 line) const {
+    return std::lower_bound(m_matches.cbegin(), m_matches.cend(), line, [](const Searcher::Match &match, qint64 value) {
+        return match.line < value;
+    });
+}
+
+void Console::clear() {
+    const bool hadSelection = hasSelection();
+    m_log.close();
+    m_buffer.clear();
+    if (m_searchMirror) {
+        Searcher *searcher = m_searcher;
+        QMetaObject::invokeMethod(searcher, [=]() { searcher->clear(); });
+    }
+    m_anchor = m_cursor = {0, 0};
+    if (m_searchGeneration) restartSearch();
+    updateScrollBars();
+    viewport()->update();
+    emit textChanged();
+    if (hadSelection) emit copyAvailable(false);
+}
+
+void Console::copy() {
+    if (!hasSelection()) return;
+    const bool forwardOrder = (m_anchor.line < m_cursor.line) || ((m_anchor.line == m_cursor.line) && (m_anchor.column <= m_cursor.column));
+    Position start = forwardOrder ? m_anchor : m_cursor;
+    const Position end = forwardOrder ? m_cursor : m_anchor;
+    if (start.line < droppedLines()) start = {droppedLines(), 0};
+
+    QString result;
+    for (qint64 line = start.line; line <= end.line; ++line) {
+        const QString text = lineText(line);
+        const int from = (line == start.line) ? qMin(start.column, int(text.size())) : 0;
+        const int to = (line == end.line) ? qMin(end.column, int(text.size())) : int(text.size());
+        result.append(text.mid(from, to - from));
+        if (line != end.line) result.append('\n');
+    }
+    QApplication::clipboard()->setText(result);
+}
+
+void Console::selectAll() {
+    if (isEmpty() || !lineCount()) return;
+    const qint64 first = droppedLines();
+    const qint64 last = first + lineCount() - 1;
+    setSelection({first, 0}, {last, int(lineText(last).size())});
 }
 
 void Console::keyPressEvent(QKeyEvent *e) {
     switch (e->key()) {
-    case Qt::Key_Backspace:
-    case Qt::Key_Left:
-    case Qt::Key_Right:
     case Qt::Key_Up:
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        break;
     case Qt::Key_Down:
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        break;
+    case Qt::Key_PageUp:
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepSub);
+        break;
+    case Qt::Key_PageDown:
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepAdd);
+        break;
+    case Qt::Key_Left:
+        horizontalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        break;
+    case Qt::Key_Right:
+        horizontalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        break;
+    case Qt::Key_Backspace:
     case Qt::Key_Alt:
     case Qt::Key_Shift:
     case Qt::Key_Control:
-        QPlainTextEdit::keyPressEvent(e);
         break;
     default:
-        emit getData(e->text().toLocal8Bit());
+        if (!e->text().isEmpty()) emit getData(e->text().toLocal8Bit());
+    }
+}
+
+void Console::paintEvent(QPaintEvent *e) {
+    Q_UNUSED(e)
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().brush(backgroundRole()));
+    painter.setFont(font());
+
+    const int first = verticalScrollBar()->value();
+    const int dx = horizontalScrollBar()->value();
+    const int count = int(qMin<qsizetype>(visibleLines() + 1, lineCount() - first));
+    const bool selection = hasSelection();
+    const bool forwardOrder = (m_anchor.line < m_cursor.line) || ((m_anchor.line == m_cursor.line) && (m_anchor.column <= m_cursor.column));
+    const Position start = forwardOrder ? m_anchor : m_cursor;
+    const Position end = forwardOrder ? m_cursor : m_anchor;
+    QColor found = palette().color(QPalette::Highlight);
+    found.setAlpha(80);
+
+    for (int i = 0; i < count; ++i) {
+        const qsizetype idx = first + i;
+        const qint64 line = droppedLines() + idx;
+        const int y = i * m_lineHeight;
+
+        // для длинных строк декодируется только видимая часть
+        int offset = 0;
+        int x = CONSOLE_MARGIN - dx;
+        QString text;
+        if (lineLength(idx) > CONSOLE_LONG_LINE) {
+            offset = qMax(0, dx / m_charWidth - 1);
+            text = QString::fromLocal8Bit(lineBytes(idx, offset, viewport()->width() / m_charWidth + 2));
+            x += offset * m_charWidth;
+        } else {
+            text = QString::fromLocal8Bit(lineBytes(idx));
+        }
+
+        if (m_highlightAll) {
+            for (auto it = firstMatch(line); (it != m_matches.cend()) && (it->line == line); ++it) {
+                const int from = qBound(0, it->column - offset, int(text.size()));
+                const int to = qBound(0, it->column + it->length - offset, int(text.size()));
+                if (to <= from) continue;
+                const int xs = x + columnX(text, from);
+                painter.fillRect(QRect(xs, y, x + columnX(text, to) - xs, m_lineHeight), found);
+            }
+        }
+
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(x, y + m_ascent, text);
+
+        if (selection && (line >= start.line) && (line <= end.line)) {
+            const int from = qBound(0, ((line == start.line) ? start.column : 0) - offset, int(text.size()));
+            const int to = qBound(0, ((line == end.line) ? end.column : int(text.size()) + offset) - offset, int(text.size()));
+            const int xs = x + columnX(text, from);
+            const int xe = x + columnX(text, to) + ((line != end.line) ? m_charWidth : 0);
+            const QRect rect(xs, y, xe - xs, m_lineHeight);
+            painter.fillRect(rect, palette().brush(QPalette::Highlight));
+            painter.save();
+            painter.setClipRect(rect);
+            painter.setPen(palette().color(QPalette::HighlightedText));
+            painter.drawText(x, y + m_ascent, text);
+            painter.restore();
+        }
+    }
+}
+
+void Console::resizeEvent(QResizeEvent *e) {
+    QScrollBar *bar = verticalScrollBar();
+    const bool atBottom = (bar->value() >= bar->maximum());
+    QAbstractScrollArea::resizeEvent(e);
+    updateScrollBars();
+    if (atBottom) bar->setValue(bar->maximum());
+}
+
+void Console::changeEvent(QEvent *e) {
+    QAbstractScrollArea::changeEvent(e);
+    switch (e->type()) {
+    case QEvent::FontChange:
+        updateMetrics();
+        updateScrollBars();
+        viewport()->update();
+        break;
+    case QEvent::PaletteChange:
+        viewport()->update();
+        break;
+    default:
+        break;
     }
 }
+
+void Console::mousePressEvent(QMouseEvent *e) {
+    if (e->button() != Qt::LeftButton) return;
+    const bool hadSelection = hasSelection();
+    m_anchor = m_cursor = positionAt(e->position().toPoint());
+    m_selecting = true;
+    viewport()->update();
+    if (hadSelection) emit copyAvailable(false);
+}
+
+void Console::mouseMoveEvent(QMouseEvent *e) {
+    if (!m_selecting) return;
+    const QPoint point = e->position().toPoint();
+    if (point.y() < 0) verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    if (point.y() > viewport()->height()) verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+    setSelection(m_anchor, positionAt(point));
+}
+
+void Console::mouseReleaseEvent(QMouseEvent *e) {
+    if (e->button() == Qt::LeftButton) m_selecting = false;
+}
+
+void Console::mouseDoubleClickEvent(QMouseEvent *e) {
+    if (e->button() != Qt::LeftButton) return;
+    const Position position = positionAt(e->position().toPoint());
+    const QString text = lineText(position.line);
+    int from = qMin(position.column, int(text.size()));
+    int to = from;
+    while ((from > 0) && text.at(from - 1).isLetterOrNumber()) from--;
+    while ((to < text.size()) && text.at(to).isLetterOrNumber()) to++;
+    setSelection({position.line, from}, {position.line, to});
+}
+
+qsizetype Console::lineCount() const {
+    return m_log.isOpen() ? m_log.lineCount() : m_buffer.lineCount();
+}
+
+qint64 Console::droppedLines() const {
+    return m_log.isOpen() ? 0 : m_buffer.droppedLines();
+}
+
+qsizetype Console::maxLineLength() const {
+    return m_log.isOpen() ? m_log.maxLineLength() : m_buffer.maxLineLength();
+}
+
+qsizetype Console::lineLength(qsizetype idx) const {
+    return m_log.isOpen() ? m_log.lineLength(idx) : m_buffer.lineLength(idx);
+}
+
+QByteArray Console::lineBytes(qsizetype idx, qsizetype from, qsizetype length) const {
+    return m_log.isOpen() ? m_log.line(idx, from, length) : m_buffer.line(idx, from, length);
+}
+
+QString Console::lineText(qint64 line) const {
+    return QString::fromLocal8Bit(lineBytes(bufferLine(line)));
+}
+
+qsizetype Console::bufferLine(qint64 line) const {
+    return line - droppedLines();
+}
+
+Console::Position Console::positionAt(const QPoint &point) const {
+    const qsizetype count = lineCount();
+    const qsizetype idx = qBound<qsizetype>(0, verticalScrollBar()->value() + point.y() / m_lineHeight, qMax<qsizetype>(count - 1, 0));
+    const qint64 line = droppedLines() + idx;
+    const int x = point.x() - CONSOLE_MARGIN + horizontalScrollBar()->value();
+    const qsizetype length = lineLength(idx);
+    if (length > CONSOLE_LONG_LINE) {
+        return {line, int(qBound<qsizetype>(0, (x + m_charWidth / 2) / m_charWidth, length))};
+    }
+    return {line, columnAt(lineText(line), x)};
+}
+
+int Console::columnX(const QString &text, int column) const {
+    if (text.size() > CONSOLE_LONG_LINE) return column * m_charWidth;
+    return fontMetrics().horizontalAdvance(text.left(column));
+}
+
+int Console::columnAt(const QString &text, int x) const {
+    if (x <= 0) return 0;
+    if (text.size() > CONSOLE_LONG_LINE) return qBound(0, (x + m_charWidth / 2) / m_charWidth, int(text.size()));
+    const QFontMetrics fm = fontMetrics();
+    int left = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        const int width = fm.horizontalAdvance(text.at(i));
+        if (x < left + width / 2) return i;
+        left += width;
+    }
+    return text.size();
+}
+
+bool Console::hasSelection() const {
+    return (m_anchor.line != m_cursor.line) || (m_anchor.column != m_cursor.column);
+}
+
+void Console::setSelection(const Position &start, const Position &end) {
+    const bool hadSelection = hasSelection();
+    m_anchor = start;
+    m_cursor = end;
+    viewport()->update();
+    if (hadSelection != hasSelection()) emit copyAvailable(hasSelection());
+}
+
+void Console::ensureVisible(const Position &position) {
+    QScrollBar *bar = verticalScrollBar();
+    const qsizetype idx = bufferLine(position.line);
+    if (idx < bar->value()) {
+        bar->setValue(idx);
+    } else if (idx >= bar->value() + visibleLines()) {
+        bar->setValue(idx - visibleLines() + 1);
+    }
+
+    QScrollBar *hbar = horizontalScrollBar();
+    const int x = columnX(lineText(position.line), position.column);
+    if (x < hbar->value()) {
+        hbar->setValue(x);
+    } else if (x > hbar->value() + viewport()->width() - 2 * CONSOLE_MARGIN) {
+        hbar->setValue(x - viewport()->width() + 2 * CONSOLE_MARGIN);
+    }
+}
+
+void Console::updateMetrics() {
+    const QFontMetrics fm(font());
+    m_lineHeight = qMax(1, fm.lineSpacing());
+    m_ascent = fm.ascent();
+    m_charWidth = qMax(1, fm.horizontalAdvance(QLatin1Char('0')));
+}
+
+void Console::updateScrollBars() {
+    const int visible = visibleLines();
+    verticalScrollBar()->setPageStep(visible);
+    verticalScrollBar()->setRange(0, int(qBound<qsizetype>(0, lineCount() - visible, INT_MAX)));
+
+    const int width = viewport()->width();
+    const qint64 contentWidth = qint64(maxLineLength()) * m_charWidth + 2 * CONSOLE_MARGIN;
+    horizontalScrollBar()->setSingleStep(m_charWidth);
+    horizontalScrollBar()->setPageStep(width);
+    horizontalScrollBar()->setRange(0, int(qBound<qint64>(0, contentWidth - width, INT_MAX)));
+}
+
+int Console::visibleLines() const {
+    return qMax(1, viewport()->height() / m_lineHeight);
+}
@@ -1,23 +1,117 @@
 #ifndef CONSOLE_H
 #define CONSOLE_H
 
-#include <QPlainTextEdit>
+#include <QAbstractScrollArea>
+#include "linebuffer.h"
+#include "logfile.h"
+#include "searcher.h"
 
-class Console : public QPlainTextEdit
+class QThread;
+
+// Консоль на кольцевом буфере: отрисовываются только видимые строки,
+// объём истории ограничен размером буфера.
+// Открытый файл показывается вместо буфера по отображению, без загрузки в память
+class Console : public QAbstractScrollArea
 {
     Q_OBJECT
 
 signals:
     void getData(const QByteArray &data);
+    void textChanged();
+    void copyAvailable(bool yes);
+    void matchesChanged(qsizetype count, bool done); // поиск: найдено вхождений, просмотр завершён
+    void logIndexed(qint64 indexed, qint64 size, bool done); // файл: проиндексировано байт
 
 public:
     explicit Console(QWidget *parent = nullptr);
+    ~Console();
 
     void putData(const QByteArray &data);
 
+    bool isEmpty() const;
+    qsizetype scrollback() const;
+    void setScrollback(qsizetype bytes);
+
+    QString toPlainText() const;
+    void setPlainText(const QString &text);
+
+    // Просмотр файла: буфер очищается, новые данные возвращают консоль к буферу
+    bool openLog(const QString &fileName);
+    void closeLog();
+    QString logFileName() const;                    // пусто - файл не открыт
+    QString logErrorString() const;
+
+    // Фоновый поиск всех вхождений; новые данные просматриваются по мере поступления
+    void startSearch(const QRegularExpression &re);
+    void stopSearch();
+    bool findMatch(bool backward);                  // ближайшее вхождение от выделения
+    void setHighlightAll(bool enabled);
+    qsizetype matchCount() const;
+
+public slots:
+    void clear();
+    void copy();
+    void selectAll();
+
 protected:
     void keyPressEvent(QKeyEvent *e) override;
+    void paintEvent(QPaintEvent *e) override;
+    void resizeEvent(QResizeEvent *e) override;
+    void changeEvent(QEvent *e) override;
+    void mousePressEvent(QMouseEvent *e) override;
+    void mouseMoveEvent(QMouseEvent *e) override;
+    void mouseReleaseEvent(QMouseEvent *e) override;
+    void mouseDoubleClickEvent(QMouseEvent *e) override;
+
+private:
+    typedef struct {
+        qint64 line;                                // абсолютный номер строки
+        int column;
+    } Position;
+
+    // строки файла, если он открыт, иначе буфера
+    qsizetype lineCount() const;
+    qint64 droppedLines() const;
+    qsizetype maxLineLength() const;
+    qsizetype lineLength(qsizetype idx) const;
+    QByteArray lineBytes(qsizetype idx, qsizetype from = 0, qsizetype length = -1) const;
+
+    void logIndexChanged();
+    QString lineText(qint64 line) const;
+    qsizetype bufferLine(qint64 line) const;
+    Position positionAt(const QPoint &point) const;
+    int columnX(const QString &text, int column) const;
+    int columnAt(const QString &text, int x) const;
+    bool hasSelection() const;
+    void setSelection(const Position &start, const Position &end);
+    void ensureVisible(const Position &position);
+    void updateMetrics();
+    void updateScrollBars();
+    int visibleLines() const;
+
+    void searchReadyRead();
+    void restartSearch();
+    Searcher::Matches::const_iterator firstMatch(qint64 line) const;
+
+    QThread *m_searchThread = nullptr;              // создаётся при первом поиске
+    Searcher *m_searcher = nullptr;
+    QRegularExpression m_searchRe;
+    Searcher::Matches m_matches;                    // по возрастанию позиции
+    int m_searchGeneration = 0;                     // 0 - поиск не ведётся
+    bool m_searchMirror = false;                    // копия в поиске повторяет m_buffer
+    qint64 m_searchScanned = 0;
+    bool m_searchDone = false;
+    int m_pendingFind = 0;                          // 1/-1 - переход вперёд/назад ждёт результатов
+    bool m_highlightAll = false;
 
+    LineBuffer m_buffer;
+    LogFile m_log;
+    Position m_anchor = {0, 0};                     // начало выделения
+    Position m_cursor = {0, 0};                     // конец выделения
+    bool m_selecting = false;
+    int m_lineHeight = 1;
+    int m_ascent = 0;
+    int m_charWidth = 1;
 };
 
 #endif // CONSOLE_H
@@ -0,0 +1,54 @@
+#include "converter.h"
+#include "hexformatter.h"
+
+#include <QDateTime>
+
+void Converter::setSettings(const Connection::Settings &settings) {
+    m_timeStamp = settings.timeStamp;
+    m_timeDelta = settings.timeDelta;
+    m_gapThreshold = settings.gapThreshold;
+    m_hexLog = settings.hexLog;
+    m_hexAll = settings.hexAll;
+    m_linefeed = settings.linefeed;
+    m_linefeedChar = settings.linefeedChar;
+    m_framed = settings.framing != Connection::FrameNone;
+}
+
+void Converter::reset() {
+    m_lastTime = -1;
+    m_lineStart = false;
+}
+
+QByteArray Converter::convert(const QByteArray &data, qint64 time, Crc::Check check) {
+    QByteArray res;
+    const qint64 delta = (m_lastTime >= 0) ? time - m_lastTime : -1;
+    m_lastTime = time;
+    // новая строка: на каждый кадр, на каждый блок при метке времени или по паузе больше порога
+    const bool frame = m_framed || ((m_gapThreshold > 0) ?
+                (delta < 0 || delta >= m_gapThreshold * 1000000LL) : m_timeStamp);
+    if (frame) {
+        if (!m_framed || !m_lineStart) res.append('\n'); // кадр с разделителем '\n' уже закончил строку
+        if (m_timeStamp) {
+            QString stamp = QDateTime::fromMSecsSinceEpoch(time / 1000000).toString("[hh:mm:ss.zzz");
+            stamp.append(QString::number((time / 1000) % 1000).rightJustified(3, '0'));
+            if (m_timeDelta && delta >= 0) {
+                stamp.append(QString(" +%1 ms").arg(QString::number(delta / 1000000.0, 'f', 3)));
+            }
+            res.append(stamp.append("] - ").toLocal8Bit());
+        }
+    }
+    if (m_hexLog) {
+        const HexFormatter::Options options = {m_hexAll, m_linefeed, m_linefeedChar};
+        HexFormatter::append(res, data.constData(), data.size(), options);
+    } else {
+        res.append(data);
+    }
+    if (check != Crc::CheckNone) {
+        // перед переводом строки, которым заканчивается кадр
+        qsizetype pos = res.size();
+        while (pos > 0 && (res.at(pos - 1) == '\n' || res.at(pos - 1) == '\r')) --pos;
+        res.insert(pos, (check == Crc::CheckOk) ? " <CRC OK>" : " <CRC ERROR>");
+    }
+    m_lineStart = res.endsWith('\n');
+    return res;
+}
@@ -0,0 +1,32 @@
+#ifndef CONVERTER_H
+#define CONVERTER_H
+
+#include <QByteArray>
+#include "connection.h"
+#include "crc.h"
+
+// Преобразование принятых/отправленных блоков для вывода:
+// метки времени, разбиение на строки по паузам или кадрам, шестнадцатеричный вид, отметки CRC.
+class Converter
+{
+public:
+    void setSettings(const Connection::Settings &settings);
+    void reset();                                   // следующий блок - без интервала от предыдущего
+
+    // time - нс с 1970-01-01 UTC; check - отметка в конце строки кадра
+    QByteArray convert(const QByteArray &data, qint64 time, Crc::Check check = Crc::CheckNone);
+
+private:
+    bool m_timeStamp = false;
+    bool m_timeDelta = false;
+    int m_gapThreshold = 0;                         // мс
+    bool m_hexLog = false;
+    bool m_hexAll = false;
+    bool m_linefeed = false;
+    char m_linefeedChar = 0;
+    bool m_framed = false;                          // блоки - кадры, каждый с новой строки
+    qint64 m_lastTime = -1;                         // метка предыдущего блока
+    bool m_lineStart = false;                       // вывод предыдущего блока закончился переводом строки
+};
+
+#endif // CONVERTER_H
@@ -1,168 +1,652 @@
 #include "crc.h"
-#include <QDataStream>
-#include <QIODevice>
-
-#define IDX_NONE                        0
-#define IDX_CRC8_BIN                    1
-#define IDX_CRC8_HEX                    2
-#define IDX_CRC8_HEX_CR                 3
-#define IDX_CRC16_BIN_LITTLE_ENDIAN     4
-#define IDX_CRC16_BIN_BIG_ENDIAN        5
-#define IDX_CRC16_HEX_LITTLE_ENDIAN     6
-#define IDX_CRC16_HEX_LITTLE_ENDIAN_CR  7
-#define IDX_CRC16_HEX_BIG_ENDIAN        8
-#define IDX_CRC16_HEX_BIG_ENDIAN_CR     9
-#define IDX_CRC32_BIN_LITTLE_ENDIAN     10
-#define IDX_CRC32_BIN_BIG_ENDIAN        11
-#define IDX_CRC32_HEX_LITTLE_ENDIAN     12
-#define IDX_CRC32_HEX_LITTLE_ENDIAN_CR  13
-#define IDX_CRC32_HEX_BIG_ENDIAN        14
-#define IDX_CRC32_HEX_BIG_ENDIAN_CR     15
-#define IDX_SUM_MOD256_BIN              16
-#define IDX_SUM_MOD256_HEX              17
-#define IDX_SUM_MOD256_HEX_CR           18
+#include <QMutex>
+#include <QHash>
+#include <cstring>
 
 #define CR  0x0D
 
-const QStringList crcList = QStringList() << "Нет"
-                                          << "CRC8-BIN"
-                                          << "CRC8-HEX"
-                                          << "CRC8-HEX-CR"
-                                          << "CRC16-BIN-LE"
-                                          << "CRC16-BIN-BE"
-                                          << "CRC16-HEX-LE"
-                                          << "CRC16-HEX-LE-CR"
-                                          << "CRC16-HEX-BE"
-                                          << "CRC16-HEX-BE-CR"
-                                          << "CRC32-BIN-LE"
-                                          << "CRC32-BIN-BE"
-                                          << "CRC32-HEX-LE"
-                                          << "CRC32-HEX-LE-CR"
-                                          << "CRC32-HEX-BE"
-                                          << "CRC32-HEX-BE-CR"
-                                          << "SUM8-BIN"
-                                          << "SUM8-HEX"
-                                          << "SUM8-HEX-CR"
-    ;
-
-// ru.wikibooks.org/wiki/Реализации_алгоритмов/Циклический_избыточный_код
-
-/*
-  Name  : CRC-8
-  Poly  : 0x31    x^8 + x^5 + x^4 + 1
-  Init  : 0xFF
-  Revert: false
-  XorOut: 0x00
-  Check : 0xF7 ("123456789")
-  MaxLen: 15 байт(127 бит) - обнаружение
-    одинарных, двойных, тройных и всех нечетных ошибок
-*/
-unsigned char crc8(unsigned char *pcBlock, unsigned int len) {
-    unsigned char crc = 0xFF;
-    unsigned int i;
-    while (len--)     {
-        crc ^= *pcBlock++;
-        for (i = 0; i < 8; i++) crc = crc & 0x80 ? (crc << 1) ^ 0x31 : crc << 1;
+// Таблицы для побайтового (slice-by-8) расчёта, вычисляются при компиляции
+
+template <typename T>
+struct CrcTables {
+    T t[8][256];
+};
+
+// Прямой порядок бит (MSB-first)
+template <typename T, int Width>
+constexpr CrcTables<T> makeTables(T poly) {
+    CrcTables<T> r{};
+    const T mask = T(~T(0) >> (sizeof(T) * 8 - Width));
+    const T top = T(T(1) << (Width - 1));
+    for (int i = 0; i < 256; ++i) {
+        T crc = T(T(i) << (Width - 8));
+        for (int j = 0; j < 8; ++j) crc = T(((crc & top) ? T(crc << 1) ^ poly : T(crc << 1)) & mask);
+        r.t[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            const T prev = r.t[k - 1][i];
+            r.t[k][i] = T(((Width > 8 ? T(prev << 8) : T(0)) ^ r.t[0][(prev >> (Width - 8)) & 0xFF]) & mask);
+        }
+    }
+    return r;
+}
+
+// Обратный порядок бит (LSB-first)
+template <typename T>
+constexpr CrcTables<T> makeTablesReflected(T poly) {
+    CrcTables<T> r{};
+    for (int i = 0; i < 256; ++i) {
+        T crc = T(i);
+        for (int j = 0; j < 8; ++j) crc = (crc & 1) ? T(crc >> 1) ^ poly : T(crc >> 1);
+        r.t[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            const T prev = r.t[k - 1][i];
+            r.t[k][i] = T(prev >> 8) ^ r.t[0][prev & 0xFF];
+        }
+    }
+    return r;
+}
+
+static constexpr CrcTables<quint8> crc8Tables = makeTables<quint8, 8>(0x31);
+static constexpr CrcTables<quint16> crc16Tables = makeTables<quint16, 16>(0x1021);
+static constexpr CrcTables<quint32> crc32Tables = makeTablesReflected<quint32>(0xEDB88320UL);
+
+static quint8 crc8Update(quint8 crc, const uchar *p, qint64 len) {
+    const auto &t = crc8Tables.t;
+    while (len >= 8) {
+        crc = t[7][crc ^ p[0]] ^ t[6][p[1]] ^ t[5][p[2]] ^ t[4][p[3]] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = t[0][crc ^ *p++];
+    return crc;
+}
+
+static quint16 crc16Update(quint16 crc, const uchar *p, qint64 len) {
+    const auto &t = crc16Tables.t;
+    while (len >= 8) {
+        crc = t[7][(crc >> 8) ^ p[0]] ^ t[6][(crc & 0xFF) ^ p[1]] ^ t[5][p[2]] ^ t[4][p[3]] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = quint16(crc << 8) ^ t[0][(crc >> 8) ^ *p++];
+    return crc;
+}
+
+static quint32 crc32Table(quint32 crc, const uchar *p, qint64 len) {
+    const auto &t = crc32Tables.t;
+    while (len >= 8) {
+        const quint32 a = crc ^ (quint32(p[0]) | quint32(p[1]) << 8 | quint32(p[2]) << 16 | quint32(p[3]) << 24);
+        crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CRC_X86_CLMUL
+#include <immintrin.h>
+
+// Свёртка с помощью PCLMULQDQ (Intel, "Fast CRC Computation Using PCLMULQDQ Instruction").
+// len >= 64, кратно 16
+__attribute__((target("sse4.1,pclmul")))
+static quint32 crc32Clmul(quint32 crc, const uchar *p, qint64 len) {
+    alignas(16) static const quint64 k1k2[] = {0x0154442bd4ULL, 0x01c6e41596ULL};
+    alignas(16) static const quint64 k3k4[] = {0x01751997d0ULL, 0x00ccaa009eULL};
+    alignas(16) static const quint64 k5k0[] = {0x0163cd6124ULL, 0x0000000000ULL};
+    alignas(16) static const quint64 poly[] = {0x01db710641ULL, 0x01f7011641ULL};
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(int(crc)));
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+    p += 64;
+    len -= 64;
+
+    // параллельная свёртка блоков по 64 байта
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30)));
+        p += 64;
+        len -= 64;
+    }
+
+    // свёртка до 128 бит
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // оставшиеся блоки по 16 байт
+    while (len >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        p += 16;
+        len -= 16;
+    }
+
+    // 128 -> 64 бит
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // редукция Барретта до 32 бит
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return quint32(_mm_extract_epi32(x1, 1));
+}
+
+static bool hasClmul() {
+    static const bool supported = __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("pclmul");
+    return supported;
+}
+
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define CRC_ARM_CRC32
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+// Инструкции CRC32 ARMv8 (полином 0x04C11DB7)
+__attribute__((target("+crc")))
+static quint32 crc32Arm(quint32 crc, const uchar *p, qint64 len) {
+    while (len > 0 && (reinterpret_cast<quintptr>(p) & 7)) {
+        crc = __crc32b(crc, *p++);
+        len--;
     }
+    while (len >= 8) {
+        quint64 v;
+        memcpy(&v, p, sizeof(v));
+        crc = __crc32d(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = __crc32b(crc, *p++);
     return crc;
 }
 
-/*
-  Name  : CRC-16 CCITT
-  Poly  : 0x1021    x^16 + x^12 + x^5 + 1
-  Init  : 0xFFFF
-  Revert: false
-  XorOut: 0x0000
-  Check : 0x29B1 ("123456789")
-  MaxLen: 4095 байт (32767 бит) - обнаружение
-    одинарных, двойных, тройных и всех нечетных ошибок
-*/
-unsigned short crc16(unsigned char *pcBlock, unsigned short len) {
-    unsigned short crc = 0xFFFF;
-    unsigned char i;
-    while (len--)     {
-        crc ^= *pcBlock++ << 8;
-        for (i = 0; i < 8; i++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+static bool hasArmCrc() {
+#if defined(__ARM_FEATURE_CRC32) || defined(__APPLE__)
+    return true;
+#elif defined(__linux__)
+    static const bool supported = getauxval(AT_HWCAP) & HWCAP_CRC32;
+    return supported;
+#else
+    return false;
+#endif
+}
+#endif
+
+static quint32 crc32Update(quint32 crc, const uchar *p, qint64 len) {
+#if defined(CRC_X86_CLMUL)
+    if (len >= 64 && hasClmul()) {
+        const qint64 chunk = len & ~qint64(15);
+        crc = crc32Clmul(crc, p, chunk);
+        p += chunk;
+        len -= chunk;
     }
+#elif defined(CRC_ARM_CRC32)
+    if (hasArmCrc()) return crc32Arm(crc, p, len);
+#endif
+    return crc32Table(crc, p, len);
+}
+
+#if defined(CRC_X86_CLMUL)
+// Инструкция CRC32 SSE4.2 (полином Castagnoli 0x1EDC6F41)
+__attribute__((target("sse4.2")))
+static quint32 crc32cHw(quint32 crc, const uchar *p, qint64 len) {
+#if defined(__x86_64__)
+    quint64 crc64 = crc;
+    while (len >= 8) {
+        quint64 v;
+        memcpy(&v, p, sizeof(v));
+        crc64 = _mm_crc32_u64(crc64, v);
+        p += 8;
+        len -= 8;
+    }
+    crc = quint32(crc64);
+#endif
+    while (len-- > 0) crc = _mm_crc32_u8(crc, *p++);
     return crc;
 }
 
-/*
-  Name  : CRC-32
-  Poly  : 0x04C11DB7    x^32 + x^26 + x^23 + x^22 + x^16 + x^12 + x^11
-                       + x^10 + x^8 + x^7 + x^5 + x^4 + x^2 + x + 1
-  Init  : 0xFFFFFFFF
-  Revert: true
-  XorOut: 0xFFFFFFFF
-  Check : 0xCBF43926 ("123456789")
-  MaxLen: 268 435 455 байт (2 147 483 647 бит) - обнаружение
-   одинарных, двойных, пакетных и всех нечетных ошибок
-*/
-uint_least32_t crc32(unsigned char *buf, size_t len) {
-    uint_least32_t crc_table[256];
-    uint_least32_t crc; int i, j;
-    for (i = 0; i < 256; i++)     {
-        crc = i;
-        for (j = 0; j < 8; j++) crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
-        crc_table[i] = crc;
-    };
-    crc = 0xFFFFFFFFUL;
-    while (len--) crc = crc_table[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
-    return crc ^ 0xFFFFFFFFUL;
-}
-
-QByteArray ba8(const QByteArray &data) {
-    return QByteArray(1, (crc8((unsigned char*)data.data(), data.size())));
-}
-
-QByteArray ba16(const QByteArray &data, QDataStream::ByteOrder ba) {
-    QByteArray crc;
-    QDataStream ds(&crc, QIODevice::WriteOnly);
-    ds.setByteOrder(ba);
-    ds << crc16((unsigned char*)data.data(), data.size());
+static bool hasCrc32c() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+
+#elif defined(CRC_ARM_CRC32)
+// Инструкции CRC32C ARMv8 (полином Castagnoli 0x1EDC6F41)
+__attribute__((target("+crc")))
+static quint32 crc32cHw(quint32 crc, const uchar *p, qint64 len) {
+    while (len >= 8) {
+        quint64 v;
+        memcpy(&v, p, sizeof(v));
+        crc = __crc32cd(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = __crc32cb(crc, *p++);
     return crc;
 }
 
-QByteArray ba32(const QByteArray &data, QDataStream::ByteOrder ba) {
-    QByteArray crc;
-    QDataStream ds(&crc, QIODevice::WriteOnly);
-    ds.setByteOrder(ba);
-    ds << crc32((unsigned char*)data.data(), data.size());
+static bool hasCrc32c() {
+    return hasArmCrc();
+}
+#endif
+
+// Таблицы для произвольной модели, строятся один раз на набор (width, poly, refin)
+
+typedef struct {
+    quint64 t[8][256];
+} CrcTable;
+
+typedef quint64 (*CrcKernel)(const CrcTable *table, int width, quint64 crc, const uchar *p, qint64 len);
+
+static quint64 reflect(quint64 value, int width) {
+    quint64 result = 0;
+    for (int i = 0; i < width; ++i) {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+    return result;
+}
+
+static quint64 widthMask(int width) {
+    return (width >= 64) ? ~quint64(0) : ((quint64(1) << width) - 1);
+}
+
+static const CrcTable *makeTable(int width, quint64 poly, bool refin) {
+    CrcTable *r = new CrcTable;
+    if (refin) {
+        const quint64 rpoly = reflect(poly, width);
+        for (int i = 0; i < 256; ++i) {
+            quint64 crc = quint64(i);
+            for (int j = 0; j < 8; ++j) crc = (crc & 1) ? (crc >> 1) ^ rpoly : crc >> 1;
+            r->t[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) r->t[k][i] = (r->t[k - 1][i] >> 8) ^ r->t[0][r->t[k - 1][i] & 0xFF];
+        }
+    } else {
+        // регистр выровнен по старшему биту
+        const quint64 lpoly = poly << (64 - width);
+        for (int i = 0; i < 256; ++i) {
+            quint64 crc = quint64(i) << 56;
+            for (int j = 0; j < 8; ++j) crc = (crc >> 63) ? (crc << 1) ^ lpoly : crc << 1;
+            r->t[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) r->t[k][i] = (r->t[k - 1][i] << 8) ^ r->t[0][r->t[k - 1][i] >> 56];
+        }
+    }
+    return r;
+}
+
+static const CrcTable *cachedTable(int width, quint64 poly, bool refin) {
+    static QMutex mutex;
+    static QHash<QByteArray, const CrcTable *> cache;
+    QByteArray key;
+    key.append(char(width)).append(char(refin)).append(reinterpret_cast<const char *>(&poly), sizeof(poly));
+    QMutexLocker locker(&mutex);
+    const CrcTable *table = cache.value(key);
+    if (!table) {
+        table = makeTable(width, poly, refin);
+        cache.insert(key, table);
+    }
+    return table;
+}
+
+static quint64 kernelReflected(const CrcTable *table, int width, quint64 crc, const uchar *p, qint64 len) {
+    Q_UNUSED(width)
+    const auto &t = table->t;
+    while (len >= 8) {
+        quint64 a = 0;
+        for (int i = 7; i >= 0; --i) a = (a << 8) | p[i];
+        a ^= crc;
+        crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][(a >> 24) & 0xFF] ^
+              t[3][(a >> 32) & 0xFF] ^ t[2][(a >> 40) & 0xFF] ^ t[1][(a >> 48) & 0xFF] ^ t[0][a >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
     return crc;
 }
 
-uint sum(const QByteArray &data) {
+static quint64 kernelNormal(const CrcTable *table, int width, quint64 crc, const uchar *p, qint64 len) {
+    const auto &t = table->t;
+    crc <<= (64 - width);
+    while (len >= 8) {
+        quint64 a = 0;
+        for (int i = 0; i < 8; ++i) a = (a << 8) | p[i];
+        a ^= crc;
+        crc = t[7][a >> 56] ^ t[6][(a >> 48) & 0xFF] ^ t[5][(a >> 40) & 0xFF] ^ t[4][(a >> 32) & 0xFF] ^
+              t[3][(a >> 24) & 0xFF] ^ t[2][(a >> 16) & 0xFF] ^ t[1][(a >> 8) & 0xFF] ^ t[0][a & 0xFF];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = (crc << 8) ^ t[0][(crc >> 56) ^ *p++];
+    return crc >> (64 - width);
+}
+
+static quint64 kernelCrc8(const CrcTable *, int, quint64 crc, const uchar *p, qint64 len) {
+    return crc8Update(quint8(crc), p, len);
+}
+
+static quint64 kernelCrc16(const CrcTable *, int, quint64 crc, const uchar *p, qint64 len) {
+    return crc16Update(quint16(crc), p, len);
+}
+
+static quint64 kernelCrc32(const CrcTable *, int, quint64 crc, const uchar *p, qint64 len) {
+    return crc32Update(quint32(crc), p, len);
+}
+
+#if defined(CRC_X86_CLMUL) || defined(CRC_ARM_CRC32)
+static quint64 kernelCrc32c(const CrcTable *table, int width, quint64 crc, const uchar *p, qint64 len) {
+    if (hasCrc32c()) return crc32cHw(quint32(crc), p, len);
+    return kernelReflected(table, width, crc, p, len);
+}
+#endif
+
+// Выбор реализации: для распространённых полиномов - специализированные
+static CrcKernel selectKernel(const Crc::Model &model) {
+    if (!model.refin && model.width == 8 && model.poly == 0x31) return kernelCrc8;
+    if (!model.refin && model.width == 16 && model.poly == 0x1021) return kernelCrc16;
+    if (model.refin && model.width == 32 && model.poly == 0x04C11DB7) return kernelCrc32;
+#if defined(CRC_X86_CLMUL) || defined(CRC_ARM_CRC32)
+    if (model.refin && model.width == 32 && model.poly == 0x1EDC6F41) return kernelCrc32c;
+#endif
+    return model.refin ? kernelReflected : kernelNormal;
+}
+
+// Каталог: reveng.sourceforge.io/crc-catalogue
+// Первые три модели - исходные CRC8, CRC16 и CRC32 (ru.wikibooks.org/wiki/Реализации_алгоритмов/Циклический_избыточный_код)
+static const QVector<Crc::Model> catalogue = {
+    //  name                  width  poly                   init                   refin  refout xorout                 check
+    {"CRC-8/NRSC-5",          8,     0x31,                  0xFF,                  false, false, 0x00,                  0xF7},
+    {"CRC-16/IBM-3740",       16,    0x1021,                0xFFFF,                false, false, 0x0000,                0x29B1},
+    {"CRC-32/ISO-HDLC",       32,    0x04C11DB7,            0xFFFFFFFF,            true,  true,  0xFFFFFFFF,            0xCBF43926},
+    {"CRC-8/SMBUS",           8,     0x07,                  0x00,                  false, false, 0x00,                  0xF4},
+    {"CRC-8/MAXIM-DOW",       8,     0x31,                  0x00,                  true,  true,  0x00,                  0xA1},
+    {"CRC-8/AUTOSAR",         8,     0x2F,                  0xFF,                  false, false, 0xFF,                  0xDF},
+    {"CRC-8/SAE-J1850",       8,     0x1D,                  0xFF,                  false, false, 0xFF,                  0x4B},
+    {"CRC-8/CDMA2000",        8,     0x9B,                  0xFF,                  false, false, 0x00,                  0xDA},
+    {"CRC-16/MODBUS",         16,    0x8005,                0xFFFF,                true,  true,  0x0000,                0x4B37},
+    {"CRC-16/XMODEM",         16,    0x1021,                0x0000,                false, false, 0x0000,                0x31C3},
+    {"CRC-16/KERMIT",         16,    0x1021,                0x0000,                true,  true,  0x0000,                0x2189},
+    {"CRC-16/ARC",            16,    0x8005,                0x0000,                true,  true,  0x0000,                0xBB3D},
+    {"CRC-16/USB",            16,    0x8005,                0xFFFF,                true,  true,  0xFFFF,                0xB4C8},
+    {"CRC-16/MAXIM-DOW",      16,    0x8005,                0x0000,                true,  true,  0xFFFF,                0x44C2},
+    {"CRC-16/IBM-SDLC",       16,    0x1021,                0xFFFF,                true,  true,  0xFFFF,                0x906E},
+    {"CRC-16/GENIBUS",        16,    0x1021,                0xFFFF,                false, false, 0xFFFF,                0xD64E},
+    {"CRC-16/DNP",            16,    0x3D65,                0x0000,                true,  true,  0xFFFF,                0xEA82},
+    {"CRC-32/ISCSI",          32,    0x1EDC6F41,            0xFFFFFFFF,            true,  true,  0xFFFFFFFF,            0xE3069283},
+    {"CRC-32/BZIP2",          32,    0x04C11DB7,            0xFFFFFFFF,            false, false, 0xFFFFFFFF,            0xFC891918},
+    {"CRC-32/MPEG-2",         32,    0x04C11DB7,            0xFFFFFFFF,            false, false, 0x00000000,            0x0376E6E7},
+    {"CRC-32/CKSUM",          32,    0x04C11DB7,            0x00000000,            false, false, 0xFFFFFFFF,            0x765E7680},
+    {"CRC-32/JAMCRC",         32,    0x04C11DB7,            0xFFFFFFFF,            true,  true,  0x00000000,            0x340BC6D9},
+    {"CRC-32/AUTOSAR",        32,    0xF4ACFB13,            0xFFFFFFFF,            true,  true,  0xFFFFFFFF,            0x1697D06A},
+    {"CRC-64/XZ",             64,    0x42F0E1EBA9EA3693ULL, 0xFFFFFFFFFFFFFFFFULL, true,  true,  0xFFFFFFFFFFFFFFFFULL, 0x995DC9BBDF1939FAULL},
+    {"CRC-64/ECMA-182",       64,    0x42F0E1EBA9EA3693ULL, 0x0000000000000000ULL, false, false, 0x0000000000000000ULL, 0x6C40DF5F0B497347ULL},
+};
+
+#define LEGACY_MODELS   3   ///< Модели с историческими названиями в списке
+
+// Модель с подготовленной таблицей и реализацией
+struct CrcPreset {
+    Crc::Model model;
+    const CrcTable *table;
+    CrcKernel kernel;
+};
+
+static CrcPreset makePreset(const Crc::Model &model) {
+    return {model, cachedTable(model.width, model.poly, model.refin), selectKernel(model)};
+}
+
+static const QVector<CrcPreset> &presets() {
+    static const QVector<CrcPreset> result = []() {
+        QVector<CrcPreset> r;
+        for (const Crc::Model &model : catalogue) r.append(makePreset(model));
+        return r;
+    }();
+    return result;
+}
+
+// Модели каталога - без поиска, прочие - из кэша
+static const CrcPreset *findPreset(const Crc::Model &model) {
+    if (&model >= catalogue.constData() && &model < catalogue.constData() + catalogue.size()) {
+        return &presets().at(&model - catalogue.constData());
+    }
+    static QMutex mutex;
+    static QHash<QByteArray, const CrcPreset *> cache;
+    QByteArray key;
+    key.append(char(model.width)).append(char(model.refin)).append(char(model.refout));
+    key.append(reinterpret_cast<const char *>(&model.poly), sizeof(model.poly));
+    key.append(reinterpret_cast<const char *>(&model.init), sizeof(model.init));
+    key.append(reinterpret_cast<const char *>(&model.xorout), sizeof(model.xorout));
+    QMutexLocker locker(&mutex);
+    const CrcPreset *preset = cache.value(key);
+    if (!preset) {
+        preset = new CrcPreset(makePreset(model));
+        cache.insert(key, preset);
+    }
+    return preset;
+}
+
+// Элементы списка: модель + формат добавления
+
+#define ENTRY_NONE  -2
+#define ENTRY_SUM8  -1
+
+typedef struct {
+    int model;                                      // индекс в каталоге, ENTRY_NONE, ENTRY_SUM8
+    bool hex;
+    bool bigEndian;
+    bool cr;
+    QString name;
+} Entry;
+
+static const QVector<Entry> &entries() {
+    static const QVector<Entry> result = []() {
+        QVector<Entry> r;
+        auto add = [&](int model, const QString &name, int width) {
+            if (width <= 8) {
+                r.append({model, false, false, false, name + "-BIN"});
+                r.append({model, true, false, false, name + "-HEX"});
+                r.append({model, true, false, true, name + "-HEX-CR"});
+            } else {
+                r.append({model, false, false, false, name + "-BIN-LE"});
+                r.append({model, false, true, false, name + "-BIN-BE"});
+                r.append({model, true, false, false, name + "-HEX-LE"});
+                r.append({model, true, false, true, name + "-HEX-LE-CR"});
+                r.append({model, true, true, false, name + "-HEX-BE"});
+                r.append({model, true, true, true, name + "-HEX-BE-CR"});
+            }
+        };
+        // исходный список - индексы сохранены в настройках
+        r.append({ENTRY_NONE, false, false, false, QString::fromUtf8("Нет")});
+        add(0, "CRC8", 8);
+        add(1, "CRC16", 16);
+        add(2, "CRC32", 32);
+        add(ENTRY_SUM8, "SUM8", 8);
+        // каталог
+        for (int i = LEGACY_MODELS; i < catalogue.size(); ++i) add(i, catalogue.at(i).name, catalogue.at(i).width);
+        return r;
+    }();
+    return result;
+}
+
+static quint8 sum8(const char *data, qint64 size) {
     uint sum = 0;
-    for (int i = 0; i < data.size(); i++) sum += static_cast<uint>(data.at(i));
-    return sum;
+    for (qint64 i = 0; i < size; i++) sum += static_cast<uint>(data[i]);
+    return static_cast<quint8>(sum % 0x0100);
+}
+
+#define ENTRY_MAX_SIZE  (8 * 2 + 1)                 ///< CRC-64 в HEX с CR
+
+static int checksumBytes(const Entry &entry) {
+    switch (entry.model) {
+    case ENTRY_NONE: return 0;
+    case ENTRY_SUM8: return 1;
+    default: return (catalogue.at(entry.model).width + 7) / 8;
+    }
+}
+
+// Длина суммы в формате элемента
+static int entrySize(const Entry &entry) {
+    return checksumBytes(entry) * (entry.hex ? 2 : 1) + (entry.cr ? 1 : 0);
+}
+
+// Контрольная сумма data в формате элемента; результат в out, возвращает длину
+static int encode(const Entry &entry, const char *data, qint64 size, char *out) {
+    quint64 value;
+    switch (entry.model) {
+    case ENTRY_NONE: return 0;
+    case ENTRY_SUM8: value = sum8(data, size); break;
+    default: value = Crc::checksum(catalogue.at(entry.model), data, size);
+    }
+    const int bytes = checksumBytes(entry);
+
+    static const char digits[] = "0123456789ABCDEF";
+    int length = 0;
+    for (int i = 0; i < bytes; ++i) {
+        const uchar c = uchar(value >> (8 * (entry.bigEndian ? bytes - 1 - i : i)));
+        if (entry.hex) {
+            out[length++] = digits[c >> 4];
+            out[length++] = digits[c & 0x0F];
+        } else {
+            out[length++] = char(c);
+        }
+    }
+    if (entry.cr) out[length++] = CR;
+    return length;
 }
 
 Crc::Crc(QObject *parent): QObject{parent}{}
 
 QStringList Crc::list() {
-    return crcList;
+    QStringList result;
+    for (const Entry &entry : entries()) result << entry.name;
+    return result;
 }
 
-QByteArray Crc::addCrc(QByteArray &data, uint idx) {
-    switch (idx) {
-    case IDX_CRC8_BIN: return data.append(ba8(data));
-    case IDX_CRC8_HEX: return data.append(QString(ba8(data).toHex()).toUpper().toLatin1());
-    case IDX_CRC8_HEX_CR: return data.append(QString(ba8(data).toHex()).toUpper().toLatin1().append(CR));
-    case IDX_CRC16_BIN_LITTLE_ENDIAN: return data.append(ba16(data, QDataStream::LittleEndian));
-    case IDX_CRC16_BIN_BIG_ENDIAN: return data.append(ba16(data, QDataStream::BigEndian));
-    case IDX_CRC16_HEX_LITTLE_ENDIAN: return data.append(QString(ba16(data, QDataStream::LittleEndian).toHex()).toUpper().toLatin1());
-    case IDX_CRC16_HEX_LITTLE_ENDIAN_CR: return data.append(QString(ba16(data, QDataStream::LittleEndian).toHex()).toUpper().toLatin1().append(CR));
-    case IDX_CRC16_HEX_BIG_ENDIAN: return data.append(QString(ba16(data, QDataStream::BigEndian).toHex()).toUpper().toLatin1());
-    case IDX_CRC16_HEX_BIG_ENDIAN_CR: return data.append(QString(ba16(data, QDataStream::BigEndian).toHex()).toUpper().toLatin1().append(CR));
-    case IDX_CRC32_BIN_LITTLE_ENDIAN: return data.append(ba32(data, QDataStream::LittleEndian));
-    case IDX_CRC32_BIN_BIG_ENDIAN: return data.append(ba32(data, QDataStream::BigEndian));
-    case IDX_CRC32_HEX_LITTLE_ENDIAN: return data.append(QString(ba32(data, QDataStream::LittleEndian).toHex()).toUpper().toLatin1());
-    case IDX_CRC32_HEX_LITTLE_ENDIAN_CR: return data.append(QString(ba32(data, QDataStream::LittleEndian).toHex()).toUpper().toLatin1().append(CR));
-    case IDX_CRC32_HEX_BIG_ENDIAN: return data.append(QString(ba32(data, QDataStream::BigEndian).toHex()).toUpper().toLatin1());
-    case IDX_CRC32_HEX_BIG_ENDIAN_CR: return data.append(QString(ba32(data, QDataStream::BigEndian).toHex()).toUpper().toLatin1().append(CR));
-    case IDX_SUM_MOD256_BIN: return data.append(1, static_cast<quint8>(sum(data) % 0x0100));
-    case IDX_SUM_MOD256_HEX: return data.append(QString(QByteArray(1, static_cast<char>(sum(data) % 0x0100)).toHex()).toUpper().toLatin1());
-    case IDX_SUM_MOD256_HEX_CR: return data.append(QString(QByteArray(1, static_cast<char>(sum(data) % 0x0100)).toHex()).toUpper().toLatin1().append(CR));
-    default: return data;
+const QVector<Crc::Model> &Crc::models() {
+    return catalogue;
+}
+
+const Crc::Model *Crc::model(const QString &name) {
+    for (const Model &model : catalogue) {
+        if (name.compare(QLatin1String(model.name), Qt::CaseInsensitive) == 0) return &model;
     }
+    return nullptr;
+}
+
+quint64 Crc::checksum(const Model &model, const char *data, qint64 size) {
+    Stream stream(model);
+    stream.update(data, size);
+    return stream.finalize();
+}
+
+Crc::Stream::Stream(const Model &model): m_preset(findPreset(model)) {
+    init();
+}
+
+void Crc::Stream::init() {
+    const Model &m = m_preset->model;
+    m_crc = m.refin ? reflect(m.init, m.width) : m.init;
+    m_length = 0;
+}
+
+void Crc::Stream::update(const char *data, qint64 size) {
+    if (size <= 0) return;
+    m_crc = m_preset->kernel(m_preset->table, m_preset->model.width, m_crc, reinterpret_cast<const uchar *>(data), size);
+    m_length += size;
+}
+
+void Crc::Stream::update(const QByteArray &data) {
+    update(data.constData(), data.size());
+}
+
+quint64 Crc::Stream::finalize() const {
+    const Model &m = m_preset->model;
+    quint64 crc = m_crc;
+    if (m.refin != m.refout) crc = reflect(crc, m.width);
+    return (crc ^ m.xorout) & widthMask(m.width);
+}
+
+qint64 Crc::Stream::length() const {
+    return m_length;
+}
+
+const Crc::Model &Crc::Stream::model() const {
+    return m_preset->model;
+}
+
+QByteArray Crc::crc(const QByteArray &data, uint idx) {
+    if (idx >= uint(entries().size())) return QByteArray();
+    char buffer[ENTRY_MAX_SIZE];
+    const int length = encode(entries().at(idx), data.constData(), data.size(), buffer);
+    return QByteArray(buffer, length);
+}
+
+Crc::Check Crc::verify(const char *data, qint64 size, uint idx) {
+    if (idx >= uint(entries().size()) || entries().at(idx).model == ENTRY_NONE) return CheckNone;
+    const Entry &entry = entries().at(idx);
+    const int length = entrySize(entry);
+    if (size < length) return CheckFailed;
+    char expected[ENTRY_MAX_SIZE];
+    encode(entry, data, size - length, expected);
+    const QByteArrayView received(data + size - length, length);
+    const Qt::CaseSensitivity cs = entry.hex ? Qt::CaseInsensitive : Qt::CaseSensitive;
+    return (received.compare(QByteArrayView(expected, length), cs) == 0) ? CheckOk : CheckFailed;
+}
+
+bool Crc::endsWithCr(uint idx) {
+    return idx < uint(entries().size()) && entries().at(idx).cr;
+}
+
+QByteArray Crc::addCrc(QByteArray &data, uint idx) {
+    return data.append(crc(data, idx));
 }
@@ -3,15 +3,65 @@
 
 #include <QObject>
 
+struct CrcPreset;
+
 class Crc : public QObject
 {
     Q_OBJECT
 public:
+    // Параметрическая модель CRC (Rocksoft)
+    typedef struct {
+        const char *name;
+        int width;                                  // 8..64 бит
+        quint64 poly;
+        quint64 init;
+        bool refin;
+        bool refout;
+        quint64 xorout;
+        quint64 check;                              // CRC строки "123456789"
+    } Model;
+
+    // Результат проверки принятого кадра
+    typedef enum {
+        CheckNone = 0,                              // не проверялся
+        CheckOk = 1,
+        CheckFailed = 2
+    } Check;
+
     explicit Crc(QObject *parent = nullptr);
 
     QStringList list();                             // список доступных
 
     QByteArray addCrc(QByteArray &data, uint idx);  // добавить crc
+    QByteArray crc(const QByteArray &data, uint idx);
+
+    // Контрольная сумма в конце кадра в формате элемента списка idx; CheckNone - элемент "Нет"
+    static Check verify(const char *data, qint64 size, uint idx);
+    static bool endsWithCr(uint idx);               // формат с CR после суммы
+
+    static const QVector<Model> &models();          // каталог моделей
+    static const Model *model(const QString &name); // поиск в каталоге по имени
+    static quint64 checksum(const Model &model, const char *data, qint64 size);
+
+    // Потоковый расчёт: init(), update() по частям, finalize()
+    class Stream
+    {
+    public:
+        explicit Stream(const Model &model);
+
+        void init();
+        void update(const char *data, qint64 size);
+        void update(const QByteArray &data);
+        quint64 finalize() const;                   // не меняет состояние
+
+        qint64 length() const;                      // обработано байт
+        const Model &model() const;
+
+    private:
+        const CrcPreset *m_preset;
+        quint64 m_crc;
+        qint64 m_length;
+    };
 
 };
 
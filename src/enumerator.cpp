@@ -0,0 +1,167 @@
+#include "enumerator.h"
+#include "timestamp.h"
+
+#include <QFile>
+#include <QTextStream>
+
+Enumerator::Enumerator(QObject *parent):
+    QObject(parent),
+    m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &Enumerator::expire);
+}
+
+void Enumerator::start(qint64 from, qint64 to, int window, qint64 timeout, const Builder &command, const Builder &response, bool framed) {
+    if (m_active) stop();
+    m_command = command;
+    m_response = response;
+    m_framed = framed;
+    m_from = from;
+    m_to = to;
+    m_next = from;
+    m_window = qMax(window, 1);
+    m_timeout = qMax<qint64>(timeout, 1);
+    m_timeouts = 0;
+    m_pending.clear();
+    m_buffer.clear();
+    m_hits.clear();
+    m_started = Timestamp::now();
+    m_active = true;
+    pump();
+}
+
+bool Enumerator::isActive() const {
+    return m_active;
+}
+
+qint64 Enumerator::sent() const {
+    return m_next - m_from;
+}
+
+qint64 Enumerator::timeouts() const {
+    return m_timeouts;
+}
+
+qint64 Enumerator::elapsed() const {
+    return (m_active ? Timestamp::now() : m_stopped) - m_started;
+}
+
+const QVector<Enumerator::Hit> &Enumerator::hits() const {
+    return m_hits;
+}
+
+QString Enumerator::addrToString(qint64 addr, int base) {
+    // 4-байтовые значения хранятся в int, в шестнадцатеричном виде - без знака
+    if (base != 10 && addr < 0) addr = quint32(addr);
+    return QString::number(addr, base).toUpper();
+}
+
+bool Enumerator::exportHits(const QString &fileName, int base) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        m_error = file.errorString();
+        return false;
+    }
+    QTextStream out(&file);
+    out << tr("Значение;Задержка, мс;Ответ") << "\n";
+    for (const Hit &hit : std::as_const(m_hits)) {
+        out << addrToString(hit.addr, base) << ';'
+            << QString::number(hit.latency / 1000000.0, 'f', 3) << ';'
+            << hit.response.toHex(' ').toUpper() << "\n";
+    }
+    out.flush();
+    if (file.error() != QFileDevice::NoError) {
+        m_error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString Enumerator::errorString() const {
+    return m_error;
+}
+
+void Enumerator::stop() {
+    if (!m_active) return;
+    m_active = false;
+    m_stopped = Timestamp::now();
+    m_timer->stop();
+    m_pending.clear();
+    m_buffer.clear();
+    emit finished();
+}
+
+void Enumerator::receivedData(const QByteArray &data, qint64 timestamp) {
+    if (!m_active || m_pending.empty()) return;
+
+    if (!m_response) {
+        // без образца: кадр целиком - ответ на самый ранний запрос; без кадров ответ не распознать
+        if (!m_framed) return;
+        answer(0, timestamp, data);
+    } else {
+        m_buffer.append(data);
+        // ответы могут прийти не по порядку - берётся самый ранний в буфере
+        for (;;) {
+            qsizetype best = -1;
+            std::size_t bestIdx = 0;
+            for (std::size_t i = 0; i < m_pending.size(); ++i) {
+                const qsizetype pos = m_buffer.indexOf(m_pending[i].expected);
+                if (pos >= 0 && (best < 0 || pos < best)) {
+                    best = pos;
+                    bestIdx = i;
+                }
+            }
+            if (best < 0) break;
+            const qsizetype end = best + m_pending[bestIdx].expected.size();
+            const QByteArray response = m_buffer.left(end);
+            m_buffer.remove(0, end);
+            answer(bestIdx, timestamp, response);
+            if (m_pending.empty()) break;
+        }
+        if (m_buffer.size() > ENUMERATOR_BUFFER) m_buffer.remove(0, m_buffer.size() - ENUMERATOR_BUFFER);
+    }
+    pump();
+}
+
+void Enumerator::answer(std::size_t idx, qint64 timestamp, const QByteArray &response) {
+    const Hit hit = {m_pending[idx].addr, qMax<qint64>(timestamp - m_pending[idx].sent, 0), response};
+    m_pending.erase(m_pending.begin() + idx);
+    m_hits.append(hit);
+    emit responded(hit);
+}
+
+void Enumerator::expire() {
+    const qint64 now = Timestamp::now();
+    while (!m_pending.empty() && (m_pending.front().sent + m_timeout <= now)) {
+        m_pending.pop_front();
+        m_timeouts++;
+    }
+    pump();
+}
+
+void Enumerator::pump() {
+    if (!m_active) return;
+    while ((m_pending.size() < std::size_t(m_window)) && (m_next <= m_to)) {
+        Request request;
+        request.addr = m_next++;
+        if (m_response) request.expected = m_response(request.addr);
+        const QByteArray command = m_command(request.addr);
+        request.sent = Timestamp::now();
+        m_pending.push_back(request);
+        emit writeData(command);
+    }
+    emit progress(sent() - qint64(m_pending.size()), m_to - m_from + 1);
+    if (m_pending.empty()) {
+        stop();
+        return;
+    }
+    arm();
+}
+
+void Enumerator::arm() {
+    // запросы с одинаковым таймаутом истекают в порядке отправки
+    const qint64 left = m_pending.front().sent + m_timeout - Timestamp::now();
+    m_timer->start(int(qMax<qint64>((left + 999999) / 1000000, 0)));
+}
@@ -0,0 +1,89 @@
+#ifndef ENUMERATOR_H
+#define ENUMERATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <deque>
+#include <functional>
+
+#define ENUMERATOR_BUFFER           4096            // байт приёма, хранимых для поиска ответа
+
+// Перебор значений с ожиданием ответа: следующее значение отправляется, как только
+// пришёл ответ на одно из ожидающих или истёк его таймаут. Одновременно ожидают
+// ответа не более window запросов.
+// Ответ ищется по образцу (свой для каждого значения); без образца ответом
+// на самый ранний запрос считается принятый кадр - только при разбиении приёма на кадры,
+// иначе случайный или запоздавший блок дал бы ложное попадание.
+class Enumerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<QByteArray(qint64 addr)> Builder;
+
+    typedef struct {
+        qint64 addr;
+        qint64 latency;                             // нс от отправки до ответа
+        QByteArray response;
+    } Hit;
+
+    explicit Enumerator(QObject *parent = nullptr);
+
+    // command - команда для значения, response - образец ответа (nullptr - кадр, если framed)
+    // framed - принятые блоки являются целыми кадрами
+    void start(qint64 from, qint64 to, int window, qint64 timeout, const Builder &command, const Builder &response, bool framed);
+    bool isActive() const;
+
+    qint64 sent() const;
+    qint64 timeouts() const;
+    qint64 elapsed() const;                         // нс с начала перебора
+    const QVector<Hit> &hits() const;
+
+    bool exportHits(const QString &fileName, int base); // CSV
+    QString errorString() const;
+
+    static QString addrToString(qint64 addr, int base);
+
+public slots:
+    void stop();
+    void receivedData(const QByteArray &data, qint64 timestamp); // timestamp - Timestamp::now()
+
+signals:
+    void writeData(const QByteArray &data);
+    void responded(const Enumerator::Hit &hit);
+    void progress(qint64 done, qint64 total);
+    void finished();
+
+private:
+    typedef struct {
+        qint64 addr;
+        qint64 sent;                                // Timestamp::now() при отправке
+        QByteArray expected;
+    } Request;
+
+    void pump();
+    void expire();
+    void answer(std::size_t idx, qint64 timestamp, const QByteArray &response);
+    void arm();
+
+    QTimer *m_timer = nullptr;
+    std::deque<Request> m_pending;                  // в порядке отправки
+    Builder m_command;
+    Builder m_response;
+    QByteArray m_buffer;
+    QVector<Hit> m_hits;
+    QString m_error;
+    qint64 m_from = 0;
+    qint64 m_to = 0;
+    qint64 m_next = 0;
+    qint64 m_timeout = 0;
+    qint64 m_started = 0;
+    qint64 m_stopped = 0;
+    qint64 m_timeouts = 0;
+    int m_window = 1;
+    bool m_framed = false;
+    bool m_active = false;
+};
+
+#endif // ENUMERATOR_H
@@ -0,0 +1,176 @@
+#include "filesender.h"
+
+#define XON     0x11
+#define XOFF    0x13
+
+FileSender::FileSender(QObject *parent):
+    QObject(parent),
+    m_crc(*Crc::model("CRC-32/ISO-HDLC"))
+{
+}
+
+bool FileSender::start(const QString &fileName, const Connection::Settings &settings) {
+    if (m_active) cancel();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_map = (m_size > 0) ? m_file.map(0, m_size) : nullptr; // без отображения - чтение по частям
+
+    const bool serial = (settings.type == Connection::Serial);
+    m_hardware = serial && (settings.flowControl == QSerialPort::HardwareControl);
+    m_software = serial && (settings.flowControl == QSerialPort::SoftwareControl);
+    m_chunk = (settings.type == Connection::UdpUnicast || settings.type == Connection::UdpBroadcast) ?
+                FILESENDER_CHUNK_UDP : FILESENDER_CHUNK;
+
+    m_crc.init();
+    m_error.clear();
+    m_offset = 0;
+    m_written = 0;
+    m_active = true;
+    m_paused = false;
+    m_xoff = false;
+    m_pausedTime = 0;
+    m_notified = 0;
+    m_elapsed.start();
+    notify(true);
+    pump();
+    return true;
+}
+
+QString FileSender::errorString() const {
+    return m_error;
+}
+
+bool FileSender::isActive() const {
+    return m_active;
+}
+
+bool FileSender::isPaused() const {
+    return m_paused;
+}
+
+bool FileSender::isBlocked() const {
+    return m_active && (!m_cts || m_xoff);
+}
+
+QString FileSender::fileName() const {
+    return m_file.fileName();
+}
+
+qint64 FileSender::size() const {
+    return m_size;
+}
+
+qint64 FileSender::written() const {
+    return m_written;
+}
+
+qint64 FileSender::throughput() const {
+    if (!m_elapsed.isValid()) return 0;
+    qint64 active = m_elapsed.elapsed() - m_pausedTime;
+    if (m_paused) active -= m_elapsed.elapsed() - m_pausedAt;
+    return (active > 0) ? m_written * 1000 / active : 0;
+}
+
+qint64 FileSender::eta() const {
+    const qint64 rate = throughput();
+    return (rate > 0) ? (m_size - m_written) * 1000 / rate : -1;
+}
+
+quint32 FileSender::crc() const {
+    return quint32(m_crc.finalize());
+}
+
+void FileSender::pause() {
+    if (!m_active || m_paused) return;
+    m_paused = true;
+    m_pausedAt = m_elapsed.elapsed();
+    notify(true);
+}
+
+void FileSender::resume() {
+    if (!m_active || !m_paused) return;
+    m_paused = false;
+    m_pausedTime += m_elapsed.elapsed() - m_pausedAt;
+    notify(true);
+    pump();
+}
+
+void FileSender::cancel() {
+    if (m_active) stop(false);
+}
+
+void FileSender::bytesWritten(qint64 bytes) {
+    if (!m_active) return;
+    // bytesWritten приходит и для прочих отправок (команды, перебор) - не больше переданного
+    m_written = qMin(m_written + bytes, m_offset);
+    if (m_written >= m_size) {
+        stop(true);
+        return;
+    }
+    notify(false);
+    pump();
+}
+
+void FileSender::setPinoutSignals(QSerialPort::PinoutSignals pinout) {
+    const bool cts = pinout.testFlag(QSerialPort::ClearToSendSignal);
+    if (cts == m_cts) return;
+    m_cts = cts;
+    if (!m_active || !m_hardware) return;
+    notify(true);
+    pump();
+}
+
+void FileSender::receivedData(const QByteArray &data) {
+    if (!m_active || !m_software) return;
+    const qsizetype on = data.lastIndexOf(char(XON));
+    const qsizetype off = data.lastIndexOf(char(XOFF));
+    if (on < 0 && off < 0) return;
+    const bool xoff = (off > on);
+    if (xoff == m_xoff) return;
+    m_xoff = xoff;
+    notify(true);
+    pump();
+}
+
+void FileSender::pump() {
+    if (!m_active || m_paused) return;
+    if ((m_hardware && !m_cts) || (m_software && m_xoff)) return;
+    while (m_offset < m_size && (m_offset - m_written) < FILESENDER_WINDOW) {
+        const QByteArray data = chunk(m_offset, qMin(m_chunk, m_size - m_offset));
+        if (data.isEmpty()) {
+            m_error = m_file.errorString();
+            stop(false);
+            return;
+        }
+        m_crc.update(data);
+        m_offset += data.size();
+        emit writeData(data);
+    }
+    if (m_size == 0) stop(true);
+}
+
+void FileSender::stop(bool completed) {
+    m_active = false;
+    if (m_map) m_file.unmap(const_cast<uchar *>(m_map));
+    m_map = nullptr;
+    m_file.close();
+    notify(true);
+    emit finished(completed);
+}
+
+void FileSender::notify(bool force) {
+    const qint64 now = m_elapsed.elapsed();
+    if (!force && (now - m_notified) < FILESENDER_PROGRESS) return;
+    m_notified = now;
+    emit progress(m_written, m_size);
+}
+
+QByteArray FileSender::chunk(qint64 offset, qint64 size) {
+    if (m_map) return QByteArray(reinterpret_cast<const char *>(m_map) + offset, size);
+    if (m_file.pos() != offset && !m_file.seek(offset)) return QByteArray();
+    return m_file.read(size);
+}
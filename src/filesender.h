@@ -0,0 +1,80 @@
+#ifndef FILESENDER_H
+#define FILESENDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QSerialPort>
+#include "connection.h"
+#include "crc.h"
+
+#define FILESENDER_CHUNK            4096            // байт за одну запись
+#define FILESENDER_CHUNK_UDP        1024            // размер датаграммы
+#define FILESENDER_WINDOW           (64 * 1024)     // не подтверждённых байт, не более
+#define FILESENDER_PROGRESS         100             // период уведомлений, мс
+
+// Потоковая отправка файла: файл отображается в память (или читается по частям),
+// очередная часть передаётся по мере подтверждения записи (bytesWritten).
+// Учитывает аппаратное (CTS) и программное (XON/XOFF) управление потоком.
+class FileSender : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileSender(QObject *parent = nullptr);
+
+    bool start(const QString &fileName, const Connection::Settings &settings);
+    QString errorString() const;
+
+    bool isActive() const;
+    bool isPaused() const;
+    bool isBlocked() const;                         // остановлено управлением потоком
+
+    QString fileName() const;
+    qint64 size() const;
+    qint64 written() const;                         // подтверждено устройством
+    qint64 throughput() const;                      // байт/с
+    qint64 eta() const;                             // мс, -1 - неизвестно
+    quint32 crc() const;                            // CRC-32 отправленных данных
+
+public slots:
+    void pause();
+    void resume();
+    void cancel();
+
+    void bytesWritten(qint64 bytes);
+    void setPinoutSignals(QSerialPort::PinoutSignals pinout);
+    void receivedData(const QByteArray &data);      // поиск XON/XOFF
+
+signals:
+    void writeData(const QByteArray &data);
+    void progress(qint64 written, qint64 total);
+    void finished(bool completed);
+
+private:
+    void pump();
+    void stop(bool completed);
+    void notify(bool force);
+    QByteArray chunk(qint64 offset, qint64 size);
+
+    QFile m_file;
+    const uchar *m_map = nullptr;
+    Crc::Stream m_crc;
+    QString m_error;
+    qint64 m_size = 0;
+    qint64 m_offset = 0;                            // передано в транспорт
+    qint64 m_written = 0;                           // подтверждено
+    qint64 m_chunk = FILESENDER_CHUNK;
+    bool m_active = false;
+    bool m_paused = false;
+    bool m_hardware = false;                        // RTS/CTS
+    bool m_software = false;                        // XON/XOFF
+    bool m_cts = true;
+    bool m_xoff = false;
+    QElapsedTimer m_elapsed;                        // с начала отправки
+    qint64 m_pausedTime = 0;                        // мс на паузе
+    qint64 m_pausedAt = 0;
+    qint64 m_notified = 0;                          // время последнего уведомления
+};
+
+#endif // FILESENDER_H
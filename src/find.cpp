@@ -1,15 +1,21 @@
 #include "find.h"
 #include "ui_find.h"
 
-#include <QRegularExpression>
-
-DialogFind::DialogFind(QPlainTextEdit *editor, QWidget *parent): QDialog(parent), m_ui(new Ui::DialogFind), m_editor(editor) {
+DialogFind::DialogFind(Console *editor, QWidget *parent): QDialog(parent), m_ui(new Ui::DialogFind), m_editor(editor) {
     m_ui->setupUi(this);
     connect(m_ui->pushButtonFind, &QPushButton::clicked, this, &DialogFind::find);
     connect(m_ui->pushButtonCancel, &QPushButton::clicked, this, &DialogFind::close);
     connect(m_ui->horizontalSliderOpacity, &QSlider::valueChanged, this, [=](int value) {
         setWindowOpacity(double(value) / m_ui->horizontalSliderOpacity->maximum());
     });
+    connect(m_ui->lineEditWhat, &QLineEdit::textChanged, this, &DialogFind::patternChanged);
+    connect(m_ui->checkBoxCaseSensitive, &QCheckBox::toggled, this, &DialogFind::patternChanged);
+    connect(m_ui->checkBoxRegEx, &QCheckBox::toggled, this, &DialogFind::patternChanged);
+    connect(m_ui->checkBoxHighlightAll, &QCheckBox::toggled, this, [=](bool checked) {
+        m_editor->setHighlightAll(checked);
+        if (checked) startSearch();
+    });
+    connect(m_editor, &Console::matchesChanged, this, &DialogFind::matchesChanged);
 }
 
 DialogFind::~DialogFind() {
@@ -20,15 +26,55 @@ void DialogFind::setOpacity(double value) {
     m_ui->horizontalSliderOpacity->setValue(qRound(m_ui->horizontalSliderOpacity->maximum() * value));
 }
 
+void DialogFind::hideEvent(QHideEvent *event) {
+    // индекс вхождений и копия буфера нужны только при открытом окне
+    m_editor->stopSearch();
+    m_searching = false;
+    m_ui->labelCount->clear();
+    QDialog::hideEvent(event);
+}
+
 void DialogFind::find() {
-    QTextDocument::FindFlags flag;
-    if (m_ui->radioButtonDirectionUp->isChecked()) flag |= QTextDocument::FindBackward;
-    if (m_ui->checkBoxCaseSensitive->isChecked()) flag |= QTextDocument::FindCaseSensitively;
-
-    if (m_ui->checkBoxRegEx->isChecked()) {
-        QRegularExpression re(m_ui->lineEditWhat->text());
-        m_editor->find(re, flag);
-    } else {
-        m_editor->find(m_ui->lineEditWhat->text(), flag);
+    if (!startSearch()) return;
+    if (!m_editor->findMatch(m_ui->radioButtonDirectionUp->isChecked())) m_ui->labelCount->setText(tr("Больше не найдено"));
+}
+
+void DialogFind::patternChanged() {
+    if (m_ui->checkBoxHighlightAll->isChecked()) {
+        startSearch();                              // поиск по мере ввода
+    } else if (m_searching) {
+        m_editor->stopSearch();
+        m_searching = false;
+        m_ui->labelCount->clear();
+    }
+}
+
+void DialogFind::matchesChanged(qsizetype count, bool done) {
+    if (!m_searching) return;
+    m_ui->labelCount->setText(done ? tr("Найдено: %1").arg(count) : tr("Поиск... найдено: %1").arg(count));
+}
+
+bool DialogFind::startSearch() {
+    const QString text = m_ui->lineEditWhat->text();
+    if (text.isEmpty()) {
+        m_editor->stopSearch();
+        m_searching = false;
+        m_ui->labelCount->clear();
+        return false;
+    }
+    const QString pattern = m_ui->checkBoxRegEx->isChecked() ? text : QRegularExpression::escape(text);
+    const QRegularExpression::PatternOptions options = m_ui->checkBoxCaseSensitive->isChecked() ?
+        QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption;
+    if (m_searching && (m_re.pattern() == pattern) && (m_re.patternOptions() == options)) return true;
+
+    m_re = QRegularExpression(pattern, options);
+    if (!m_re.isValid()) {
+        m_editor->stopSearch();
+        m_searching = false;
+        m_ui->labelCount->setText(tr("Ошибка в выражении: %1").arg(m_re.errorString()));
+        return false;
     }
+    m_searching = true;
+    m_editor->startSearch(m_re);
+    return true;
 }
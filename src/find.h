@@ -2,7 +2,8 @@
 #define FIND_H
 
 #include <QDialog>
-#include <QPlainTextEdit>
+#include <QRegularExpression>
+#include "console.h"
 
 namespace Ui {
 class DialogFind;
@@ -13,17 +14,26 @@ class DialogFind : public QDialog
     Q_OBJECT
 
 public:
-    explicit DialogFind(QPlainTextEdit *editor, QWidget *parent = nullptr);
+    explicit DialogFind(Console *editor, QWidget *parent = nullptr);
     ~DialogFind();
 
     void setOpacity(double value);
 
+protected:
+    void hideEvent(QHideEvent *event) override;
+
 private slots:
     void find();
+    void patternChanged();
+    void matchesChanged(qsizetype count, bool done);
 
 private:
+    bool startSearch();                             // выражение компилируется только при изменении
+
     Ui::DialogFind *m_ui;
-    QPlainTextEdit *m_editor;
+    Console *m_editor;
+    QRegularExpression m_re;
+    bool m_searching = false;
 
 };
 
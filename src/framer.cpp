@@ -0,0 +1,263 @@
+#include "framer.h"
+#include "command.h"
+
+#include <QByteArrayView>
+#include <QtEndian>
+#include <cstring>
+
+#define SLIP_END                0xC0
+#define SLIP_ESC                0xDB
+#define SLIP_ESC_END            0xDC
+#define SLIP_ESC_ESC            0xDD
+#define COBS_MAX_CODE           0xFF                // группа из 254 байт без завершающего нуля
+
+void Framer::setSettings(const Connection::Settings &settings) {
+    m_mode = settings.framing;
+    m_delimiter = Command::fromString(settings.frameDelimiter);
+    m_lengthOffset = qMax(settings.frameLengthOffset, 0);
+    m_lengthSize = (settings.frameLengthSize == 2 || settings.frameLengthSize == 4) ? settings.frameLengthSize : 1;
+    m_lengthBigEndian = settings.frameLengthBigEndian;
+    m_lengthAdjust = settings.frameLengthAdjust;
+    m_gap = qint64(settings.frameGap) * 1000000;
+    // без параметров разбиение невозможно - поток передаётся как есть
+    if ((m_mode == Connection::FrameDelimiter && m_delimiter.isEmpty()) ||
+        (m_mode == Connection::FrameGap && m_gap <= 0)) {
+        m_mode = Connection::FrameNone;
+    }
+    reset();
+}
+
+void Framer::reset() {
+    m_partial.clear();
+    m_last = -1;
+    m_expected = -1;
+    m_error = false;
+    m_escape = false;
+    m_code = 0;
+    m_remaining = 0;
+    m_zero = false;
+}
+
+bool Framer::isEnabled() const {
+    return m_mode != Connection::FrameNone;
+}
+
+qsizetype Framer::delimiterSize() const {
+    return (m_mode == Connection::FrameDelimiter) ? m_delimiter.size() : 0;
+}
+
+void Framer::push(const char *data, qsizetype size, qint64 timestamp, Frames &frames) {
+    if (size <= 0) return;
+    m_now = timestamp;
+    switch (m_mode) {
+    case Connection::FrameDelimiter:
+        pushDelimiter(data, size, frames);
+        break;
+    case Connection::FrameLength:
+        pushLength(data, size, frames);
+        break;
+    case Connection::FrameGap:
+        // метка времени - момент чтения блока, поэтому пауза измеряется между блоками
+        if (!m_partial.isEmpty() && timestamp - m_last >= m_gap) completePartial(frames);
+        append(data, size, frames);
+        m_last = timestamp;
+        break;
+    case Connection::FrameSlip:
+        pushSlip(data, size, frames);
+        break;
+    case Connection::FrameCobs:
+        pushCobs(data, size, frames);
+        break;
+    default: // Connection::FrameNone
+        complete(data, size, frames);
+    }
+}
+
+qint64 Framer::deadline() const {
+    if (m_mode != Connection::FrameGap || m_partial.isEmpty()) return -1;
+    return m_last + m_gap;
+}
+
+void Framer::expire(qint64 now, Frames &frames) {
+    const qint64 time = deadline();
+    if (time >= 0 && now >= time) completePartial(frames);
+}
+
+void Framer::pushDelimiter(const char *data, qsizetype size, Frames &frames) {
+    const qsizetype length = m_delimiter.size();
+    qsizetype pos = 0;
+    // разделитель на границе блоков: начало - в конце незавершённого кадра
+    for (qsizetype k = qMin(length - 1, m_partial.size()); k > 0; --k) {
+        if (size >= length - k &&
+            std::memcmp(m_partial.constData() + m_partial.size() - k, m_delimiter.constData(), k) == 0 &&
+            std::memcmp(data, m_delimiter.constData() + k, length - k) == 0) {
+            complete(data, length - k, frames);
+            pos = length - k;
+            break;
+        }
+    }
+    const QByteArrayView input(data, size);
+    while (pos < size) {
+        const qsizetype found = input.indexOf(QByteArrayView(m_delimiter), pos);
+        if (found < 0) {
+            append(data + pos, size - pos, frames);
+            return;
+        }
+        const qsizetype end = found + length;
+        complete(data + pos, end - pos, frames);
+        pos = end;
+    }
+}
+
+void Framer::pushLength(const char *data, qsizetype size, Frames &frames) {
+    const qsizetype header = m_lengthOffset + m_lengthSize;
+    qsizetype pos = 0;
+    while (pos < size) {
+        const qsizetype left = size - pos;
+        if (m_partial.isEmpty() && left >= header) {
+            // заголовок в блоке: кадр выдаётся без промежуточного буфера, если поместился целиком
+            const qint64 length = frameLength(data + pos);
+            if (length < 0) {
+                complete(data + pos, header, frames, true); // рассинхронизация - заголовок в ошибочный кадр
+                pos += header;
+                continue;
+            }
+            if (left >= length) {
+                complete(data + pos, length, frames);
+                pos += length;
+                continue;
+            }
+            m_expected = length;
+            append(data + pos, left, frames);
+            return;
+        }
+        if (m_expected < 0) {
+            const qsizetype n = qMin(left, header - m_partial.size());
+            append(data + pos, n, frames);
+            pos += n;
+            if (m_partial.size() < header) return;
+            m_expected = frameLength(m_partial.constData());
+            if (m_expected < 0) {
+                m_error = true;
+                completePartial(frames);
+                continue;
+            }
+        } else {
+            const qsizetype n = qMin<qint64>(size - pos, m_expected - m_partial.size());
+            append(data + pos, n, frames);
+            pos += n;
+        }
+        if (m_expected >= 0 && m_partial.size() >= m_expected) { // append() мог закрыть кадр по переполнению
+            m_expected = -1;
+            completePartial(frames);
+        }
+    }
+}
+
+void Framer::pushSlip(const char *data, qsizetype size, Frames &frames) {
+    const char *end = data + size;
+    while (data < end) {
+        if (m_escape) {
+            m_escape = false;
+            char c = *data++;
+            if (uchar(c) == SLIP_ESC_END) {
+                c = char(SLIP_END);
+            } else if (uchar(c) == SLIP_ESC_ESC) {
+                c = char(SLIP_ESC);
+            } else {
+                m_error = true;                     // недопустимая последовательность - байт как есть
+            }
+            append(&c, 1, frames);
+            continue;
+        }
+        // данные до служебного байта - одним копированием
+        const char *p = data;
+        while (p < end && uchar(*p) != SLIP_END && uchar(*p) != SLIP_ESC) ++p;
+        if (p > data) append(data, p - data, frames);
+        if (p == end) return;
+        if (uchar(*p) == SLIP_ESC) {
+            m_escape = true;
+        } else if (!m_partial.isEmpty() || m_error) {
+            completePartial(frames);                // END без данных - сброс шума линии, не кадр
+        }
+        data = p + 1;
+    }
+}
+
+void Framer::pushCobs(const char *data, qsizetype size, Frames &frames) {
+    static const char zero = 0;
+    const char *end = data + size;
+    while (data < end) {
+        if (*data == 0) {
+            // конец кадра: ноль после последней группы не передаётся
+            if (m_remaining > 0) m_error = true;    // группа не завершена
+            if (!m_partial.isEmpty() || m_error) completePartial(frames);
+            m_code = 0;
+            m_remaining = 0;
+            m_zero = false;
+            ++data;
+            continue;
+        }
+        if (m_remaining == 0) {
+            // код группы: предыдущая группа короче максимальной заканчивалась нулём
+            if (m_zero) append(&zero, 1, frames);
+            m_code = uchar(*data++);
+            m_remaining = m_code - 1;
+            m_zero = (m_remaining == 0);
+            continue;
+        }
+        const qsizetype span = qMin<qsizetype>(m_remaining, end - data);
+        const char *found = static_cast<const char *>(std::memchr(data, 0, span));
+        const qsizetype n = found ? found - data : span;
+        append(data, n, frames);
+        data += n;
+        m_remaining -= int(n);
+        if (m_remaining == 0) m_zero = (m_code != COBS_MAX_CODE);
+    }
+}
+
+qint64 Framer::frameLength(const char *header) const {
+    const uchar *p = reinterpret_cast<const uchar *>(header + m_lengthOffset);
+    quint32 value;
+    switch (m_lengthSize) {
+    case 2: value = m_lengthBigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p); break;
+    case 4: value = m_lengthBigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p); break;
+    default: value = *p;
+    }
+    const qint64 length = m_lengthOffset + m_lengthSize + qint64(value) + m_lengthAdjust;
+    // кадр длиной FRAMER_MAX_FRAME закрыла бы append() - он так же недопустим при любом делении на блоки
+    return (length < m_lengthOffset + m_lengthSize || length >= FRAMER_MAX_FRAME) ? -1 : length;
+}
+
+void Framer::append(const char *data, qsizetype size, Frames &frames) {
+    while (size > 0) {
+        if (m_partial.isEmpty()) m_timestamp = m_now;
+        const qsizetype n = qMin<qsizetype>(size, FRAMER_MAX_FRAME - m_partial.size());
+        m_partial.append(data, n);
+        data += n;
+        size -= n;
+        if (m_partial.size() >= FRAMER_MAX_FRAME) {
+            m_error = true;                         // конец кадра потерян
+            m_expected = -1;
+            completePartial(frames);
+        }
+    }
+}
+
+void Framer::complete(const char *data, qsizetype size, Frames &frames, bool error) {
+    if (m_partial.isEmpty()) {
+        frames.append({QByteArray(data, size), m_now, error || m_error});
+        m_error = false;
+        return;
+    }
+    m_partial.append(data, size);
+    m_error = m_error || error;
+    completePartial(frames);
+}
+
+void Framer::completePartial(Frames &frames) {
+    if (m_partial.isEmpty()) m_timestamp = m_now;
+    frames.append({std::move(m_partial), m_timestamp, m_error});
+    m_partial = QByteArray();
+    m_error = false;
+}
@@ -0,0 +1,64 @@
+#ifndef FRAMER_H
+#define FRAMER_H
+
+#include <QByteArray>
+#include <QVector>
+#include "connection.h"
+
+#define FRAMER_MAX_FRAME        65536               // байт, длиннее - кадр закрывается с ошибкой
+
+// Разбиение потока приёма на кадры: разделитель, длина в заголовке, пауза, SLIP, COBS.
+// Блоки поступают в произвольных границах; каждый байт копируется один раз -
+// сразу в кадр или в незавершённый кадр, который затем передаётся без копирования.
+class Framer
+{
+public:
+    typedef struct {
+        QByteArray data;                            // SLIP, COBS - декодированные
+        qint64 timestamp;                           // Timestamp::now() блока с первым байтом кадра
+        bool error;                                 // нарушение кодирования или длины, переполнение
+    } Frame;
+
+    typedef QVector<Frame> Frames;
+
+    void setSettings(const Connection::Settings &settings);
+    void reset();                                   // отбросить незавершённый кадр
+    bool isEnabled() const;
+    qsizetype delimiterSize() const;                // FrameDelimiter: разделитель в конце кадра, иначе 0
+
+    // готовые кадры добавляются в frames
+    void push(const char *data, qsizetype size, qint64 timestamp, Frames &frames);
+    qint64 deadline() const;                        // FrameGap: когда закрыть кадр по паузе, -1 - нечего закрывать
+    void expire(qint64 now, Frames &frames);
+
+private:
+    void pushDelimiter(const char *data, qsizetype size, Frames &frames);
+    void pushLength(const char *data, qsizetype size, Frames &frames);
+    void pushSlip(const char *data, qsizetype size, Frames &frames);
+    void pushCobs(const char *data, qsizetype size, Frames &frames);
+    qint64 frameLength(const char *header) const;   // -1 - недопустимая длина
+    void append(const char *data, qsizetype size, Frames &frames); // в незавершённый кадр, с контролем переполнения
+    void complete(const char *data, qsizetype size, Frames &frames, bool error = false);
+    void completePartial(Frames &frames);
+
+    Connection::Framing m_mode = Connection::FrameNone;
+    QByteArray m_delimiter;
+    qsizetype m_lengthOffset = 0;
+    qsizetype m_lengthSize = 1;
+    bool m_lengthBigEndian = false;
+    qint64 m_lengthAdjust = 0;
+    qint64 m_gap = 0;                               // нс
+
+    QByteArray m_partial;                           // незавершённый кадр
+    qint64 m_now = 0;                               // метка текущего блока
+    qint64 m_timestamp = 0;                         // первого байта текущего кадра
+    qint64 m_last = -1;                             // блока с последним байтом, FrameGap
+    qint64 m_expected = -1;                         // FrameLength: длина кадра, -1 - заголовок не принят
+    bool m_error = false;                           // ошибка в текущем кадре
+    bool m_escape = false;                          // SLIP: принят ESC
+    int m_code = 0;                                 // COBS: код текущей группы, 0 - ожидается код
+    int m_remaining = 0;                            // COBS: байт данных до конца группы
+    bool m_zero = false;                            // COBS: ноль после группы, если кадр продолжится
+};
+
+#endif // FRAMER_H
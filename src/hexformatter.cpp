@@ -0,0 +1,214 @@
+#include "hexformatter.h"
+
+#include <cstring>
+
+#define HEX_WIDTH   4                               // "<XX>"
+#define HEX_MAX     (HEX_WIDTH + 1)                 // + перевод строки
+
+// Таблица "<XX>" для каждого байта, вычисляется при компиляции
+
+typedef struct {
+    char t[256][HEX_WIDTH];
+} HexTable;
+
+static constexpr HexTable makeHexTable() {
+    HexTable r{};
+    const char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < 256; ++i) {
+        r.t[i][0] = '<';
+        r.t[i][1] = digits[i >> 4];
+        r.t[i][2] = digits[i & 0x0F];
+        r.t[i][3] = '>';
+    }
+    return r;
+}
+
+static constexpr HexTable hexTable = makeHexTable();
+
+// Управляющие символы и байты >= 0x80 (отрицательные для char)
+static inline bool isSpecial(uchar c) {
+    return (c < 0x20) || (c >= 0x80);
+}
+
+static char *formatScalar(char *dst, const uchar *src, qsizetype size, const HexFormatter::Options &options) {
+    for (qsizetype i = 0; i < size; ++i) {
+        const uchar c = src[i];
+        if (options.hexAll || isSpecial(c)) {
+            memcpy(dst, hexTable.t[c], HEX_WIDTH);
+            dst += HEX_WIDTH;
+        } else {
+            *dst++ = char(c);
+        }
+        if (options.linefeed && (char(c) == options.linefeedChar)) *dst++ = '\n';
+    }
+    return dst;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define HEX_X86
+#include <immintrin.h>
+
+// Полубайты 0..15 -> '0'..'9', 'A'..'F'
+static inline __m128i nibblesSse2(__m128i n) {
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letters);
+}
+
+// 16 байт -> 64 символа
+static inline void hex16Sse2(char *dst, __m128i v) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i hi = nibblesSse2(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i lo = nibblesSse2(_mm_and_si128(v, mask));
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i a0 = _mm_unpacklo_epi8(lt, hi);   // '<' X
+    const __m128i a1 = _mm_unpackhi_epi8(lt, hi);
+    const __m128i b0 = _mm_unpacklo_epi8(lo, gt);   // X '>'
+    const __m128i b1 = _mm_unpackhi_epi8(lo, gt);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 0x00), _mm_unpacklo_epi16(a0, b0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 0x10), _mm_unpackhi_epi16(a0, b0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 0x20), _mm_unpacklo_epi16(a1, b1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 0x30), _mm_unpackhi_epi16(a1, b1));
+}
+
+static char *formatSse2(char *dst, const uchar *src, qsizetype size, const HexFormatter::Options &options) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i lf = _mm_set1_epi8(options.linefeedChar);
+    qsizetype i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const int lfMask = options.linefeed ? _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf)) : 0;
+        if (options.hexAll) {
+            if (!lfMask) {
+                hex16Sse2(dst, v);
+                dst += 16 * HEX_WIDTH;
+                continue;
+            }
+        } else if (!(_mm_movemask_epi8(_mm_cmplt_epi8(v, space)) | lfMask)) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), v); // печатный текст - копия
+            dst += 16;
+            continue;
+        }
+        dst = formatScalar(dst, src + i, 16, options);
+    }
+    return formatScalar(dst, src + i, size - i, options);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i nibblesAvx2(__m256i n) {
+    const __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(n, _mm256_set1_epi8(9)), _mm256_set1_epi8('A' - '0' - 10));
+    return _mm256_add_epi8(_mm256_add_epi8(n, _mm256_set1_epi8('0')), letters);
+}
+
+// 32 байта -> 128 символов; распаковка идёт внутри 128-битных половин, затем перестановка
+__attribute__((target("avx2")))
+static inline void hex32Avx2(char *dst, __m256i v) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i hi = nibblesAvx2(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    const __m256i lo = nibblesAvx2(_mm256_and_si256(v, mask));
+    const __m256i lt = _mm256_set1_epi8('<');
+    const __m256i gt = _mm256_set1_epi8('>');
+    const __m256i a0 = _mm256_unpacklo_epi8(lt, hi);
+    const __m256i a1 = _mm256_unpackhi_epi8(lt, hi);
+    const __m256i b0 = _mm256_unpacklo_epi8(lo, gt);
+    const __m256i b1 = _mm256_unpackhi_epi8(lo, gt);
+    const __m256i r0 = _mm256_unpacklo_epi16(a0, b0); // байты 0-3 | 16-19
+    const __m256i r1 = _mm256_unpackhi_epi16(a0, b0); // 4-7 | 20-23
+    const __m256i r2 = _mm256_unpacklo_epi16(a1, b1); // 8-11 | 24-27
+    const __m256i r3 = _mm256_unpackhi_epi16(a1, b1); // 12-15 | 28-31
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 0x00), _mm256_permute2x128_si256(r0, r1, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 0x20), _mm256_permute2x128_si256(r2, r3, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 0x40), _mm256_permute2x128_si256(r0, r1, 0x31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 0x60), _mm256_permute2x128_si256(r2, r3, 0x31));
+}
+
+__attribute__((target("avx2")))
+static char *formatAvx2(char *dst, const uchar *src, qsizetype size, const HexFormatter::Options &options) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i lf = _mm256_set1_epi8(options.linefeedChar);
+    qsizetype i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const int lfMask = options.linefeed ? _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, lf)) : 0;
+        if (options.hexAll) {
+            if (!lfMask) {
+                hex32Avx2(dst, v);
+                dst += 32 * HEX_WIDTH;
+                continue;
+            }
+        } else if (!(_mm256_movemask_epi8(_mm256_cmpgt_epi8(space, v)) | lfMask)) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v);
+            dst += 32;
+            continue;
+        }
+        dst = formatScalar(dst, src + i, 32, options);
+    }
+    return formatSse2(dst, src + i, size - i, options);
+}
+
+static bool hasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define HEX_NEON
+#include <arm_neon.h>
+
+static char *formatNeon(char *dst, const uchar *src, qsizetype size, const HexFormatter::Options &options) {
+    static const uint8_t digits[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+    const uint8x16_t table = vld1q_u8(digits);
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+    const uint8x16_t lf = vdupq_n_u8(uint8_t(options.linefeedChar));
+    const int8x16_t space = vdupq_n_s8(' ');
+    qsizetype i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t v = vld1q_u8(src + i);
+        const bool hasLf = options.linefeed && vmaxvq_u8(vceqq_u8(v, lf));
+        if (options.hexAll) {
+            if (!hasLf) {
+                uint8x16x4_t r;
+                r.val[0] = vdupq_n_u8('<');
+                r.val[1] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+                r.val[2] = vqtbl1q_u8(table, vandq_u8(v, mask));
+                r.val[3] = vdupq_n_u8('>');
+                vst4q_u8(reinterpret_cast<uint8_t *>(dst), r); // чередование '<' X X '>'
+                dst += 16 * HEX_WIDTH;
+                continue;
+            }
+        } else if (!hasLf && !vmaxvq_u8(vcltq_s8(vreinterpretq_s8_u8(v), space))) {
+            vst1q_u8(reinterpret_cast<uint8_t *>(dst), v);
+            dst += 16;
+            continue;
+        }
+        dst = formatScalar(dst, src + i, 16, options);
+    }
+    return formatScalar(dst, src + i, size - i, options);
+}
+#endif
+
+qsizetype HexFormatter::maxSize(qsizetype size) {
+    return size * HEX_MAX;
+}
+
+void HexFormatter::append(QByteArray &out, const char *data, qsizetype size, const Options &options) {
+    if (size <= 0) return;
+    const qsizetype offset = out.size();
+    out.resize(offset + maxSize(size));
+    char *begin = out.data() + offset;
+    const uchar *src = reinterpret_cast<const uchar *>(data);
+#if defined(HEX_X86)
+    char *end = hasAvx2() ? formatAvx2(begin, src, size, options) : formatSse2(begin, src, size, options);
+#elif defined(HEX_NEON)
+    char *end = formatNeon(begin, src, size, options);
+#else
+    char *end = formatScalar(begin, src, size, options);
+#endif
+    out.resize(offset + (end - begin));
+}
+
+QByteArray HexFormatter::format(const QByteArray &data, const Options &options) {
+    QByteArray result;
+    append(result, data.constData(), data.size(), options);
+    return result;
+}
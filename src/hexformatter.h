@@ -0,0 +1,22 @@
+#ifndef HEXFORMATTER_H
+#define HEXFORMATTER_H
+
+#include <QByteArray>
+
+// Форматирование принятых данных для режима HEX: "<XX>" вместо байта.
+// Один проход, запись в заранее выделенный буфер, SSE2/AVX2/NEON при наличии.
+class HexFormatter
+{
+public:
+    typedef struct {
+        bool hexAll;                                // все байты, иначе только управляющие и >= 0x80
+        bool linefeed;                              // перевод строки после linefeedChar
+        char linefeedChar;
+    } Options;
+
+    static qsizetype maxSize(qsizetype size);       // максимальный размер результата
+    static void append(QByteArray &out, const char *data, qsizetype size, const Options &options);
+    static QByteArray format(const QByteArray &data, const Options &options);
+};
+
+#endif // HEXFORMATTER_H
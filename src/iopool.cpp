@@ -0,0 +1,47 @@
+#include "iopool.h"
+
+#include <QThread>
+
+IoPool::IoPool(QObject *parent):
+    QObject(parent),
+    m_maxThreads(qBound(1, QThread::idealThreadCount(), IOPOOL_MAX_THREADS))
+{
+}
+
+IoPool::~IoPool() {
+    // отложенное удаление транспортов выполняется при завершении потока
+    for (const Worker &worker : std::as_const(m_workers)) worker.thread->quit();
+    for (const Worker &worker : std::as_const(m_workers)) {
+        worker.thread->wait();
+        delete worker.thread;
+    }
+}
+
+QThread *IoPool::acquire() {
+    int best = -1;
+    for (int i = 0; i < m_workers.size(); ++i) {
+        if (best < 0 || m_workers.at(i).users < m_workers.at(best).users) best = i;
+    }
+    if (best < 0 || (m_workers.at(best).users > 0 && m_workers.size() < m_maxThreads)) {
+        QThread *thread = new QThread;
+        thread->setObjectName(QString("io%1").arg(m_workers.size()));
+        thread->start(QThread::TimeCriticalPriority);
+        m_workers.append({thread, 0});
+        best = m_workers.size() - 1;
+    }
+    m_workers[best].users++;
+    return m_workers.at(best).thread;
+}
+
+void IoPool::release(QThread *thread) {
+    for (Worker &worker : m_workers) {
+        if (worker.thread == thread) {
+            worker.users--;
+            return;
+        }
+    }
+}
+
+int IoPool::threadCount() const {
+    return m_workers.size();
+}
@@ -0,0 +1,37 @@
+#ifndef IOPOOL_H
+#define IOPOOL_H
+
+#include <QObject>
+#include <QVector>
+
+class QThread;
+
+#define IOPOOL_MAX_THREADS      4                   // потоков ввода-вывода, не более
+
+// Общие потоки ввода-вывода для транспортов всех сессий.
+// Транспорт занят ожиданием событий, поэтому один поток обслуживает несколько устройств;
+// новый поток создаётся, пока их меньше числа ядер и IOPOOL_MAX_THREADS.
+class IoPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IoPool(QObject *parent = nullptr);
+    ~IoPool();
+
+    QThread *acquire();                             // наименее загруженный поток
+    void release(QThread *thread);
+
+    int threadCount() const;
+
+private:
+    typedef struct {
+        QThread *thread;
+        int users;
+    } Worker;
+
+    QVector<Worker> m_workers;
+    int m_maxThreads;
+};
+
+#endif // IOPOOL_H
@@ -0,0 +1,158 @@
+#include "latency.h"
+
+#include <QtAlgorithms>
+#include <cmath>
+
+#define SUB_COUNT       (1 << LATENCY_SUB_BITS)
+#define BUCKET_COUNT    ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) * SUB_COUNT)
+#define VALUE_MAX       ((qint64(1) << LATENCY_MAX_BITS) - 1)
+
+// LatencyHistogram
+
+// Значения меньше SUB_COUNT - точно, далее старшие LATENCY_SUB_BITS + 1 бит значения
+int LatencyHistogram::index(qint64 value) {
+    const quint64 v = quint64(qBound<qint64>(0, value, VALUE_MAX));
+    if (v < SUB_COUNT) return int(v);
+    const int msb = 63 - int(qCountLeadingZeroBits(v));
+    const int shift = msb - LATENCY_SUB_BITS;
+    return (shift + 1) * SUB_COUNT + int((v >> shift) - SUB_COUNT);
+}
+
+qint64 LatencyHistogram::lowest(int index) {
+    if (index < SUB_COUNT) return index;
+    const int shift = index / SUB_COUNT - 1;
+    return qint64(SUB_COUNT + index % SUB_COUNT) << shift;
+}
+
+void LatencyHistogram::record(qint64 value) {
+    if (m_counts.isEmpty()) m_counts.fill(0, BUCKET_COUNT);
+    m_counts[index(value)]++;
+    m_min = m_count ? qMin(m_min, value) : value;
+    m_max = m_count ? qMax(m_max, value) : value;
+    m_count++;
+}
+
+void LatencyHistogram::reset() {
+    m_counts.clear();
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::count() const {
+    return m_count;
+}
+
+qint64 LatencyHistogram::min() const {
+    return m_min;
+}
+
+qint64 LatencyHistogram::max() const {
+    return m_max;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const {
+    if (!m_count) return 0;
+    const qint64 target = qMax<qint64>(1, qint64(std::ceil(qBound(0.0, percent, 100.0) / 100.0 * m_count)));
+    qint64 total = 0;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        total += m_counts.at(i);
+        if (total >= target) {
+            // середина интервала, в пределах наблюдавшихся значений
+            const qint64 middle = (lowest(i) + lowest(i + 1) - 1) / 2;
+            return qBound(m_min, middle, m_max);
+        }
+    }
+    return m_max;
+}
+
+// LatencyMeter
+
+void LatencyMeter::setPattern(const QByteArray &pattern) {
+    m_pattern = pattern;
+    m_buffer.clear();
+}
+
+void LatencyMeter::setFramed(bool framed) {
+    m_framed = framed;
+}
+
+bool LatencyMeter::isMatching() const {
+    return m_framed || !m_pattern.isEmpty();
+}
+
+void LatencyMeter::setTimeout(qint64 timeout) {
+    m_timeout = qMax<qint64>(timeout, 1);
+}
+
+void LatencyMeter::sent(const QByteArray &data, qint64 timestamp) {
+    expire(timestamp);
+    if (!isMatching()) return;                      // ответ не распознать - и потерянным не считать
+    m_pending.push_back({entry(data), timestamp});
+}
+
+void LatencyMeter::received(const QByteArray &data, qint64 timestamp) {
+    expire(timestamp);
+    if (m_pending.empty()) return;
+    if (m_pattern.isEmpty()) {
+        if (!m_framed) return;
+        // первый принятый кадр - ответ на самый ранний запрос
+        const Request request = m_pending.front();
+        m_pending.pop_front();
+        m_entries[request.entry].histogram.record(timestamp - request.sent);
+        m_changed = true;
+        return;
+    }
+    m_buffer.append(data);
+    qsizetype pos;
+    while (!m_pending.empty() && (pos = m_buffer.indexOf(m_pattern)) >= 0) {
+        const Request request = m_pending.front();
+        m_pending.pop_front();
+        m_entries[request.entry].histogram.record(timestamp - request.sent);
+        m_buffer.remove(0, pos + m_pattern.size());
+        m_changed = true;
+    }
+    if (m_pending.empty()) {
+        m_buffer.clear();                           // ответы без запроса не копятся
+    } else if (m_buffer.size() > LATENCY_BUFFER) {
+        m_buffer.remove(0, m_buffer.size() - LATENCY_BUFFER);
+    }
+}
+
+void LatencyMeter::reset() {
+    m_entries.clear();
+    m_index.clear();
+    m_pending.clear();
+    m_buffer.clear();
+    m_changed = true;
+}
+
+const QVector<LatencyMeter::Entry> &LatencyMeter::entries() const {
+    return m_entries;
+}
+
+bool LatencyMeter::takeChanged() {
+    const bool changed = m_changed;
+    m_changed = false;
+    return changed;
+}
+
+void LatencyMeter::expire(qint64 now) {
+    while (!m_pending.empty() && (m_pending.front().sent + m_timeout <= now)) {
+        m_entries[m_pending.front().entry].lost++;
+        m_pending.pop_front();
+        m_changed = true;
+    }
+}
+
+int LatencyMeter::entry(const QByteArray &command) {
+    auto it = m_index.constFind(command);
+    if (it != m_index.cend()) return it.value();
+    // уникальные данные (вставка, перебор) не должны плодить гистограммы
+    const QByteArray key = (m_entries.size() < LATENCY_COMMANDS) ? command : QByteArray();
+    it = m_index.constFind(key);
+    if (it != m_index.cend()) return it.value();
+    m_entries.append({key, LatencyHistogram(), 0});
+    m_index.insert(key, m_entries.size() - 1);
+    return m_entries.size() - 1;
+}
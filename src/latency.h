@@ -0,0 +1,82 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <deque>
+
+#define LATENCY_SUB_BITS        7                   // 128 интервалов на октаву, погрешность < 1%
+#define LATENCY_MAX_BITS        40                  // до ~1100 с
+#define LATENCY_COMMANDS        32                  // команд с отдельной гистограммой, остальные - в общей
+#define LATENCY_BUFFER          4096                // байт приёма, хранимых для поиска образца
+
+// Гистограмма задержек в логарифмически-линейной шкале (как HdrHistogram):
+// октава значений делится на равные интервалы, поэтому относительная погрешность
+// одинакова и для микросекунд, и для секунд.
+class LatencyHistogram
+{
+public:
+    void record(qint64 value);                      // нс
+    void reset();
+
+    qint64 count() const;
+    qint64 min() const;
+    qint64 max() const;
+    qint64 percentile(double percent) const;        // 0..100
+
+private:
+    static int index(qint64 value);
+    static qint64 lowest(int index);
+
+    QVector<qint64> m_counts;                       // выделяется при первой записи
+    qint64 m_count = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+};
+
+// Задержка ответа: отправка сопоставляется с первым вхождением образца ответа,
+// а без образца - с первым принятым после неё кадром (только при разбиении приёма на кадры:
+// произвольный блок может быть и не ответом). Запросы без ответа дольше таймаута - потерянные.
+class LatencyMeter
+{
+public:
+    typedef struct {
+        QByteArray command;                         // пусто - прочие команды
+        LatencyHistogram histogram;
+        qint64 lost;
+    } Entry;
+
+    void setPattern(const QByteArray &pattern);     // пусто - кадр, если setFramed(true)
+    void setFramed(bool framed);                    // принятые блоки являются целыми кадрами
+    bool isMatching() const;                        // задан образец или кадры - ответ распознаётся
+    void setTimeout(qint64 timeout);                // нс
+
+    // timestamp - Timestamp::now() момента записи/чтения
+    void sent(const QByteArray &data, qint64 timestamp);
+    void received(const QByteArray &data, qint64 timestamp);
+    void reset();
+
+    const QVector<Entry> &entries() const;
+    bool takeChanged();                             // были изменения с прошлого вызова
+
+private:
+    typedef struct {
+        int entry;
+        qint64 sent;
+    } Request;
+
+    void expire(qint64 now);
+    int entry(const QByteArray &command);
+
+    QVector<Entry> m_entries;
+    QHash<QByteArray, int> m_index;
+    std::deque<Request> m_pending;                  // в порядке отправки
+    QByteArray m_pattern;
+    QByteArray m_buffer;
+    qint64 m_timeout = 1000000000;
+    bool m_framed = false;
+    bool m_changed = false;
+};
+
+#endif // LATENCY_H
@@ -0,0 +1,133 @@
+#include "linebuffer.h"
+
+#include <cstring>
+
+LineBuffer::LineBuffer(qsizetype capacity) {
+    setCapacity(capacity);
+}
+
+qsizetype LineBuffer::capacity() const {
+    return m_data.size();
+}
+
+void LineBuffer::setCapacity(qsizetype capacity) {
+    m_data = QByteArray(qMax<qsizetype>(capacity, 1), Qt::Uninitialized);
+    clear();
+}
+
+void LineBuffer::append(const QByteArray &data) {
+    append(data.constData(), data.size());
+}
+
+void LineBuffer::append(const char *data, qsizetype size) {
+    const qsizetype cap = capacity();
+    while (size > 0) {
+        const qsizetype piece = qMin(size, cap);
+        appendPiece(data, piece);
+        data += piece;
+        size -= piece;
+    }
+}
+
+void LineBuffer::appendPiece(const char *data, qsizetype size) {
+    const qsizetype cap = capacity();
+    const qsizetype free = cap - this->size();
+    if (size > free) drop(size - free);
+
+    // копирование в кольцо
+    const qsizetype offset = m_end % cap;
+    const qsizetype first = qMin(size, cap - offset);
+    memcpy(m_data.data() + offset, data, first);
+    if (first < size) memcpy(m_data.data(), data + first, size - first);
+
+    // индекс строк
+    for (qsizetype i = 0; i < size; ++i) {
+        const char c = data[i];
+        if (c != '\n' && c != '\r') continue;
+        const qint64 pos = m_end + i;
+        if (c == '\n' && m_cr && m_lines.back() == pos) {
+            m_lines.back() = pos + 1;               // "\r\n" - один разделитель
+        } else {
+            const qsizetype length = pos - m_lines.back();
+            while (!m_longest.empty() && m_longest.back().second <= length) m_longest.pop_back();
+            m_longest.emplace_back(m_lines.back(), length);
+            m_lines.push_back(pos + 1);
+        }
+        m_cr = (c == '\r');
+    }
+    if (size > 0) m_cr = (data[size - 1] == '\r');
+    m_end += size;
+}
+
+void LineBuffer::clear() {
+    m_begin = m_end = 0;
+    m_lines.clear();
+    m_lines.push_back(0);
+    m_dropped = 0;
+    m_longest.clear();
+    m_cr = false;
+}
+
+bool LineBuffer::isEmpty() const {
+    return m_end == m_begin;
+}
+
+qsizetype LineBuffer::size() const {
+    return m_end - m_begin;
+}
+
+qsizetype LineBuffer::lineCount() const {
+    return m_lines.size();
+}
+
+qint64 LineBuffer::droppedLines() const {
+    return m_dropped;
+}
+
+// Первая строка могла быть обрезана вытеснением, последняя ещё дополняется - обе считаются отдельно
+qsizetype LineBuffer::maxLineLength() const {
+    qsizetype result = qMax(lineLength(0), lineLength(lineCount() - 1));
+    if (!m_longest.empty()) result = qMax(result, m_longest.front().second);
+    return result;
+}
+
+qsizetype LineBuffer::lineLength(qsizetype line) const {
+    if (line < 0 || line >= lineCount()) return 0;
+    return lineEnd(line) - m_lines[line];
+}
+
+QByteArray LineBuffer::line(qsizetype line, qsizetype from, qsizetype length) const {
+    const qsizetype total = lineLength(line);
+    from = qBound<qsizetype>(0, from, total);
+    if (length < 0 || from + length > total) length = total - from;
+    QByteArray result(length, Qt::Uninitialized);
+    if (length > 0) copyOut(m_lines[line] + from, result.data(), length);
+    return result;
+}
+
+void LineBuffer::drop(qsizetype size) {
+    m_begin += size;
+    while (m_lines.size() > 1 && m_lines[1] <= m_begin) {
+        m_lines.pop_front();
+        m_dropped++;
+    }
+    if (m_lines.front() < m_begin) m_lines.front() = m_begin;
+    while (!m_longest.empty() && m_longest.front().first < m_begin) m_longest.pop_front(); // вытеснена или обрезана
+}
+
+void LineBuffer::copyOut(qint64 pos, char *dst, qsizetype size) const {
+    const qsizetype cap = capacity();
+    const qsizetype offset = pos % cap;
+    const qsizetype first = qMin(size, cap - offset);
+    memcpy(dst, m_data.constData() + offset, first);
+    if (first < size) memcpy(dst + first, m_data.constData(), size - first);
+}
+
+qint64 LineBuffer::lineEnd(qsizetype line) const {
+    const qint64 start = m_lines[line];
+    qint64 end = (line + 1 < lineCount()) ? m_lines[line + 1] : m_end;
+    const qsizetype cap = capacity();
+    if (end > start && m_data.at((end - 1) % cap) == '\n') end--;
+    if (end > start && m_data.at((end - 1) % cap) == '\r') end--;
+    return end;
+}
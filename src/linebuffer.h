@@ -0,0 +1,51 @@
+#ifndef LINEBUFFER_H
+#define LINEBUFFER_H
+
+#include <QByteArray>
+#include <deque>
+#include <utility>
+
+#define LINEBUFFER_DEFAULT_CAPACITY     (16 * 1024 * 1024)
+
+// Кольцевой буфер фиксированного размера с индексом строк.
+// Разделители строк: '\n', '\r', "\r\n". Добавление - O(1) независимо от объёма истории,
+// при переполнении вытесняются самые старые данные.
+class LineBuffer
+{
+public:
+    explicit LineBuffer(qsizetype capacity = LINEBUFFER_DEFAULT_CAPACITY);
+
+    qsizetype capacity() const;
+    void setCapacity(qsizetype capacity);           // очищает буфер
+
+    void append(const char *data, qsizetype size);
+    void append(const QByteArray &data);
+    void clear();
+
+    bool isEmpty() const;
+    qsizetype size() const;                         // байт в буфере
+    qsizetype lineCount() const;                    // строк в буфере
+    qint64 droppedLines() const;                    // вытеснено строк с момента очистки
+    qsizetype maxLineLength() const;                // среди строк в буфере, вытесненные не учитываются
+
+    qsizetype lineLength(qsizetype line) const;     // без разделителя
+    QByteArray line(qsizetype line, qsizetype from = 0, qsizetype length = -1) const;
+
+private:
+    void appendPiece(const char *data, qsizetype size);
+    void drop(qsizetype size);
+    void copyOut(qint64 pos, char *dst, qsizetype size) const;
+    qint64 lineEnd(qsizetype line) const;
+
+    QByteArray m_data;
+    qint64 m_begin = 0;                             // абсолютная позиция первого байта
+    qint64 m_end = 0;                               // абсолютная позиция за последним байтом
+    std::deque<qint64> m_lines;                     // абсолютные позиции начала строк
+    qint64 m_dropped = 0;
+    // завершённые строки (начало, длина) по убыванию длины: в начале - самая длинная из оставшихся,
+    // каждая строка добавляется и вытесняется один раз
+    std::deque<std::pair<qint64, qsizetype>> m_longest;
+    bool m_cr = false;                              // последний байт - '\r'
+};
+
+#endif // LINEBUFFER_H
@@ -0,0 +1,204 @@
+#include "logfile.h"
+
+#include <QThread>
+#include <cstring>
+
+LogFile::Mapping::~Mapping() {
+    if (data) file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+}
+
+LogFile::LogFile(QObject *parent): QObject(parent) {
+    for (Page &page : m_pages) page = {-1, 0, {}};
+}
+
+LogFile::~LogFile() {
+    close();
+}
+
+bool LogFile::open(const QString &fileName) {
+    close();
+    std::shared_ptr<Mapping> mapping = std::make_shared<Mapping>();
+    mapping->file.setFileName(fileName);
+    if (!mapping->file.open(QIODevice::ReadOnly)) {
+        m_errorString = mapping->file.errorString();
+        return false;
+    }
+    mapping->size = mapping->file.size();
+    if (mapping->size > 0) {
+        mapping->data = reinterpret_cast<const char *>(mapping->file.map(0, mapping->size));
+        if (!mapping->data) {
+            m_errorString = mapping->file.errorString();
+            return false;
+        }
+    }
+    m_mapping = mapping;
+    m_fileName = fileName;
+    m_errorString.clear();
+
+    const MappingPtr shared = m_mapping;
+    const int generation = m_generation.load(std::memory_order_relaxed);
+    m_thread = QThread::create([this, shared, generation]() { index(shared, generation); });
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void LogFile::close() {
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+    if (m_thread) {
+        m_thread->wait();                           // не дольше просмотра LOGFILE_BATCH байт
+        delete m_thread;
+        m_thread = nullptr;
+    }
+    m_mapping.reset();
+    m_fileName.clear();
+    m_checkpoints.clear();
+    m_checkpoints.squeeze();
+    m_lines = 0;
+    m_indexedSize = 0;
+    m_maxLineLength = 0;
+    m_indexed = false;
+    for (Page &page : m_pages) page = {-1, 0, {}};
+}
+
+bool LogFile::isOpen() const {
+    return bool(m_mapping);
+}
+
+QString LogFile::fileName() const {
+    return m_fileName;
+}
+
+QString LogFile::errorString() const {
+    return m_errorString;
+}
+
+LogFile::MappingPtr LogFile::mapping() const {
+    return m_mapping;
+}
+
+qint64 LogFile::size() const {
+    return m_mapping ? m_mapping->size : 0;
+}
+
+qint64 LogFile::indexedSize() const {
+    return m_indexedSize;
+}
+
+bool LogFile::isIndexed() const {
+    return m_indexed;
+}
+
+qsizetype LogFile::lineCount() const {
+    return m_lines;
+}
+
+qsizetype LogFile::maxLineLength() const {
+    return m_maxLineLength;
+}
+
+qsizetype LogFile::lineLength(qsizetype line) const {
+    if (line < 0 || line >= m_lines) return 0;
+    const std::vector<qint64> &starts = page(line / LOGFILE_PAGE_LINES);
+    const size_t k = size_t(line % LOGFILE_PAGE_LINES);
+    return lineEnd(m_mapping->data, starts[k], starts[k + 1]) - starts[k];
+}
+
+QByteArray LogFile::line(qsizetype line, qsizetype from, qsizetype length) const {
+    const qsizetype total = lineLength(line);
+    from = qBound<qsizetype>(0, from, total);
+    if (length < 0 || from + length > total) length = total - from;
+    if (length <= 0) return QByteArray();
+    const std::vector<qint64> &starts = page(line / LOGFILE_PAGE_LINES);
+    return QByteArray(m_mapping->data + starts[size_t(line % LOGFILE_PAGE_LINES)] + from, length);
+}
+
+qint64 LogFile::nextLine(const char *data, qint64 size, qint64 pos, qint64 &nl) {
+    if (pos >= size) return -1;
+    if (nl < pos) {
+        const void *found = std::memchr(data + pos, '\n', size_t(size - pos));
+        nl = found ? static_cast<const char *>(found) - data : size;
+    }
+    const void *found = std::memchr(data + pos, '\r', size_t(nl - pos));
+    if (found) {
+        const qint64 cr = static_cast<const char *>(found) - data;
+        return (cr + 1 < size && data[cr + 1] == '\n') ? cr + 2 : cr + 1; // "\r\n" - один разделитель
+    }
+    return (nl < size) ? nl + 1 : -1;
+}
+
+qint64 LogFile::lineEnd(const char *data, qint64 start, qint64 next) {
+    qint64 end = next;
+    if (end > start && data[end - 1] == '\n') end--;
+    if (end > start && data[end - 1] == '\r') end--;
+    return end;
+}
+
+void LogFile::index(const MappingPtr &mapping, int generation) {
+    const char *data = mapping->data;
+    const qint64 size = mapping->size;
+    QVector<qint64> checkpoints;
+    qsizetype lines = 0;
+    qsizetype maxLength = 0;
+    qint64 pos = 0;
+    qint64 nl = -1;
+    qint64 reported = 0;
+    for (;;) {
+        if (lines % LOGFILE_PAGE_LINES == 0) {
+            checkpoints.append(pos);
+            // передаются только целые страницы: их строки уже не изменятся
+            if (pos - reported >= LOGFILE_BATCH) {
+                if (m_generation.load(std::memory_order_acquire) != generation) return;
+                const qsizetype done = lines;
+                const qint64 bytes = pos;
+                QMetaObject::invokeMethod(this, [=]() { indexed(generation, checkpoints, done, bytes, maxLength, false); }, Qt::QueuedConnection);
+                checkpoints.clear();
+                reported = pos;
+            }
+        }
+        const qint64 next = nextLine(data, size, pos, nl);
+        maxLength = qMax<qsizetype>(maxLength, lineEnd(data, pos, (next < 0) ? size : next) - pos);
+        ++lines;
+        if (next < 0) break;
+        pos = next;
+    }
+    QMetaObject::invokeMethod(this, [=]() { indexed(generation, checkpoints, lines, size, maxLength, true); }, Qt::QueuedConnection);
+}
+
+void LogFile::indexed(int generation, const QVector<qint64> &checkpoints, qsizetype lines, qint64 bytes, qsizetype maxLineLength, bool done) {
+    if (generation != m_generation.load(std::memory_order_relaxed)) return; // файл уже закрыт
+    m_checkpoints.append(checkpoints);
+    m_lines = lines;
+    m_indexedSize = bytes;
+    m_maxLineLength = maxLineLength;
+    m_indexed = done;
+    emit indexChanged();
+}
+
+const std::vector<qint64> &LogFile::page(qsizetype number) const {
+    Page *page = &m_pages.front();
+    for (Page &cached : m_pages) {
+        if (cached.number == number) {
+            cached.used = ++m_pageClock;
+            return cached.starts;
+        }
+        if (cached.used < page->used) page = &cached;
+    }
+
+    // вытесняется давно не использованная страница; просмотр - не дальше начала следующей
+    const char *data = m_mapping->data;
+    const qint64 size = (number + 1 < m_checkpoints.size()) ? m_checkpoints.at(number + 1) : m_mapping->size;
+    const qsizetype count = qMin<qsizetype>(LOGFILE_PAGE_LINES, m_lines - number * LOGFILE_PAGE_LINES);
+    page->number = number;
+    page->used = ++m_pageClock;
+    page->starts.clear();
+    qint64 pos = m_checkpoints.at(number);
+    qint64 nl = -1;
+    page->starts.push_back(pos);
+    for (qsizetype i = 0; i < count; ++i) {
+        const qint64 next = nextLine(data, size, pos, nl);
+        page->starts.push_back((next < 0) ? size : next);
+        if (next < 0) break;
+        pos = next;
+    }
+    return page->starts;
+}
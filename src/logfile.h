@@ -0,0 +1,91 @@
+#ifndef LOGFILE_H
+#define LOGFILE_H
+
+#include <QObject>
+#include <QFile>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QThread;
+
+#define LOGFILE_PAGE_LINES      1024                // строк между опорными точками индекса
+#define LOGFILE_PAGE_CACHE      4                   // страниц с началами всех строк
+#define LOGFILE_BATCH           (16 * 1024 * 1024)  // байт просмотра между передачами индекса
+
+// Просмотр файла без загрузки в память: файл отображается в адресное пространство,
+// индекс строк строится в фоновом потоке и хранит начало каждой LOGFILE_PAGE_LINES-й строки.
+// Начала строк страницы находятся по отображению при первом обращении к ней,
+// поэтому расход памяти почти не зависит от размера файла. Разделители строк - как в LineBuffer.
+class LogFile : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Отображение файла: общее с потоками индексации и поиска, освобождается последним из них
+    struct Mapping {
+        ~Mapping();
+        QFile file;
+        const char *data = nullptr;
+        qint64 size = 0;
+    };
+
+    typedef std::shared_ptr<const Mapping> MappingPtr;
+
+    explicit LogFile(QObject *parent = nullptr);
+    ~LogFile();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+    MappingPtr mapping() const;
+
+    qint64 size() const;
+    qint64 indexedSize() const;                     // байт от начала файла, строки которых в индексе
+    bool isIndexed() const;
+    qsizetype lineCount() const;                    // строк в индексе, растёт до конца индексации
+    qsizetype maxLineLength() const;
+
+    qsizetype lineLength(qsizetype line) const;     // без разделителя
+    QByteArray line(qsizetype line, qsizetype from = 0, qsizetype length = -1) const;
+
+    // Начало строки, следующей за строкой с началом в pos; -1 - строка последняя.
+    // nl - позиция ближайшего '\n' между вызовами (начальное значение -1): файл без '\n' просматривается один раз
+    static qint64 nextLine(const char *data, qint64 size, qint64 pos, qint64 &nl);
+    static qint64 lineEnd(const char *data, qint64 start, qint64 next); // next - начало следующей строки или конец файла
+
+signals:
+    void indexChanged();
+
+private:
+    typedef struct {
+        qsizetype number;                           // -1 - свободна
+        quint64 used;
+        std::vector<qint64> starts;                 // строк страницы + 1: начало следующей строки или конец файла
+    } Page;
+
+    void index(const MappingPtr &mapping, int generation); // поток индексации
+    void indexed(int generation, const QVector<qint64> &checkpoints, qsizetype lines, qint64 bytes, qsizetype maxLineLength, bool done);
+    const std::vector<qint64> &page(qsizetype number) const;
+
+    MappingPtr m_mapping;
+    QString m_fileName;
+    QString m_errorString;
+    QThread *m_thread = nullptr;
+    std::atomic<int> m_generation{0};               // смена - индексация прекращается, её результаты отбрасываются
+
+    QVector<qint64> m_checkpoints;                  // начало строки k * LOGFILE_PAGE_LINES
+    qsizetype m_lines = 0;
+    qint64 m_indexedSize = 0;
+    qsizetype m_maxLineLength = 0;
+    bool m_indexed = false;
+
+    mutable std::array<Page, LOGFILE_PAGE_CACHE> m_pages;
+    mutable quint64 m_pageClock = 0;
+};
+
+#endif // LOGFILE_H
@@ -1,5 +1,5 @@
 #include <QApplication>
-#include "mainwindow.h"
+#include "sessions.h"
 
 int main(int argc, char *argv[]) {
     QCoreApplication::setOrganizationName(APP_NAME);
@@ -7,7 +7,7 @@ int main(int argc, char *argv[]) {
     QCoreApplication::setApplicationVersion(APP_VERSION);
 
     QApplication a(argc, argv);
-    MainWindow w;
+    SessionsWindow w;
     w.show();
     return a.exec();
 }
@@ -2,26 +2,58 @@
 #include "ui_mainwindow.h"
 #include "console.h"
 #include "settings.h"
+#include "iopool.h"
 
 #include <QLabel>
 #include <QLineEdit>
 #include <QToolButton>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QAction>
 #include <QKeySequence>
 #include <QMessageBox>
 #include <QTimer>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QScrollBar>
+#include <QStandardPaths>
 #include <QClipboard>
 #include <QMimeData>
 #include <QFontDialog>
-#include <QDataStream>
+#include <QDateTime>
+#include <QThread>
+#include <QLocale>
+#include <QTime>
+#include <QElapsedTimer>
+#include <QSignalBlocker>
+#include <QTableWidgetItem>
+#include <QApplication>
 
 #define DEFAULT_TIMEOUT_WRITE               5000
 #define DEFAULT_HOST                        "localhost"
 #define DEFAULT_PORT                        2000
-#define DEFAULT_SERIAL_SIGNALS_INTERVAL     100
 #define DEFAULT_LINEFEED_CHAR               13
+#define DEFAULT_SCROLLBACK                  16
+#define DEFAULT_REFRESH_RATE                60
+#define DEFAULT_FRAME_DELIMITER             "\\0D\\0A"
+#define DEFAULT_FRAME_GAP                   20
+#define DEFAULT_SESSION_LOG_SEGMENT_SIZE    64      // МБ
+#define DEFAULT_SESSION_LOG_SEGMENT_TIME    60      // мин
+#define DEFAULT_SESSION_LOG_KEEP            100
+
+#define REPLAY_BUDGET                       15      // мс на шаг загрузки захвата
+#define REPLAY_PAGE                         (1024 * 1024) // байт данных захвата на страницу вывода
+#define SAVE_BLOCK                          (1024 * 1024) // байт, копирование открытого файла
+#define LATENCY_REFRESH                     250     // мс, обновление таблицы задержек
+#define BRIDGE_REFRESH                      500     // мс, обновление счётчиков моста
+#define STATISTICS_REFRESH                  500     // мс, отсчёт статистики канала
+#define STATISTICS_PEAK_ROWS                8       // tableWidgetStatistics: скорости и очереди - с пиком
+#define STATISTICS_BER_ROW                  17      // tableWidgetStatistics: дробное значение
+#define RESPONDER_MAX_DELAY                 3600000 // мс
+
+#define SCHEDULER_ENUMERATE                 -1      // идентификатор перебора в планировщике
+#define ENUMERATE_BY_RESPONSE               1       // comboBoxEnumerateMode: перебор по ответу
 
 #define COMMAND_HOT_COUNT                   10
 
@@ -42,6 +74,18 @@ const char* strFrom = "From";
 const char* strTo = "To";
 const char* strInterval = "Interval";
 const char* strCrc = "Crc";
+const char* strMode = "Mode";
+const char* strResponse = "Response";
+const char* strTimeout = "Timeout";
+const char* strLatency = "Latency";
+const char* strEnabled = "Enabled";
+const char* strBridge = "Bridge";
+const char* strTap = "Tap";
+const char* strResponder = "Responder";
+const char* strPatternNum = "Pattern%1";
+const char* strReplyNum = "Reply%1";
+const char* strDelayNum = "Delay%1";
+const char* strEnabledNum = "Enabled%1";
 const char* strCommands = "Commands";
 const char* strCount = "Count";
 const char* strValueNum = "Value%1";
@@ -65,16 +109,35 @@ const char* strLinefeed = "Linefeed";
 const char* strLinefeedChar = "LinefeedChar";
 const char* strLocalEcho = "LocalEcho";
 const char* strTimeStamp = "TimeStamp";
+const char* strTimeDelta = "TimeDelta";
+const char* strGapThreshold = "GapThreshold";
+const char* strScrollback = "Scrollback";
+const char* strRefreshRate = "RefreshRate";
+const char* strFraming = "Framing";
+const char* strFrameDelimiter = "FrameDelimiter";
+const char* strFrameLengthOffset = "FrameLengthOffset";
+const char* strFrameLengthSize = "FrameLengthSize";
+const char* strFrameLengthBigEndian = "FrameLengthBigEndian";
+const char* strFrameLengthAdjust = "FrameLengthAdjust";
+const char* strFrameGap = "FrameGap";
+const char* strFrameCrc = "FrameCrc";
+const char* strSessionLog = "SessionLog";
+const char* strSessionLogDir = "SessionLogDir";
+const char* strSessionLogSegmentSize = "SessionLogSegmentSize";
+const char* strSessionLogSegmentTime = "SessionLogSegmentTime";
+const char* strSessionLogKeep = "SessionLogKeep";
+const char* strSessionLogCompress = "SessionLogCompress";
 const char* strWindow = "Window";
 const char* strState = "State";
 const char* strFont = "Font";
 const char* strDirectory = "Directory";
 const char* strConnected = "Connected";
+const char* strSession = "Session%1";
 
 const QString statusSeparator = QStringLiteral(" - ");
 
 
-MainWindow::MainWindow(QWidget *parent):
+MainWindow::MainWindow(IoPool *pool, int session, QWidget *parent):
     QMainWindow(parent),
     m_ui(new Ui::MainWindow),
     m_console(new Console(this)),
@@ -88,17 +151,30 @@ MainWindow::MainWindow(QWidget *parent):
     m_labelLedRi(new LabelLed(this, "RI", false)),
     m_labelLedStd(new LabelLed(this, "ST", false)),
     m_labelLedSrd(new LabelLed(this, "SR", false)),
-    m_timerSerialSignals(new QTimer(this)),
-    m_timerWrite(new QTimer(this)),
-    m_timerAddr(new QTimer(this)),
-    m_serial(new QSerialPort(this)),
-    m_tcp(new QTcpSocket(this)),
-    m_udp(new QUdpSocket(this)),
-    m_crc(new Crc(this))
+    m_session(session),
+    m_scheduler(new Scheduler(this)),
+    m_pool(pool),
+    m_threadIo(pool->acquire()),
+    m_transport(new Transport),
+    m_accumulator(new Accumulator(this)),
+    m_crc(new Crc(this)),
+    m_fileSender(new FileSender(this)),
+    m_enumerator(new Enumerator(this)),
+    m_timerReplay(new QTimer(this)),
+    m_timerLatency(new QTimer(this)),
+    m_bridge(new Bridge),
+    m_timerBridge(new QTimer(this)),
+    m_timerStatistics(new QTimer(this)),
+    m_sessionLog(new SessionLog(session, this))
 {
     m_ui->setupUi(this);
     setCentralWidget(m_console);
 
+    // io thread, общий с другими сессиями
+    m_transport->moveToThread(m_threadIo);
+    m_bridge->moveToThread(m_threadIo);
+    QMetaObject::invokeMethod(m_transport, [=]() { m_transport->setSessionLog(m_sessionLog); });
+
     m_ui->actionConnect->setEnabled(true);
     m_ui->actionDisconnect->setEnabled(false);
 
@@ -131,12 +207,10 @@ MainWindow::MainWindow(QWidget *parent):
     m_labelLedStd->setStatusTip(tr("Сигнал 'Secondary Transmitted Data'"));
     m_labelLedSrd->setStatusTip(tr("Сигнал 'Secondary Received Data'"));
 
-    connect(m_serial, &QSerialPort::dataTerminalReadyChanged, m_labelLedDtr, &LabelLed::setLed);
-    connect(m_serial, &QSerialPort::dataTerminalReadyChanged, this, &MainWindow::readSerialSignals);
-    connect(m_serial, &QSerialPort::requestToSendChanged, m_labelLedRts, &LabelLed::setLed);
-    connect(m_serial, &QSerialPort::requestToSendChanged, this, &MainWindow::readSerialSignals);
-    connect(m_timerSerialSignals, &QTimer::timeout, this, &MainWindow::readSerialSignals);
-    m_timerSerialSignals->setInterval(DEFAULT_SERIAL_SIGNALS_INTERVAL);
+    connect(m_transport, &Transport::dataTerminalReadyChanged, m_labelLedDtr, &LabelLed::setLed);
+    connect(m_transport, &Transport::requestToSendChanged, m_labelLedRts, &LabelLed::setLed);
+    connect(m_transport, &Transport::pinoutSignalsChanged, this, &MainWindow::readSerialSignals);
+    connect(m_transport, &Transport::pinoutSignalsChanged, m_fileSender, &FileSender::setPinoutSignals);
 
     // dock
     m_ui->dockWidgetEnumerate->toggleViewAction()->setIcon(QIcon(":/ico/enumeration.ico"));
@@ -149,9 +223,33 @@ MainWindow::MainWindow(QWidget *parent):
     m_ui->dockWidgetCommands->toggleViewAction()->setToolTip(QString(tr("Отобразить/скрыть панель команд (%1)")).arg(m_ui->dockWidgetCommands->toggleViewAction()->shortcut().toString()));
     m_ui->dockWidgetCommands->toggleViewAction()->setStatusTip(m_ui->dockWidgetCommands->toggleViewAction()->toolTip());
 
+    m_ui->dockWidgetLatency->toggleViewAction()->setIcon(QIcon(":/ico/send.ico"));
+    m_ui->dockWidgetLatency->toggleViewAction()->setShortcut(QKeySequence("Ctrl+F5"));
+    m_ui->dockWidgetLatency->toggleViewAction()->setToolTip(QString(tr("Отобразить/скрыть панель задержки ответа (%1)")).arg(m_ui->dockWidgetLatency->toggleViewAction()->shortcut().toString()));
+    m_ui->dockWidgetLatency->toggleViewAction()->setStatusTip(m_ui->dockWidgetLatency->toggleViewAction()->toolTip());
+
+    m_ui->dockWidgetBridge->toggleViewAction()->setIcon(QIcon(":/ico/connect.ico"));
+    m_ui->dockWidgetBridge->toggleViewAction()->setShortcut(QKeySequence("Ctrl+F6"));
+    m_ui->dockWidgetBridge->toggleViewAction()->setToolTip(QString(tr("Отобразить/скрыть панель моста порт-сеть (%1)")).arg(m_ui->dockWidgetBridge->toggleViewAction()->shortcut().toString()));
+    m_ui->dockWidgetBridge->toggleViewAction()->setStatusTip(m_ui->dockWidgetBridge->toggleViewAction()->toolTip());
+
+    m_ui->dockWidgetStatistics->toggleViewAction()->setIcon(QIcon(":/ico/about.ico"));
+    m_ui->dockWidgetStatistics->toggleViewAction()->setShortcut(QKeySequence("Ctrl+F7"));
+    m_ui->dockWidgetStatistics->toggleViewAction()->setToolTip(QString(tr("Отобразить/скрыть панель статистики канала (%1)")).arg(m_ui->dockWidgetStatistics->toggleViewAction()->shortcut().toString()));
+    m_ui->dockWidgetStatistics->toggleViewAction()->setStatusTip(m_ui->dockWidgetStatistics->toggleViewAction()->toolTip());
+
+    m_ui->dockWidgetResponder->toggleViewAction()->setIcon(QIcon(":/ico/loop.png"));
+    m_ui->dockWidgetResponder->toggleViewAction()->setShortcut(QKeySequence("Ctrl+F8"));
+    m_ui->dockWidgetResponder->toggleViewAction()->setToolTip(QString(tr("Отобразить/скрыть панель автоответчика (%1)")).arg(m_ui->dockWidgetResponder->toggleViewAction()->shortcut().toString()));
+    m_ui->dockWidgetResponder->toggleViewAction()->setStatusTip(m_ui->dockWidgetResponder->toggleViewAction()->toolTip());
+
     // toolbar
     m_ui->toolBar->addAction(m_ui->dockWidgetEnumerate->toggleViewAction());
     m_ui->toolBar->addAction(m_ui->dockWidgetCommands->toggleViewAction());
+    m_ui->toolBar->addAction(m_ui->dockWidgetLatency->toggleViewAction());
+    m_ui->toolBar->addAction(m_ui->dockWidgetBridge->toggleViewAction());
+    m_ui->toolBar->addAction(m_ui->dockWidgetStatistics->toggleViewAction());
+    m_ui->toolBar->addAction(m_ui->dockWidgetResponder->toggleViewAction());
 
     // menu
     m_ui->toolBar->toggleViewAction()->setText(tr("Панель инструментов"));
@@ -175,6 +273,10 @@ MainWindow::MainWindow(QWidget *parent):
     m_ui->menuView->addSeparator();
     m_ui->menuView->addAction(m_ui->dockWidgetEnumerate->toggleViewAction());
     m_ui->menuView->addAction(m_ui->dockWidgetCommands->toggleViewAction());
+    m_ui->menuView->addAction(m_ui->dockWidgetLatency->toggleViewAction());
+    m_ui->menuView->addAction(m_ui->dockWidgetBridge->toggleViewAction());
+    m_ui->menuView->addAction(m_ui->dockWidgetStatistics->toggleViewAction());
+    m_ui->menuView->addAction(m_ui->dockWidgetResponder->toggleViewAction());
     m_ui->menuView->addSeparator();
     m_ui->menuView->addAction(m_ui->actionSelectFont);
 
@@ -185,6 +287,7 @@ MainWindow::MainWindow(QWidget *parent):
     setToolStatusTip(m_ui->actionCopy);
     setToolStatusTip(m_ui->actionPaste);
     setToolStatusTip(m_ui->actionSelectAll);
+    setToolStatusTip(m_ui->actionCapture);
     setToolStatusTip(m_ui->actionFind);
     setToolStatusTip(m_ui->actionClear);
     setToolStatusTip(m_ui->actionSelectFont);
@@ -192,6 +295,8 @@ MainWindow::MainWindow(QWidget *parent):
     setToolStatusTip(m_ui->actionDisconnect);
     setToolStatusTip(m_ui->actionSettings);
     setToolStatusTip(m_ui->actionSendFile);
+    setToolStatusTip(m_ui->actionSendFilePause);
+    setToolStatusTip(m_ui->actionSendFileCancel);
     setToolStatusTip(m_ui->actionSendBreak);
     setToolStatusTip(m_ui->actionDtr);
     setToolStatusTip(m_ui->actionRts);
@@ -199,29 +304,47 @@ MainWindow::MainWindow(QWidget *parent):
 
     connect(m_ui->actionOpen, &QAction::triggered, this, &MainWindow::openFile);
     connect(m_ui->actionSaveAs, &QAction::triggered, this, &MainWindow::saveFileAs);
-    connect(m_ui->actionQuit, &QAction::triggered, this, &MainWindow::close);
+    connect(m_ui->actionCapture, &QAction::toggled, this, &MainWindow::setCapture);
+    connect(m_timerReplay, &QTimer::timeout, this, &MainWindow::replayCapture);
+    connect(m_console->verticalScrollBar(), &QScrollBar::valueChanged, this, &MainWindow::replayNextPage);
+    connect(m_ui->actionQuit, &QAction::triggered, qApp, &QApplication::closeAllWindows);
 
     connect(m_ui->actionConnect, &QAction::triggered, this, &MainWindow::open);
     connect(m_ui->actionDisconnect, &QAction::triggered, this, &MainWindow::close);
     connect(m_ui->actionSettings, &QAction::triggered, this, &MainWindow::showSettings);
     connect(m_ui->actionSendFile, &QAction::triggered, this, &MainWindow::sendFile);
+    connect(m_ui->actionSendFilePause, &QAction::toggled, this, [=](bool checked) {
+        if (checked) m_fileSender->pause(); else m_fileSender->resume();
+    });
+    connect(m_ui->actionSendFileCancel, &QAction::triggered, m_fileSender, &FileSender::cancel);
 
     connect(m_ui->actionAbout, &QAction::triggered, this, &MainWindow::about);
 
     connect(m_ui->actionClear, &QAction::triggered, m_console, &Console::clear);
+    connect(m_ui->actionClear, &QAction::triggered, this, [=]() {
+        m_timerReplay->stop();                      // оставшиеся страницы захвата не выводятся
+        m_replay.close();
+    });
     connect(m_ui->actionSelectFont, &QAction::triggered, this, &MainWindow::selectFont);
     connect(m_ui->actionSelectAll, &QAction::triggered, m_console, &Console::selectAll);
     connect(m_ui->actionFind, &QAction::triggered, m_find, &DialogFind::show);
     connect(m_console, &Console::textChanged, this, [=]() {
-        bool consoleIsEmpty = m_console->document()->isEmpty();
+        bool consoleIsEmpty = m_console->isEmpty();
         m_ui->actionSelectAll->setEnabled(!consoleIsEmpty);
         m_ui->actionFind->setEnabled(!consoleIsEmpty);
         m_ui->actionClear->setEnabled(!consoleIsEmpty);
         m_ui->actionSaveAs->setEnabled(!consoleIsEmpty);
     });
+    connect(m_console, &Console::logIndexed, this, [=](qint64 indexed, qint64 size, bool done) {
+        if (done) {
+            m_ui->statusBar->showMessage(tr("Файл открыт: %1").arg(QLocale().formattedDataSize(size)));
+        } else {
+            m_ui->statusBar->showMessage(tr("Индексация файла: %1%").arg(indexed * 100 / qMax<qint64>(size, 1)));
+        }
+    });
 
     // copy
-    connect(m_console, &QPlainTextEdit::copyAvailable, m_ui->actionCopy, &QAction::setEnabled);
+    connect(m_console, &Console::copyAvailable, m_ui->actionCopy, &QAction::setEnabled);
     connect(m_ui->actionCopy, &QAction::triggered, m_console, &Console::copy);
 
     // paste
@@ -239,40 +362,43 @@ MainWindow::MainWindow(QWidget *parent):
 
     // console
     connect(m_console, &Console::getData, this, &MainWindow::writeData);
+    connect(m_accumulator, &Accumulator::ready, m_console, &Console::putData);
+
+    // file
+    connect(m_fileSender, &FileSender::writeData, this, &MainWindow::writeData);
+    connect(m_fileSender, &FileSender::progress, this, &MainWindow::sendFileProgress);
+    connect(m_fileSender, &FileSender::finished, this, &MainWindow::sendFileFinished);
+    connect(m_transport, &Transport::bytesWritten, m_fileSender, &FileSender::bytesWritten);
+
+    // scheduler: циклические отправки идут в транспорт напрямую, минуя поток GUI
+    connect(m_scheduler, &Scheduler::send, m_transport, &Transport::write);
+
+    // transport
+    connect(m_transport, &Transport::opened, this, &MainWindow::connected);
+    connect(m_transport, &Transport::closed, this, &MainWindow::disconnected);
+    connect(m_transport, &Transport::readyRead, this, &MainWindow::transportReadyRead);
+    connect(m_transport, &Transport::openError, this, &MainWindow::openError);
+    connect(m_transport, &Transport::captureError, this, &MainWindow::captureError);
+    connect(m_sessionLog, &SessionLog::error, this, &MainWindow::sessionLogError);
+    connect(m_transport, &Transport::writeError, m_fileSender, &FileSender::cancel);
+    connect(m_transport, &Transport::writeError, this, &MainWindow::showWriteError);
+    connect(m_transport, &Transport::errorOccurred, this, &MainWindow::transportErrorOccurred);
+    connect(m_transport, &Transport::socketStateChanged, this, &MainWindow::socketStateUpdate);
+    connect(m_transport, &Transport::socketErrorOccurred, this, &MainWindow::socketErrorOccurred);
 
     // serial
-    connect(m_serial, &QSerialPort::errorOccurred, this, &MainWindow::serialErrorOccurred);
-    connect(m_serial, &QSerialPort::readyRead, this, &MainWindow::serialReadyRead);
-    connect(m_serial, &QSerialPort::bytesWritten, this, &MainWindow::bytesWritten);
-
-    connect(m_serial, &QSerialPort::dataTerminalReadyChanged, m_ui->actionDtr, &QAction::setChecked);
-    connect(m_ui->actionDtr, &QAction::toggled, m_serial, &QSerialPort::setDataTerminalReady);
-    connect(m_serial, &QSerialPort::requestToSendChanged, m_ui->actionRts, &QAction::setChecked);
-    connect(m_ui->actionRts, &QAction::toggled, m_serial, &QSerialPort::setRequestToSend);
+    connect(m_transport, &Transport::dataTerminalReadyChanged, m_ui->actionDtr, &QAction::setChecked);
+    connect(m_ui->actionDtr, &QAction::toggled, this, [=](bool checked) {
+        QMetaObject::invokeMethod(m_transport, [=]() { m_transport->setDataTerminalReady(checked); });
+    });
+    connect(m_transport, &Transport::requestToSendChanged, m_ui->actionRts, &QAction::setChecked);
+    connect(m_ui->actionRts, &QAction::toggled, this, [=](bool checked) {
+        QMetaObject::invokeMethod(m_transport, [=]() { m_transport->setRequestToSend(checked); });
+    });
     connect(m_ui->actionSendBreak, &QAction::triggered, this, [=](){
-        if (m_serial->isOpen()) writeData(QByteArray(1,0));
+        if ((m_settings.type == Connection::Serial) && isOpen()) writeData(QByteArray(1,0));
     });
 
-    // tcp
-    connect(m_tcp, &QTcpSocket::connected, this, &MainWindow::connected);
-    connect(m_tcp, &QTcpSocket::disconnected, this, &MainWindow::disconnected);
-    connect(m_tcp, &QTcpSocket::stateChanged, this, &MainWindow::socketStateUpdate);
-    connect(m_tcp, &QTcpSocket::errorOccurred, this, &MainWindow::socketErrorOccurred);
-    connect(m_tcp, &QTcpSocket::readyRead, this, &MainWindow::socketReadyRead);
-    connect(m_tcp, &QTcpSocket::bytesWritten, this, &MainWindow::bytesWritten);
-
-    // udp
-    connect(m_udp, &QUdpSocket::connected, this, &MainWindow::connected);
-    connect(m_udp, &QUdpSocket::disconnected, this, &MainWindow::disconnected);
-    connect(m_udp, &QUdpSocket::stateChanged, this, &MainWindow::socketStateUpdate);
-    //connect(m_udp, &QUdpSocket::errorOccurred, this, &MainWindow::socketErrorOccurred);
-    connect(m_udp, &QUdpSocket::readyRead, this, &MainWindow::udpReadyRead);
-    connect(m_udp, &QUdpSocket::bytesWritten, this, &MainWindow::bytesWritten);
-
-    // write timer
-    connect(m_timerWrite, &QTimer::timeout, this, &MainWindow::writeTimeout);
-    m_timerWrite->setSingleShot(true);
-
     // dock commands
     m_ui->labelNum->setToolTip(tr("Номер команды"));
     m_ui->labelNum->setStatusTip(m_ui->labelNum->toolTip());
@@ -294,6 +420,7 @@ MainWindow::MainWindow(QWidget *parent):
 
     // commands
     QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    beginSession(settings);
     settings.beginGroup(strCommands);
     m_commandControls.resize(settings.value(strCount, COMMAND_HOT_COUNT).toUInt());
     settings.endGroup();
@@ -315,8 +442,9 @@ MainWindow::MainWindow(QWidget *parent):
         m_commandControls[i].actionButtonSend = new ActionButton(this);
         m_commandControls[i].actionButtonSend->setIcon(QIcon(QStringLiteral(":/ico/send.ico")));
 
-        m_commandControls[i].spinBoxInterval = new QSpinBox(this);
-        m_commandControls[i].spinBoxInterval->setRange(10, 5000);
+        m_commandControls[i].spinBoxInterval = new QDoubleSpinBox(this);
+        m_commandControls[i].spinBoxInterval->setDecimals(3);
+        m_commandControls[i].spinBoxInterval->setRange(0.1, 60000);
         m_commandControls[i].spinBoxInterval->setValue(1000);
         m_commandControls[i].spinBoxInterval->setSuffix(tr("мс"));
         m_commandControls[i].spinBoxInterval->setToolTip(QString(tr("Интервал отправки команды №%1 в циклическом режиме")).arg(i+1));
@@ -348,18 +476,18 @@ MainWindow::MainWindow(QWidget *parent):
         m_commandControls[i].actionSend->setStatusTip(m_commandControls[i].actionSend->toolTip());
         m_ui->menuSend->addAction(m_commandControls[i].actionSend);
 
+        // команда с CRC собирается при изменении, отправка - готовый буфер
+        connect(m_commandControls[i].lineEditCommand, &QLineEdit::textChanged, this, [=]() { compileCommand(i); });
+        connect(m_commandControls[i].comboBoxCrc, &QComboBox::currentIndexChanged, this, [=]() { compileCommand(i); });
         connect(m_commandControls[i].actionSend, &QAction::triggered, this, [=]() {
-            QByteArray cmd = strToCmd(m_commandControls[i].lineEditCommand->text());
-            writeData(m_crc->addCrc(cmd, m_commandControls[i].comboBoxCrc->currentIndex()));
+            writeData(m_commandControls[i].command);
         });
         m_commandControls[i].actionButtonSend->setAction(m_commandControls[i].actionSend);
         connect(m_commandControls[i].lineEditCommand, &QLineEdit::returnPressed, m_commandControls[i].actionSend, &QAction::trigger);
 
-        // timer
-        m_commandControls[i].timer = new QTimer(this);
-        connect(m_commandControls[i].timer, &QTimer::timeout, m_commandControls[i].actionSend, &QAction::trigger);
-        connect(m_commandControls[i].spinBoxInterval, &QSpinBox::valueChanged, [=](int value) {
-            m_commandControls[i].timer->setInterval(value);
+        // interval
+        connect(m_commandControls[i].spinBoxInterval, &QDoubleSpinBox::valueChanged, this, [=](double value) {
+            m_scheduler->setInterval(i, qint64(value * 1000000));
         });
 
         // action loop
@@ -378,9 +506,10 @@ MainWindow::MainWindow(QWidget *parent):
         m_ui->menuLoop->addAction(m_commandControls[i].actionSendInterval);
         connect(m_commandControls[i].actionSendInterval, &QAction::toggled, this, [=](bool checked) {
             if (checked) {
-                m_commandControls[i].timer->start(m_commandControls[i].spinBoxInterval->value());
-            } else {
-                m_commandControls[i].timer->stop();
+                m_scheduler->schedule(i, qint64(m_commandControls[i].spinBoxInterval->value() * 1000000), m_commandControls[i].command);
+            } else if (m_scheduler->isActive(i)) {
+                m_scheduler->cancel(i);
+                m_ui->statusBar->showMessage(tr("Команда №%1: %2").arg(i+1).arg(Scheduler::statsToString(m_scheduler->stats(i))));
             }
         });
         m_commandControls[i].actionButtonSendInterval->setAction(m_commandControls[i].actionSendInterval);
@@ -417,6 +546,16 @@ MainWindow::MainWindow(QWidget *parent):
     m_ui->spinBoxEnumerateInterval->setStatusTip(m_ui->labelEnumerateInterval->statusTip());
     m_ui->comboBoxEnumerateCrc->setToolTip(m_ui->labelEnumerateCrc->statusTip());
     m_ui->comboBoxEnumerateCrc->setStatusTip(m_ui->labelEnumerateCrc->statusTip());
+    m_ui->comboBoxEnumerateMode->setToolTip(m_ui->labelEnumerateMode->statusTip());
+    m_ui->comboBoxEnumerateMode->setStatusTip(m_ui->labelEnumerateMode->statusTip());
+    m_ui->lineEditEnumerateResponse->setToolTip(m_ui->labelEnumerateResponse->statusTip());
+    m_ui->lineEditEnumerateResponse->setStatusTip(m_ui->labelEnumerateResponse->statusTip());
+    m_ui->spinBoxEnumerateWindow->setToolTip(m_ui->labelEnumerateWindow->statusTip());
+    m_ui->spinBoxEnumerateWindow->setStatusTip(m_ui->labelEnumerateWindow->statusTip());
+    m_ui->spinBoxEnumerateTimeout->setToolTip(m_ui->labelEnumerateTimeout->statusTip());
+    m_ui->spinBoxEnumerateTimeout->setStatusTip(m_ui->labelEnumerateTimeout->statusTip());
+    m_ui->listWidgetEnumerateHits->setToolTip(m_ui->listWidgetEnumerateHits->statusTip());
+    m_ui->pushButtonEnumerateExport->setToolTip(m_ui->pushButtonEnumerateExport->statusTip());
     m_ui->pushButtonStart->setToolTip(m_ui->pushButtonStart->statusTip());
     m_ui->pushButtonStop->setToolTip(m_ui->pushButtonStop->statusTip());
 
@@ -440,15 +579,120 @@ MainWindow::MainWindow(QWidget *parent):
     connect(m_ui->pushButtonStop, &QPushButton::clicked, this, [=]() {
         addrStart(false);
     });
-    connect(m_timerAddr, &QTimer::timeout, this, [=](){
+    connect(m_scheduler, &Scheduler::timeout, this, [=](int id) {
+        if (id != SCHEDULER_ENUMERATE || !m_scheduler->isActive(id)) return;
         if (m_addr <= m_ui->spinBoxEnumerateTo->value()) {
-            QByteArray cmd = addrToCmd(m_ui->lineEditEnumerateFormat->text());
+            QByteArray cmd = Command::fromFormat(m_ui->lineEditEnumerateFormat->text(), m_addr,
+                                                 Command::ValueType(m_ui->comboBoxEnumerateType->currentIndex()),
+                                                 m_ui->spinBoxEnumerateDigits->value());
             writeData(m_crc->addCrc(cmd, m_ui->comboBoxEnumerateCrc->currentIndex()));
             m_addr++;
         } else {
             m_ui->pushButtonStop->click();
         }
     });
+    connect(m_ui->comboBoxEnumerateMode, &QComboBox::currentIndexChanged, this, &MainWindow::addrModeUpdate);
+    connect(m_ui->pushButtonEnumerateExport, &QPushButton::clicked, this, &MainWindow::addrExport);
+    connect(m_enumerator, &Enumerator::writeData, this, &MainWindow::writeData);
+    connect(m_enumerator, &Enumerator::responded, this, [=](const Enumerator::Hit &hit) {
+        m_ui->listWidgetEnumerateHits->addItem(tr("%1 - %2 мс")
+                                               .arg(Enumerator::addrToString(hit.addr, m_ui->spinBoxEnumerateFrom->displayIntegerBase()))
+                                               .arg(hit.latency / 1000000.0, 0, 'f', 3));
+    });
+    connect(m_enumerator, &Enumerator::progress, this, [=](qint64 done, qint64 total) {
+        m_ui->statusBar->showMessage(tr("Перебор: %1 из %2, ответили %3").arg(done).arg(total).arg(m_enumerator->hits().size()));
+    });
+    connect(m_enumerator, &Enumerator::finished, this, &MainWindow::addrFinished);
+
+    // Latency
+    m_ui->checkBoxLatency->setToolTip(m_ui->checkBoxLatency->statusTip());
+    m_ui->lineEditLatencyResponse->setToolTip(m_ui->labelLatencyResponse->statusTip());
+    m_ui->lineEditLatencyResponse->setStatusTip(m_ui->labelLatencyResponse->statusTip());
+    m_ui->spinBoxLatencyTimeout->setToolTip(m_ui->labelLatencyTimeout->statusTip());
+    m_ui->spinBoxLatencyTimeout->setStatusTip(m_ui->labelLatencyTimeout->statusTip());
+    m_ui->pushButtonLatencyReset->setToolTip(m_ui->pushButtonLatencyReset->statusTip());
+
+    connect(m_ui->lineEditLatencyResponse, &QLineEdit::textChanged, this, [=](const QString &text) {
+        m_latency.setPattern(Command::fromString(text));
+    });
+    connect(m_ui->checkBoxLatency, &QCheckBox::toggled, this, [=](bool checked) {
+        if (checked && !m_latency.isMatching()) m_ui->statusBar->showMessage(tr("Задержка: задайте образец ответа или разбиение приёма на кадры в настройках"));
+    });
+    connect(m_ui->spinBoxLatencyTimeout, &QDoubleSpinBox::valueChanged, this, [=](double value) {
+        m_latency.setTimeout(qint64(value * 1000000));
+    });
+    connect(m_ui->pushButtonLatencyReset, &QPushButton::clicked, this, [=]() {
+        m_latency.reset();
+        updateLatency();
+    });
+    connect(m_timerLatency, &QTimer::timeout, this, [=]() {
+        if (m_ui->dockWidgetLatency->isVisible() && m_latency.takeChanged()) updateLatency();
+    });
+    m_timerLatency->start(LATENCY_REFRESH);
+
+    // Bridge
+    m_ui->comboBoxBridgeMode->setToolTip(m_ui->labelBridgeMode->statusTip());
+    m_ui->comboBoxBridgeMode->setStatusTip(m_ui->labelBridgeMode->statusTip());
+    m_ui->lineEditBridgeHost->setToolTip(m_ui->labelBridgeHost->statusTip());
+    m_ui->lineEditBridgeHost->setStatusTip(m_ui->labelBridgeHost->statusTip());
+    m_ui->spinBoxBridgePort->setToolTip(m_ui->labelBridgePort->statusTip());
+    m_ui->spinBoxBridgePort->setStatusTip(m_ui->labelBridgePort->statusTip());
+    m_ui->spinBoxBridgeTap->setToolTip(m_ui->labelBridgeTap->statusTip());
+    m_ui->spinBoxBridgeTap->setStatusTip(m_ui->labelBridgeTap->statusTip());
+    m_ui->pushButtonBridge->setToolTip(m_ui->pushButtonBridge->statusTip());
+    m_ui->labelBridgeState->setToolTip(m_ui->labelBridgeState->statusTip());
+
+    connect(m_ui->comboBoxBridgeMode, &QComboBox::currentIndexChanged, this, [=](int mode) {
+        m_ui->lineEditBridgeHost->setEnabled(!m_bridge->isActive() && (mode != Bridge::TcpServer));
+    });
+    connect(m_ui->pushButtonBridge, &QPushButton::toggled, this, &MainWindow::bridgeStart);
+    connect(m_bridge, &Bridge::started, this, [=]() { bridgeStateUpdate(true); });
+    connect(m_bridge, &Bridge::stopped, this, [=]() { bridgeStateUpdate(false); });
+    connect(m_bridge, &Bridge::peerChanged, this, [=](const QString &peer) {
+        m_bridgePeer = peer;
+        updateBridge();
+    });
+    connect(m_bridge, &Bridge::readyRead, this, &MainWindow::bridgeReadyRead);
+    connect(m_bridge, &Bridge::captureError, this, &MainWindow::captureError);
+    connect(m_bridge, &Bridge::errorOccurred, this, [=](const QString &message) {
+        bridgeStateUpdate(m_bridge->isActive());
+        m_ui->statusBar->showMessage(message);
+        QMessageBox::critical(this, tr("Мост"), message);
+    });
+    connect(m_timerBridge, &QTimer::timeout, this, &MainWindow::updateBridge);
+    bridgeStateUpdate(false);
+
+    // Statistics
+    m_ui->pushButtonStatisticsReset->setToolTip(m_ui->pushButtonStatisticsReset->statusTip());
+    connect(m_ui->pushButtonStatisticsReset, &QPushButton::clicked, this, &MainWindow::resetStatistics);
+    connect(m_timerStatistics, &QTimer::timeout, this, &MainWindow::updateStatistics);
+    resetStatistics();
+    m_timerStatistics->start(STATISTICS_REFRESH);
+
+    // Responder
+    m_ui->tableWidgetResponder->setToolTip(m_ui->tableWidgetResponder->statusTip());
+    m_ui->pushButtonResponder->setToolTip(m_ui->pushButtonResponder->statusTip());
+    m_ui->pushButtonResponderAdd->setToolTip(m_ui->pushButtonResponderAdd->statusTip());
+    m_ui->pushButtonResponderRemove->setToolTip(m_ui->pushButtonResponderRemove->statusTip());
+    m_ui->pushButtonResponderLoad->setToolTip(m_ui->pushButtonResponderLoad->statusTip());
+    m_ui->pushButtonResponderSave->setToolTip(m_ui->pushButtonResponderSave->statusTip());
+
+    connect(m_ui->tableWidgetResponder, &QTableWidget::itemChanged, this, &MainWindow::responderApply);
+    connect(m_ui->pushButtonResponder, &QPushButton::toggled, this, &MainWindow::responderApply);
+    connect(m_ui->pushButtonResponderAdd, &QPushButton::clicked, this, [=]() {
+        responderAddRule({QString(), QString(), 0, 0, true});
+        m_ui->tableWidgetResponder->editItem(m_ui->tableWidgetResponder->item(m_ui->tableWidgetResponder->rowCount() - 1, 0));
+    });
+    connect(m_ui->pushButtonResponderRemove, &QPushButton::clicked, this, [=]() {
+        QTableWidget *table = m_ui->tableWidgetResponder;
+        QList<int> rows;
+        for (const QModelIndex &index : table->selectionModel()->selectedRows()) rows << index.row();
+        std::sort(rows.begin(), rows.end(), std::greater<int>());
+        for (const int row : std::as_const(rows)) table->removeRow(row);
+        responderApply();
+    });
+    connect(m_ui->pushButtonResponderLoad, &QPushButton::clicked, this, &MainWindow::responderLoad);
+    connect(m_ui->pushButtonResponderSave, &QPushButton::clicked, this, &MainWindow::responderSave);
 
     // context menu
     connect(m_console, &Console::customContextMenuRequested, this, &MainWindow::consoleContextMenu);
@@ -461,14 +705,21 @@ MainWindow::MainWindow(QWidget *parent):
     m_console->setPalette(p);
     m_console->setBackgroundRole(QPalette::Window); // inactive color
 
+    // горячие клавиши действуют только в активной сессии
+    for (QAction *action : findChildren<QAction*>()) {
+        if (action->shortcut().isEmpty()) continue;
+        action->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+        addAction(action);
+    }
+
     // settings
     readSettings();
 
     // status
     switch (m_settings.type) {
-    case DialogSettings::Tcp: socketStateUpdate(m_tcp->state()); break;
-    case DialogSettings::UdpUnicast:
-    case DialogSettings::UdpBroadcast: socketStateUpdate(m_udp->state()); break;
+    case Connection::Tcp:
+    case Connection::UdpUnicast:
+    case Connection::UdpBroadcast: socketStateUpdate(QAbstractSocket::UnconnectedState); break;
     default:
         serialStateUpdate();
     }
@@ -476,6 +727,17 @@ MainWindow::MainWindow(QWidget *parent):
 
 MainWindow::~MainWindow() {
     writeSettings();
+    m_scheduler->cancelAll();
+    disconnect(m_transport, nullptr, this, nullptr);
+    QMetaObject::invokeMethod(m_transport, [=]() {
+        m_transport->close();
+        m_transport->setSessionLog(nullptr);        // журнал удаляется вместе с окном
+    }, Qt::BlockingQueuedConnection);
+    m_transport->deleteLater();
+    disconnect(m_bridge, nullptr, this, nullptr);
+    QMetaObject::invokeMethod(m_bridge, &Bridge::stop, Qt::BlockingQueuedConnection);
+    m_bridge->deleteLater();
+    m_pool->release(m_threadIo);
     delete m_ui;
 }
 
@@ -484,106 +746,10 @@ void MainWindow::setToolStatusTip(QAction *widget, QString tip) {
     widget->setStatusTip(widget->toolTip());
 }
 
-QByteArray MainWindow::strToCmd(QString value) {
-    QByteArray result;
-    int idx=0;
-    while (idx < value.length()) {
-        if (value.at(idx) == '\\') {
-            if (value.at(idx+1) == '\\') {
-                result += '\\';
-                idx+=1;
-            } else {
-                result += value.mid(idx+1,2).toInt(nullptr, 16);
-                idx+=2;
-            }
-        } else {
-            result.append(QString(value.at(idx)).toLocal8Bit());
-        }
-        idx++;
-    }
-    return result;
-}
-
-QByteArray MainWindow::addrToCmd(QString value) {
-    QByteArray result;
-    int idx=0;
-    while (idx < value.length()) {
-        if (value.at(idx) == '\\') {
-            if (value.at(idx+1) == '\\') {
-                result += '\\';
-                idx+=1;
-            } else if (value.at(idx+1) == '#') {
-                switch (m_ui->comboBoxEnumerateType->currentIndex()) {
-                case 1: result.append(QStringLiteral("%1").arg(m_addr, m_ui->spinBoxEnumerateDigits->value(), 16, QLatin1Char('0')).toLocal8Bit()); break; // Hex
-                case 2: result.append(addrToBin(m_addr, m_ui->spinBoxEnumerateDigits->value(), QDataStream::LittleEndian)); break; // Bin little-endian
-                case 3: result.append(addrToBin(m_addr, m_ui->spinBoxEnumerateDigits->value(), QDataStream::BigEndian)); break; // Bin big-endian
-                default: result.append(QString("%1").arg(m_addr, m_ui->spinBoxEnumerateDigits->value(), 10, QLatin1Char('0')).toLocal8Bit()); break; // Dec
-                }
-                idx+=1;
-            } else {
-                result += value.mid(idx+1,2).toInt(nullptr, 16);
-                idx+=2;
-            }
-        } else {
-            result.append(QString(value.at(idx)).toLocal8Bit());
-        }
-        idx++;
-    }
-    return result;
-}
-
-QByteArray MainWindow::addrToBin(int value, int digits, QDataStream::ByteOrder byteOrder) {
-    QByteArray bin, res;
-    QDataStream ds(&bin, QIODevice::ReadWrite);
-    ds.setByteOrder(QDataStream::BigEndian);
-    ds << quint32(value);
-
-    switch (digits) {
-    case 1: switch (byteOrder) {
-        case QDataStream::LittleEndian:
-        case QDataStream::BigEndian:
-            res.append(bin.at(3));
-            break;
-        }
-        break;
-    case 2: switch (byteOrder) {
-        case QDataStream::LittleEndian:
-            res.append(bin.at(3));
-            res.append(bin.at(2));
-            break;
-        case QDataStream::BigEndian:
-            res.append(bin.at(2));
-            res.append(bin.at(3));
-            break;
-        }
-        break;
-    case 3: switch (byteOrder) {
-        case QDataStream::LittleEndian:
-            res.append(bin.at(3));
-            res.append(bin.at(2));
-            res.append(bin.at(1));
-            break;
-        case QDataStream::BigEndian:
-            res.append(bin.at(1));
-            res.append(bin.at(2));
-            res.append(bin.at(3));
-            break;
-        }
-        break;
-    case 4: switch (byteOrder) {
-        case QDataStream::LittleEndian:
-            res.append(bin.at(3));
-            res.append(bin.at(2));
-            res.append(bin.at(1));
-            res.append(bin.at(0));
-            break;
-        case QDataStream::BigEndian:
-            res.append(bin);
-            break;
-        }
-        break;
-    }
-    return res;
+void MainWindow::compileCommand(int idx) {
+    QByteArray cmd = Command::fromString(m_commandControls[idx].lineEditCommand->text());
+    m_commandControls[idx].command = m_crc->addCrc(cmd, m_commandControls[idx].comboBoxCrc->currentIndex());
+    m_scheduler->setData(idx, m_commandControls[idx].command);
 }
 
 void MainWindow::addrRangeUpdate(int type, int digits) {
@@ -625,27 +791,98 @@ void MainWindow::addrStart(bool value) {
     m_ui->spinBoxEnumerateFrom->setEnabled(!value);
     m_ui->spinBoxEnumerateTo->setEnabled(!value);
     m_ui->spinBoxEnumerateDigits->setEnabled(!value);
-    m_ui->spinBoxEnumerateInterval->setEnabled(!value);
+    m_ui->comboBoxEnumerateMode->setEnabled(!value);
+    m_ui->comboBoxEnumerateCrc->setEnabled(!value);
+    addrModeUpdate(value ? -1 : m_ui->comboBoxEnumerateMode->currentIndex());
     if (value) {
-        m_addr = m_ui->spinBoxEnumerateFrom->value();
-        m_timerAddr->start(m_ui->spinBoxEnumerateInterval->value());
+        if (m_ui->comboBoxEnumerateMode->currentIndex() == ENUMERATE_BY_RESPONSE) {
+            if (!isOpen()) {
+                addrStart(false);
+                showSettings();
+                return;
+            }
+            const QString format = m_ui->lineEditEnumerateFormat->text();
+            const QString response = m_ui->lineEditEnumerateResponse->text();
+            const int crc = m_ui->comboBoxEnumerateCrc->currentIndex();
+            const Command::ValueType type = Command::ValueType(m_ui->comboBoxEnumerateType->currentIndex());
+            const int digits = m_ui->spinBoxEnumerateDigits->value();
+            const bool framed = (m_settings.framing != Connection::FrameNone);
+            if (response.isEmpty() && !framed) {
+                addrStart(false);
+                QMessageBox::warning(this, tr("Перебор"), tr("Задайте образец ответа или разбиение приёма на кадры в настройках"));
+                return;
+            }
+            Enumerator::Builder expected;             // без образца - принятый кадр
+            if (!response.isEmpty()) expected = [=](qint64 addr) { return Command::fromFormat(response, addr, type, digits); };
+            m_ui->listWidgetEnumerateHits->clear();
+            m_ui->pushButtonEnumerateExport->setEnabled(false);
+            m_enumerator->start(m_ui->spinBoxEnumerateFrom->value(), m_ui->spinBoxEnumerateTo->value(),
+                                m_ui->spinBoxEnumerateWindow->value(),
+                                qint64(m_ui->spinBoxEnumerateTimeout->value() * 1000000),
+                                [=](qint64 addr) {
+                                    QByteArray cmd = Command::fromFormat(format, addr, type, digits);
+                                    return m_crc->addCrc(cmd, crc);
+                                },
+                                expected, framed);
+        } else {
+            m_addr = m_ui->spinBoxEnumerateFrom->value();
+            m_scheduler->schedule(SCHEDULER_ENUMERATE, qint64(m_ui->spinBoxEnumerateInterval->value() * 1000000));
+        }
+    } else if (m_enumerator->isActive()) {
+        m_enumerator->stop();                       // сообщение - в addrFinished
+    } else if (m_scheduler->isActive(SCHEDULER_ENUMERATE)) {
+        m_scheduler->cancel(SCHEDULER_ENUMERATE);
+        m_ui->statusBar->showMessage(tr("Перебор: %1").arg(Scheduler::statsToString(m_scheduler->stats(SCHEDULER_ENUMERATE))));
+    }
+}
+
+// mode < 0 - перебор идёт, параметры режима недоступны
+void MainWindow::addrModeUpdate(int mode) {
+    const bool byResponse = (mode == ENUMERATE_BY_RESPONSE);
+    m_ui->spinBoxEnumerateInterval->setEnabled(mode >= 0 && !byResponse);
+    m_ui->lineEditEnumerateResponse->setEnabled(byResponse);
+    m_ui->spinBoxEnumerateWindow->setEnabled(byResponse);
+    m_ui->spinBoxEnumerateTimeout->setEnabled(byResponse);
+}
+
+void MainWindow::addrFinished() {
+    if (m_ui->pushButtonStop->isEnabled()) addrStart(false);
+    m_ui->pushButtonEnumerateExport->setEnabled(!m_enumerator->hits().isEmpty());
+    m_ui->statusBar->showMessage(tr("Перебор: отправлено %1, ответили %2, без ответа %3, время %4 с")
+                                 .arg(m_enumerator->sent())
+                                 .arg(m_enumerator->hits().size())
+                                 .arg(m_enumerator->timeouts())
+                                 .arg(m_enumerator->elapsed() / 1000000000.0, 0, 'f', 3));
+}
+
+void MainWindow::addrExport() {
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Экспорт"), m_dir, tr("CSV (*.csv);;Все файлы (*.*)"));
+    if (fileName.isEmpty()) return;
+    if (m_enumerator->exportHits(fileName, m_ui->spinBoxEnumerateFrom->displayIntegerBase())) {
+        m_ui->statusBar->showMessage(tr("Сохранено ответивших: %1").arg(m_enumerator->hits().size()));
     } else {
-        m_timerAddr->stop();
+        QMessageBox::warning(this, tr("Экспорт"), m_enumerator->errorString());
     }
 }
 
 void MainWindow::openFile() {
-    QFileDialog dialog(this, tr("Открыть"), m_dir, tr("Текстовый документ (*.txt)"));
+    QFileDialog dialog(this, tr("Открыть"), m_dir, tr("Текстовый документ (*.txt);;Захват (*.%1);;Все файлы (*.*)").arg(CAPTURE_EXTENSION));
     dialog.setAcceptMode(QFileDialog::AcceptOpen);
     if (dialog.exec() == QDialog::Accepted) {
-        QFile file(dialog.selectedFiles().constFirst());
-        if (file.open(QIODevice::ReadOnly)) {
-            m_console->clear();
-            QString content = QString::fromLocal8Bit(file.readAll());
-            m_console->setPlainText(content);
+        m_timerReplay->stop();
+        m_replay.close();
+        if (Capture::isCapture(dialog.selectedFiles().constFirst())) {
+            openCapture(dialog.selectedFiles().constFirst());
             m_dir = dialog.directory().absolutePath();
-            file.close();
+            return;
+        }
+        // файл отображается в память и индексируется в фоне: первая страница видна сразу
+        const QString fileName = dialog.selectedFiles().constFirst();
+        if (!m_console->openLog(fileName)) {
+            QMessageBox::warning(this, tr("Открыть"), tr("Ошибка открытия '%1': %2").arg(fileName, m_console->logErrorString()));
+            return;
         }
+        m_dir = dialog.directory().absolutePath();
     }
 }
 
@@ -655,58 +892,182 @@ void MainWindow::saveFileAs() {
     dialog.selectFile(QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss"));
     dialog.setFileMode(QFileDialog::AnyFile);
     if (dialog.exec() == QDialog::Accepted) {
-        QFile file(dialog.selectedFiles().constFirst());
-        if (file.open(QIODevice::WriteOnly)) {
+        const QString fileName = dialog.selectedFiles().constFirst();
+        const QString logFileName = m_console->logFileName();
+        if (!logFileName.isEmpty() && (QFileInfo(fileName).canonicalFilePath() == QFileInfo(logFileName).canonicalFilePath())) return;
+        // пишется во временный файл рядом, прежний заменяется только после успешной записи
+        QSaveFile file(fileName);
+        QString error;
+        if (!file.open(QIODevice::WriteOnly)) {
+            error = file.errorString();
+        } else if (!logFileName.isEmpty()) {
+            // открытый файл копируется как есть, без сборки текста в памяти
+            QFile source(logFileName);
+            if (!source.open(QIODevice::ReadOnly)) error = source.errorString();
+            while (error.isEmpty() && !source.atEnd()) {
+                const QByteArray block = source.read(SAVE_BLOCK);
+                if (block.isEmpty()) {
+                    error = source.errorString();
+                } else if (file.write(block) != block.size()) {
+                    error = file.errorString();
+                }
+            }
+        } else {
             QTextStream out(&file);
             out << m_console->toPlainText();
-            m_dir = dialog.directory().absolutePath();
-            file.close();
+            out.flush();
+            if (out.status() != QTextStream::Ok) error = file.errorString();
+        }
+        if (error.isEmpty() && !file.commit()) error = file.errorString();
+        if (!error.isEmpty()) {
+            file.cancelWriting();
+            QMessageBox::warning(this, tr("Сохранить как..."), tr("Ошибка записи в '%1': %2").arg(fileName, error));
+            return;
+        }
+        m_dir = dialog.directory().absolutePath();
+    }
+}
+
+void MainWindow::openCapture(const QString &fileName) {
+    if (!m_replay.open(fileName)) {
+        QMessageBox::warning(this, tr("Открыть"), tr("Ошибка открытия '%1': %2").arg(fileName, m_replay.errorString()));
+        return;
+    }
+    m_console->clear();
+    m_converter.reset();
+    m_replayPage = REPLAY_PAGE;
+    m_timerReplay->start(0);
+}
+
+// Захват выводится страницами от начала по отображению файла, не блокируя интерфейс:
+// следующая страница - когда консоль прокручена до конца
+void MainWindow::replayCapture() {
+    QElapsedTimer budget;
+    budget.start();
+    Capture::Chunk chunk;
+    while (budget.elapsed() < REPLAY_BUDGET) {
+        if (m_replayPage <= 0) {
+            m_timerReplay->stop();
+            m_ui->statusBar->showMessage(tr("Захват: %1%, прокрутите до конца для продолжения")
+                                         .arg(m_replay.position() * 100 / qMax<qint64>(m_replay.size(), 1)));
+            return;
+        }
+        if (!m_replay.next(chunk)) {
+            m_timerReplay->stop();
+            m_ui->statusBar->showMessage(tr("Захват загружен: %1").arg(QLocale().formattedDataSize(m_replay.size())));
+            m_replay.close();
+            return;
         }
+        if (chunk.direction == Capture::Tx && !m_settings.localEcho) continue;
+        m_accumulator->append(m_converter.convert(QByteArray(chunk.data, chunk.size),
+                                          m_replay.startTime() * 1000000 + chunk.timestamp));
+        m_replayPage -= chunk.size;
     }
+    m_ui->statusBar->showMessage(tr("Загрузка захвата: %1%").arg(m_replay.position() * 100 / qMax<qint64>(m_replay.size(), 1)));
+}
+
+void MainWindow::replayNextPage(int value) {
+    if (!m_replay.isOpen() || m_timerReplay->isActive() || value < m_console->verticalScrollBar()->maximum()) return;
+    m_replayPage = REPLAY_PAGE;
+    m_timerReplay->start(0);
+}
+
+void MainWindow::setCapture(bool enabled) {
+    if (!enabled) {
+        QMetaObject::invokeMethod(m_transport, &Transport::stopCapture);
+        QMetaObject::invokeMethod(m_bridge, &Bridge::stopCapture);
+        m_ui->statusBar->showMessage(tr("Запись захвата остановлена"));
+        return;
+    }
+    QFileDialog dialog(this, tr("Запись захвата"), m_dir, tr("Захват (*.%1)").arg(CAPTURE_EXTENSION));
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setDefaultSuffix(CAPTURE_EXTENSION);
+    dialog.selectFile(QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss"));
+    dialog.setFileMode(QFileDialog::AnyFile);
+    if (dialog.exec() == QDialog::Accepted) {
+        const QString fileName = dialog.selectedFiles().constFirst();
+        m_dir = dialog.directory().absolutePath();
+        // захват пишет то, что работает сейчас: мост (отвод) или подключение
+        if (m_bridge->isActive()) {
+            QMetaObject::invokeMethod(m_bridge, [=]() { m_bridge->startCapture(fileName); });
+        } else {
+            QMetaObject::invokeMethod(m_transport, [=]() { m_transport->startCapture(fileName); });
+        }
+        m_ui->statusBar->showMessage(tr("Запись захвата: %1").arg(fileName));
+    } else {
+        const QSignalBlocker blocker(m_ui->actionCapture);
+        m_ui->actionCapture->setChecked(false);
+    }
+}
+
+void MainWindow::captureError(const QString &message) {
+    const QSignalBlocker blocker(m_ui->actionCapture);
+    m_ui->actionCapture->setChecked(false);
+    m_ui->statusBar->showMessage(message);
+    QMessageBox::warning(this, tr("Запись захвата"), message);
+}
+
+void MainWindow::sessionLogError(const QString &message) {
+    m_ui->statusBar->showMessage(message);
+    QMessageBox::warning(this, QString(tr("Журнал сеанса")), message);
 }
 
 void MainWindow::sendFile() {
     QFileDialog dialog(this, tr("Отправить файл"), m_dir, tr("Все файлы (*.*)"));
     dialog.setAcceptMode(QFileDialog::AcceptOpen);
     if (dialog.exec() == QDialog::Accepted) {
-        QFile file(dialog.selectedFiles().constFirst());
-        if (file.open(QIODevice::ReadOnly)) {
-            writeData(file.readAll());
-            m_dir = dialog.directory().absolutePath();
-            file.close();
+        m_dir = dialog.directory().absolutePath();
+        m_ui->actionSendFile->setEnabled(false);
+        m_ui->actionSendFilePause->setChecked(false);
+        m_ui->actionSendFilePause->setEnabled(true);
+        m_ui->actionSendFileCancel->setEnabled(true);
+        if (!m_fileSender->start(dialog.selectedFiles().constFirst(), m_settings)) {
+            sendFileFinished(false);
+            QMessageBox::warning(this, tr("Отправить файл"), m_fileSender->errorString());
         }
     }
 }
 
-void MainWindow::open() {
-    switch (m_settings.type) {
+void MainWindow::sendFileProgress(qint64 written, qint64 total) {
+    if (!m_fileSender->isActive()) return;
+    const QLocale locale;
+    QString state;
+    if (m_fileSender->isPaused()) {
+        state = tr("пауза");
+    } else if (m_fileSender->isBlocked()) {
+        state = tr("ожидание управления потоком");
+    } else {
+        const qint64 eta = m_fileSender->eta();
+        state = tr("%1/с, осталось %2").arg(locale.formattedDataSize(m_fileSender->throughput()),
+                                            (eta < 0) ? QString("--:--:--") : QTime(0, 0).addMSecs(int(eta)).toString("hh:mm:ss"));
+    }
+    m_ui->statusBar->showMessage(tr("Отправка файла: %1% (%2 из %3), %4")
+                                 .arg(total ? written * 100 / total : 100)
+                                 .arg(locale.formattedDataSize(written), locale.formattedDataSize(total), state));
+}
 
-    case DialogSettings::Tcp:
-        m_tcp->connectToHost(m_settings.host, m_settings.port);
+void MainWindow::sendFileFinished(bool completed) {
+    m_ui->actionSendFile->setEnabled(isOpen());
+    m_ui->actionSendFilePause->setChecked(false);
+    m_ui->actionSendFilePause->setEnabled(false);
+    m_ui->actionSendFileCancel->setEnabled(false);
+    if (completed) {
+        m_ui->statusBar->showMessage(tr("Файл отправлен: %1 байт, CRC-32: %2")
+                                     .arg(m_fileSender->size())
+                                     .arg(QString::number(m_fileSender->crc(), 16).rightJustified(8, '0').toUpper()));
+    } else {
+        m_ui->statusBar->showMessage(tr("Отправка файла прервана: %1 из %2 байт")
+                                     .arg(m_fileSender->written()).arg(m_fileSender->size()));
+    }
+}
+
+void MainWindow::open() {
+    if (m_settings.type == Connection::Tcp) {
         m_ui->actionConnect->setEnabled(false);
         m_ui->actionSettings->setEnabled(false);
-        break;
-
-    case DialogSettings::UdpUnicast:
-    case DialogSettings::UdpBroadcast:
-        m_udp->bind(m_settings.port, QUdpSocket::ShareAddress);
-        connected();
-        break;
-
-    default: // DialogSettings::Serial
-        m_serial->setPortName(m_settings.name);
-        m_serial->setBaudRate(m_settings.baudRate);
-        m_serial->setDataBits(m_settings.dataBits);
-        m_serial->setParity(m_settings.parity);
-        m_serial->setStopBits(m_settings.stopBits);
-        m_serial->setFlowControl(m_settings.flowControl);
-        if (m_serial->open(QIODevice::ReadWrite)) {
-            connected();
-        } else {
-            openError(QString(tr("Ошибка открытия порта '%1': %2")).
-                      arg(m_serial->portName()).arg(m_serial->errorString()));
-        }
     }
+    const Connection::Settings settings = m_settings;
+    QMetaObject::invokeMethod(m_transport, [=]() { m_transport->open(settings); });
 }
 
 void MainWindow::openError(QString message) {
@@ -715,39 +1076,27 @@ void MainWindow::openError(QString message) {
 }
 
 void MainWindow::close() {
-    switch (m_settings.type) {
-    case DialogSettings::Tcp: if (m_tcp->isOpen()) m_tcp->close(); break;
-    case DialogSettings::UdpUnicast:
-    case DialogSettings::UdpBroadcast:
-        if (m_udp->state() == QAbstractSocket::BoundState) {
-            m_udp->close();//abort
-        }
-        disconnected();
-        break;
-    default: // DialogSettings::Serial
-        if (m_serial->isOpen()) m_serial->close();
-        disconnected();
-    }
+    QMetaObject::invokeMethod(m_transport, &Transport::close, Qt::BlockingQueuedConnection);
 }
 
 void MainWindow::connected() {
+    m_timerReplay->stop();                          // новые данные не смешиваются с захватом
+    m_replay.close();
     m_ui->actionConnect->setEnabled(false);
     m_ui->actionDisconnect->setEnabled(true);
     m_ui->actionSettings->setEnabled(true);
-    m_ui->actionSendFile->setEnabled(true);
+    m_ui->actionSendFile->setEnabled(!m_fileSender->isActive());
     switch (m_settings.type) {
 
-    case DialogSettings::Tcp:
-    case DialogSettings::UdpUnicast:
-    case DialogSettings::UdpBroadcast:
+    case Connection::Tcp:
+    case Connection::UdpUnicast:
+    case Connection::UdpBroadcast:
         m_ui->actionDtr->setEnabled(false);
         m_ui->actionRts->setEnabled(false);
         break;
 
-    default: // DialogSettings::Serial
-        m_serial->setDataTerminalReady(m_settings.dtr);
+    default: // Connection::Serial
         m_ui->actionDtr->setChecked(m_settings.dtr);
-        m_serial->setRequestToSend(m_settings.rts);
         m_ui->actionRts->setChecked(m_settings.rts);
         m_ui->actionDtr->setEnabled(true);
         m_ui->actionRts->setEnabled(true);
@@ -761,7 +1110,6 @@ void MainWindow::connected() {
         m_labelLedRi->setVisible(true);
         m_labelLedStd->setVisible(true);
         m_labelLedSrd->setVisible(true);
-        m_timerSerialSignals->start();
         serialStateUpdate();
     }
     m_ui->actionSendBreak->setEnabled(true);
@@ -778,12 +1126,14 @@ void MainWindow::disconnected() {
     m_ui->actionConnect->setEnabled(true);
     m_ui->actionDisconnect->setEnabled(false);
     m_ui->actionSettings->setEnabled(true);
+    m_fileSender->cancel();
+    m_enumerator->stop();
     m_ui->actionSendFile->setEnabled(false);
     switch (m_settings.type) {
-    case DialogSettings::Tcp: m_ui->statusBar->showMessage(tr("TCP-сокет отключен")); break;
-    case DialogSettings::UdpUnicast: m_ui->statusBar->showMessage(tr("UDP Unicast отключен")); break;
-    case DialogSettings::UdpBroadcast: m_ui->statusBar->showMessage(tr("UDP Broadcast отключен")); break;
-    default: // DialogSettings::Serial
+    case Connection::Tcp: m_ui->statusBar->showMessage(tr("TCP-сокет отключен")); break;
+    case Connection::UdpUnicast: m_ui->statusBar->showMessage(tr("UDP Unicast отключен")); break;
+    case Connection::UdpBroadcast: m_ui->statusBar->showMessage(tr("UDP Broadcast отключен")); break;
+    default: // Connection::Serial
         m_ui->statusBar->showMessage(tr("Последовательный порт отключен"));
         m_labelLedDtr->setVisible(false);
         m_labelLedRts->setVisible(false);
@@ -793,7 +1143,6 @@ void MainWindow::disconnected() {
         m_labelLedRi->setVisible(false);
         m_labelLedStd->setVisible(false);
         m_labelLedSrd->setVisible(false);
-        m_timerSerialSignals->stop();
         serialStateUpdate();
     }
     m_ui->actionDtr->setEnabled(false);
@@ -833,99 +1182,299 @@ void MainWindow::about() {
     mb.exec();
 }
 
-QByteArray MainWindow::convertData(const QByteArray &data) {
-    QByteArray res;
-    if (m_settings.timeStamp) {
-        quint64 ms = QDateTime::currentMSecsSinceEpoch();
-        res.append(QDateTime::fromMSecsSinceEpoch(ms).toString("\n[hh:mm:ss.zzz] - ").toLocal8Bit());
+void MainWindow::writeData(const QByteArray &data) {
+    if (!isOpen()) {
+        showSettings();
+        return;
     }
-    for (int i=0; i<data.size(); ++i) {
-        char c = data.at(i);
-        if (m_settings.hexLog) {
-            if (m_settings.hexAll || (c < ' ')) {
-                res.append(QString("<%1>").arg(QByteArray(1, c).toHex().toUpper()).toLocal8Bit());
-            } else {
-                res.append(c);
-            }
-            if (m_settings.linefeed) {
-                if (c == m_settings.linefeedChar) {
-                    res.append('\n');
-                }
-            }
+    // локальное эхо возвращается из транспорта с меткой времени записи
+    QMetaObject::invokeMethod(m_transport, [=]() { m_transport->write(data); });
+}
+
+void MainWindow::transportReadyRead() {
+    Transport::Chunk chunk;
+    while (m_transport->read(chunk)) {
+        if (chunk.direction == Capture::Tx) {
+            // поток файла - не запросы
+            if (m_ui->checkBoxLatency->isChecked() && !m_fileSender->isActive()) m_latency.sent(chunk.data, chunk.timestamp);
+            if (!m_settings.localEcho) continue;
         } else {
-            res.append(c);
+            if (m_fileSender->isActive()) m_fileSender->receivedData(chunk.data);
+            if (m_enumerator->isActive()) m_enumerator->receivedData(chunk.data, chunk.timestamp);
+            if (m_ui->checkBoxLatency->isChecked()) m_latency.received(chunk.data, chunk.timestamp);
         }
+        m_accumulator->append(m_converter.convert(chunk.data, Timestamp::toNSecsSinceEpoch(chunk.timestamp), chunk.check));
     }
-    return res;
 }
 
-void MainWindow::writeData(const QByteArray &data) {
-    if (!isOpen()) {
-        showSettings();
+void MainWindow::bridgeReadyRead() {
+    Transport::Chunk chunk;
+    while (m_bridge->read(chunk)) {
+        m_accumulator->append(m_converter.convert(chunk.data, Timestamp::toNSecsSinceEpoch(chunk.timestamp)));
+    }
+}
+
+void MainWindow::bridgeStart(bool enabled) {
+    if (!enabled) {
+        QMetaObject::invokeMethod(m_bridge, &Bridge::stop);
         return;
     }
-    qint64 written;
-    switch (m_settings.type) {
-    case DialogSettings::Tcp:
-        written = m_tcp->write(data);
-        if (written != data.size()) {
-            const QString error = tr("Ошибка записи в 'TCP:%1:%2'!\nError: '%3'").arg(m_settings.host).arg(m_settings.port).arg(m_serial->errorString());
-            showWriteError(error);
-            return;
-        }
-        break;
-    case DialogSettings::UdpUnicast:
-        written = m_udp->writeDatagram(data, QHostAddress(m_settings.host), m_settings.port);
-        if (written != data.size()) {
-            const QString error = tr("Ошибка записи в 'UDP:%1:%2'!\nError: '%3'").arg(m_settings.host).arg(m_settings.port).arg(m_serial->errorString());
-            showWriteError(error);
-            return;
-        }
-        break;
-    case DialogSettings::UdpBroadcast:
-        written = m_udp->writeDatagram(data, QHostAddress::Broadcast, m_settings.port);
-        if (written != data.size()) {
-            const QString error = tr("Ошибка записи в 'UDP:%1'!\nError: '%2'").arg(m_settings.port).arg(m_serial->errorString());
-            showWriteError(error);
-            return;
+    if (m_settings.type != Connection::Serial) {
+        QMessageBox::warning(this, tr("Мост"), tr("Мост пересылает данные последовательного порта: выберите порт в параметрах подключения."));
+        bridgeStateUpdate(false);
+        return;
+    }
+    if (isOpen()) close();                          // порт занимает мост
+    m_converter.reset();
+    m_bridgePeer.clear();
+    Connection::Settings serial = m_settings;
+    serial.dtr = m_ui->actionDtr->isChecked();
+    serial.rts = m_ui->actionRts->isChecked();
+    const Bridge::Settings settings = {
+        Bridge::Mode(m_ui->comboBoxBridgeMode->currentIndex()),
+        m_ui->lineEditBridgeHost->text(),
+        quint16(m_ui->spinBoxBridgePort->value()),
+        m_ui->spinBoxBridgeTap->value() * 1024
+    };
+    if (settings.mode == Bridge::Udp) m_bridgePeer = QString("%1:%2").arg(settings.host).arg(settings.port);
+    m_ui->pushButtonBridge->setEnabled(false);      // до started/errorOccurred
+    QMetaObject::invokeMethod(m_bridge, [=]() { m_bridge->start(serial, settings); });
+}
+
+void MainWindow::bridgeStateUpdate(bool active) {
+    const QSignalBlocker blocker(m_ui->pushButtonBridge);
+    m_ui->pushButtonBridge->setChecked(active);
+    m_ui->pushButtonBridge->setEnabled(true);
+    m_ui->pushButtonBridge->setText(active ? tr("Остановить") : tr("Запустить"));
+    m_ui->comboBoxBridgeMode->setEnabled(!active);
+    m_ui->lineEditBridgeHost->setEnabled(!active && (m_ui->comboBoxBridgeMode->currentIndex() != Bridge::TcpServer));
+    m_ui->spinBoxBridgePort->setEnabled(!active);
+    m_ui->spinBoxBridgeTap->setEnabled(!active);
+    m_ui->actionConnect->setEnabled(!active && !isOpen());
+    m_ui->actionSettings->setEnabled(!active);
+    if (active) {
+        m_timerBridge->start(BRIDGE_REFRESH);
+        m_ui->statusBar->showMessage(tr("Мост запущен: %1 - %2").arg(m_settings.name, m_ui->comboBoxBridgeMode->currentText()));
+    } else {
+        m_timerBridge->stop();
+        bridgeReadyRead();                          // остаток отвода
+    }
+    updateBridge();
+}
+
+void MainWindow::updateBridge() {
+    const QLocale locale;
+    m_ui->labelBridgeState->setText(tr("%1\nПорт → сеть: %2\nСеть → порт: %3\nМимо отвода: %4\nНе отправлено: %5")
+        .arg(m_bridgePeer.isEmpty() ? tr("Нет подключения") : m_bridgePeer,
+             locale.formattedDataSize(m_bridge->forwarded(Capture::Rx)),
+             locale.formattedDataSize(m_bridge->forwarded(Capture::Tx)),
+             locale.formattedDataSize(m_bridge->dropped()),
+             locale.formattedDataSize(m_bridge->unsent())));
+}
+
+// Отсчёт идёт и при скрытой панели, чтобы пики не пропускались
+void MainWindow::updateStatistics() {
+    const Transport::Statistics statistics = m_transport->statistics();
+    const qint64 now = Timestamp::now();
+    const double seconds = (now - m_statisticsTime) / 1000000000.0;
+    m_statisticsTime = now;
+    // счётчики обнуляются при подключении - отрицательный прирост не учитывается
+    auto rate = [=](qint64 value, qint64 previous) {
+        return (seconds > 0) ? qMax<qint64>(value - previous, 0) / seconds : 0.0;
+    };
+    const double values[] = {
+        rate(statistics.bytes[Capture::Rx], m_statistics.bytes[Capture::Rx]),
+        rate(statistics.bytes[Capture::Tx], m_statistics.bytes[Capture::Tx]),
+        rate(statistics.blocks[Capture::Rx], m_statistics.blocks[Capture::Rx]),
+        rate(statistics.blocks[Capture::Tx], m_statistics.blocks[Capture::Tx]),
+        double(statistics.bytesToWrite),
+        double(statistics.outputQueue),
+        double(statistics.queued),
+        double(m_accumulator->pending()),
+        double(statistics.bytes[Capture::Rx]),
+        double(statistics.bytes[Capture::Tx]),
+        double(statistics.lineErrors[Transport::FramingError]),
+        double(statistics.lineErrors[Transport::ParityError]),
+        double(statistics.lineErrors[Transport::OverrunError]),
+        double(statistics.lineErrors[Transport::BreakCondition]),
+        double(statistics.badFrames),
+        double(statistics.crcOk),
+        double(statistics.crcFailed),
+        (statistics.crcBytes > 0) ? statistics.crcFailed / (statistics.crcBytes * 8.0) : -1.0,
+        double(statistics.responses),
+        m_sessionLog->isEnabled() ? double(m_sessionLog->written()) : -1.0,
+        m_sessionLog->isEnabled() ? double(m_sessionLog->dropped()) : -1.0
+    };
+    m_statistics = statistics;
+    for (int row = 0; row < STATISTICS_PEAK_ROWS; ++row) m_statisticsPeak[row] = qMax(m_statisticsPeak[row], values[row]);
+    if (!m_ui->dockWidgetStatistics->isVisible()) return;
+
+    const QLocale locale;
+    auto text = [&](double value) {
+        return (value < 0) ? QString("-") : locale.toString(qRound64(value)); // -1 - неизвестно
+    };
+    auto ratio = [&](double value) {
+        return (value < 0) ? QString("-") : locale.toString(value, 'e', 2);
+    };
+    QTableWidget *table = m_ui->tableWidgetStatistics;
+    for (int row = 0; row < table->rowCount(); ++row) {
+        const QString cells[] = {
+            (row == STATISTICS_BER_ROW) ? ratio(values[row]) : text(values[row]),
+            (row < STATISTICS_PEAK_ROWS) ? text((values[row] < 0) ? values[row] : m_statisticsPeak[row]) : QString()
+        };
+        for (int column = 0; column < table->columnCount(); ++column) {
+            QTableWidgetItem *item = table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem;
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
         }
-        break;
-    default: // DialogSettings::Serial
-        written = m_serial->write(data);
-        if (written != data.size()) {
-            const QString error = tr("Ошибка записи в порт '%1'!\nError: '%2'").arg(m_serial->portName(), m_serial->errorString());
-            showWriteError(error);
-            return;
+    }
+}
+
+void MainWindow::resetStatistics() {
+    m_statistics = m_transport->statistics();
+    m_statisticsTime = Timestamp::now();
+    m_statisticsPeak.fill(0, STATISTICS_PEAK_ROWS);
+}
+
+void MainWindow::responderAddRule(const Responder::Rule &rule) {
+    QTableWidget *table = m_ui->tableWidgetResponder;
+    const QSignalBlocker blocker(table);
+    const int row = table->rowCount();
+    table->insertRow(row);
+    QTableWidgetItem *pattern = new QTableWidgetItem(rule.pattern);
+    pattern->setFlags(pattern->flags() | Qt::ItemIsUserCheckable);
+    pattern->setCheckState(rule.enabled ? Qt::Checked : Qt::Unchecked);
+    table->setItem(row, 0, pattern);
+    table->setItem(row, 1, new QTableWidgetItem(rule.reply));
+    QComboBox *crc = new QComboBox(table);
+    crc->addItems(m_crc->list());
+    crc->setCurrentIndex(qBound(0, rule.crc, crc->count() - 1));
+    table->setCellWidget(row, 2, crc);
+    QSpinBox *delay = new QSpinBox(table);
+    delay->setRange(0, RESPONDER_MAX_DELAY);
+    delay->setValue(rule.delay);
+    table->setCellWidget(row, 3, delay);
+    connect(crc, &QComboBox::currentIndexChanged, this, &MainWindow::responderApply);
+    connect(delay, &QSpinBox::valueChanged, this, &MainWindow::responderApply);
+}
+
+Responder::Rules MainWindow::responderRules() const {
+    const QTableWidget *table = m_ui->tableWidgetResponder;
+    Responder::Rules rules;
+    for (int row = 0; row < table->rowCount(); ++row) {
+        const QTableWidgetItem *pattern = table->item(row, 0);
+        const QTableWidgetItem *reply = table->item(row, 1);
+        const QComboBox *crc = qobject_cast<QComboBox *>(table->cellWidget(row, 2));
+        const QSpinBox *delay = qobject_cast<QSpinBox *>(table->cellWidget(row, 3));
+        rules.append({pattern ? pattern->text() : QString(),
+                      reply ? reply->text() : QString(),
+                      crc ? crc->currentIndex() : 0,
+                      delay ? delay->value() : 0,
+                      pattern && pattern->checkState() == Qt::Checked});
+    }
+    return rules;
+}
+
+void MainWindow::responderApply() {
+    Responder::Rules rules;
+    if (m_ui->pushButtonResponder->isChecked()) {
+        rules = responderRules();
+        const QString error = Responder::validate(rules);
+        if (!error.isEmpty()) {
+            m_ui->statusBar->showMessage(error);
+            const QSignalBlocker blocker(m_ui->pushButtonResponder);
+            m_ui->pushButtonResponder->setChecked(false);
+            rules.clear();
         }
-        m_bytesToWrite += written;
-        m_timerWrite->start(m_settings.timeoutWrite);
     }
-    if (m_settings.localEcho) m_console->putData(convertData(data));
+    // автомат строится в потоке ввода-вывода, вместе с заменой правил
+    QMetaObject::invokeMethod(m_transport, [=]() { m_transport->setResponder(rules); });
 }
 
-void MainWindow::serialReadyRead() {
-    const QByteArray data = m_serial->readAll();
-    m_console->putData(convertData(data));
+void MainWindow::responderLoad() {
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Загрузить правила"), m_dir, tr("Текстовый документ (*.txt);;Все файлы (*.*)"));
+    if (fileName.isEmpty()) return;
+    Responder::Rules rules;
+    const QString error = Responder::load(fileName, rules);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, tr("Автоответчик"), error);
+        return;
+    }
+    m_ui->tableWidgetResponder->setRowCount(0);
+    for (const Responder::Rule &rule : std::as_const(rules)) responderAddRule(rule);
+    responderApply();
 }
 
-void MainWindow::serialErrorOccurred(QSerialPort::SerialPortError error) {
-    if (error == QSerialPort::ResourceError) {
-        QMessageBox::critical(this, tr("Критическая ошибка"), m_serial->errorString());
-        close();
+void MainWindow::responderSave() {
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Сохранить правила"), m_dir, tr("Текстовый документ (*.txt);;Все файлы (*.*)"));
+    if (fileName.isEmpty()) return;
+    const QString error = Responder::save(fileName, responderRules());
+    if (!error.isEmpty()) QMessageBox::warning(this, tr("Автоответчик"), error);
+}
+
+void MainWindow::updateLatency() {
+    const QVector<LatencyMeter::Entry> &entries = m_latency.entries();
+    QTableWidget *table = m_ui->tableWidgetLatency;
+    table->setRowCount(entries.size());
+    for (int row = 0; row < entries.size(); ++row) {
+        const LatencyHistogram &h = entries.at(row).histogram;
+        const QString cells[] = {
+            commandName(entries.at(row).command),
+            QString::number(h.count()),
+            QString::number(entries.at(row).lost),
+            QString::number(h.min() / 1000000.0, 'f', 3),
+            QString::number(h.percentile(50.0) / 1000000.0, 'f', 3),
+            QString::number(h.percentile(99.0) / 1000000.0, 'f', 3),
+            QString::number(h.max() / 1000000.0, 'f', 3)
+        };
+        for (int column = 0; column < table->columnCount(); ++column) {
+            QTableWidgetItem *item = table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem;
+                if (column > 0) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
     }
 }
 
+QString MainWindow::commandName(const QByteArray &command) const {
+    if (command.isEmpty()) return tr("Прочие");
+    for (int i = 0; i < m_commandControls.size(); ++i) {
+        if (m_commandControls.at(i).command == command) {
+            return QString("%1: %2").arg(i+1).arg(m_commandControls.at(i).lineEditCommand->text());
+        }
+    }
+    const HexFormatter::Options options = {false, false, 0};
+    return QString::fromLocal8Bit(HexFormatter::format(command.left(32), options));
+}
+
+void MainWindow::transportErrorOccurred(const QString &message) {
+    QMessageBox::critical(this, tr("Критическая ошибка"), message);
+}
+
 void MainWindow::showSettings() {
     if (isOpen()) close();
     m_settings.dtr = m_ui->actionDtr->isChecked();
     m_settings.rts = m_ui->actionRts->isChecked();
     DialogSettings ds(m_settings, this);
     QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    beginSession(settings);
     settings.beginGroup(strSettings);
     ds.restoreGeometry(settings.value(strGeometry).toByteArray());
     if (ds.exec() == QDialog::Accepted) {
         m_settings = ds.settings();
         settings.setValue(strGeometry, ds.saveGeometry());
+        m_console->setScrollback(qsizetype(m_settings.scrollback) * 1024 * 1024);
+        m_accumulator->setRate(m_settings.refreshRate);
+        m_converter.setSettings(m_settings);
+        m_sessionLog->setSettings(m_settings);
+        m_latency.setFramed(m_settings.framing != Connection::FrameNone);
         open();
     }
     settings.endGroup();
@@ -953,13 +1502,13 @@ void MainWindow::consoleContextMenu(const QPoint &pos) {
 void MainWindow::socketStateUpdate(QAbstractSocket::SocketState state) {
     QString status;
     switch (m_settings.type) {
-    case DialogSettings::Tcp:
+    case Connection::Tcp:
         status.append(QString("%1:%2").arg(m_settings.host).arg(m_settings.port));
         break;
-    case DialogSettings::UdpUnicast:
+    case Connection::UdpUnicast:
         status.append(QString("UDP:%1:%2").arg(m_settings.host).arg(m_settings.port));
         break;
-    case DialogSettings::UdpBroadcast:
+    case Connection::UdpBroadcast:
         status.append(QString("UDP:Broadcast:%1").arg(m_settings.port));
         break;
     default:
@@ -989,7 +1538,7 @@ void MainWindow::socketStateUpdate(QAbstractSocket::SocketState state) {
     updateStatus(status);
 }
 
-void MainWindow::socketErrorOccurred(QAbstractSocket::SocketError error) {
+void MainWindow::socketErrorOccurred(QAbstractSocket::SocketError error, const QString &message) {
     switch (error) {
     case QAbstractSocket::RemoteHostClosedError:
         QMessageBox::warning(this, tr("TCP-сокет"), tr("TCP-сервер закрыл соединение."));
@@ -1001,53 +1550,29 @@ void MainWindow::socketErrorOccurred(QAbstractSocket::SocketError error) {
         openError(tr("Соединение отклонено. Проверьте настройки TCP-сокета."));
         break;
     default:
-        QMessageBox::warning(this, tr("TCP-сокет"), tr("Произошла ошибка: %1.").arg(m_tcp->errorString()));
+        QMessageBox::warning(this, tr("TCP-сокет"), tr("Произошла ошибка: %1.").arg(message));
     }
     disconnected();
 }
 
-void MainWindow::socketReadyRead() {
-    const QByteArray data = m_tcp->readAll();
-    m_console->putData(convertData(data));
-}
-
-void MainWindow::udpReadyRead() {
-    QByteArray datagram;
-    while (m_udp->hasPendingDatagrams()) {
-        datagram.resize(qsizetype(m_udp->pendingDatagramSize()));
-        m_udp->readDatagram(datagram.data(), datagram.size());
-        m_console->putData(convertData(datagram));
-    }
-}
-
-void MainWindow::bytesWritten(qint64 bytes) {
-    m_bytesToWrite -= bytes;
-    if (m_bytesToWrite == 0) m_timerWrite->stop();
-}
-
-void MainWindow::writeTimeout() {
-    const QString error = tr("Таймаут записи в порт '%1'.\nОшибка: %2").arg(m_serial->portName(), m_serial->errorString());
-    showWriteError(error);
-}
-
 void MainWindow::serialStateUpdate() {
     QString status = m_settings.name;
-    status.append(statusSeparator).append(m_serial->isOpen() ? tr("Открыт") : tr("Закрыт"));
-    status.append(statusSeparator).append(QString::number(m_serial->baudRate()));
-    status.append(statusSeparator).append(QString::number(m_serial->dataBits()));
-    switch (m_serial->parity()) {
+    status.append(statusSeparator).append(isOpen() ? tr("Открыт") : tr("Закрыт"));
+    status.append(statusSeparator).append(QString::number(m_settings.baudRate));
+    status.append(statusSeparator).append(QString::number(m_settings.dataBits));
+    switch (m_settings.parity) {
     case QSerialPort::NoParity: status.append('N');break;
     case QSerialPort::EvenParity: status.append('E');break;
     case QSerialPort::OddParity: status.append('O');break;
     case QSerialPort::SpaceParity: status.append('S');break;
     case QSerialPort::MarkParity: status.append('M');break;
     }
-    switch (m_serial->stopBits()) {
+    switch (m_settings.stopBits) {
     case QSerialPort::OneStop: status.append(QStringLiteral("1"));break;
     case QSerialPort::OneAndHalfStop: status.append(QStringLiteral("1.5"));break;
     case QSerialPort::TwoStop: status.append(QStringLiteral("2"));break;
     }
-    switch (m_serial->flowControl()) {
+    switch (m_settings.flowControl) {
     case QSerialPort::NoFlowControl: status.append('N');break;
     case QSerialPort::HardwareControl: status.append('H');break;
     case QSerialPort::SoftwareControl: status.append('S');break;
@@ -1057,7 +1582,20 @@ void MainWindow::serialStateUpdate() {
 
 void MainWindow::updateStatus(QString &status) {
     m_labelStatus->setText(status);
-    setWindowTitle(QString("%1 - %2 v%3").arg(status, QCoreApplication::applicationName(), QCoreApplication::applicationVersion()));
+    setWindowTitle(status);                         // заголовок окна сессий
+}
+
+int MainWindow::session() const {
+    return m_session;
+}
+
+QString MainWindow::sessionGroup(int session) {
+    return session ? QString(strSession).arg(session) : QString();
+}
+
+// Параметры первой сессии - в корне, как до появления сессий
+void MainWindow::beginSession(QSettings &settings) const {
+    if (m_session) settings.beginGroup(sessionGroup(m_session));
 }
 
 void MainWindow::showWriteError(const QString &message) {
@@ -1066,6 +1604,7 @@ void MainWindow::showWriteError(const QString &message) {
 
 void MainWindow::readSettings() {
     QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    beginSession(settings);
 
     settings.beginGroup(strFind);
     m_find->restoreGeometry(settings.value(strGeometry).toByteArray());
@@ -1078,22 +1617,53 @@ void MainWindow::readSettings() {
     m_ui->spinBoxEnumerateDigits->setValue(settings.value(strDigits, 2).toInt());
     m_ui->spinBoxEnumerateFrom->setValue(settings.value(strFrom, 0).toInt());
     m_ui->spinBoxEnumerateTo->setValue(settings.value(strTo, 99).toInt());
-    m_ui->spinBoxEnumerateInterval->setValue(settings.value(strInterval, 50).toInt());
+    m_ui->spinBoxEnumerateInterval->setValue(settings.value(strInterval, 50).toDouble());
     m_ui->comboBoxEnumerateCrc->setCurrentIndex(settings.value(strCrc, 0).toInt());
+    m_ui->comboBoxEnumerateMode->setCurrentIndex(settings.value(strMode, 0).toInt());
+    m_ui->lineEditEnumerateResponse->setText(settings.value(strResponse, "").toString());
+    m_ui->spinBoxEnumerateWindow->setValue(settings.value(strWindow, 1).toInt());
+    m_ui->spinBoxEnumerateTimeout->setValue(settings.value(strTimeout, 100).toDouble());
+    settings.endGroup();
+    addrModeUpdate(m_ui->comboBoxEnumerateMode->currentIndex());
+
+    settings.beginGroup(strLatency);
+    m_ui->lineEditLatencyResponse->setText(settings.value(strResponse, "").toString());
+    m_ui->spinBoxLatencyTimeout->setValue(settings.value(strTimeout, 1000).toDouble());
+    m_ui->checkBoxLatency->setChecked(settings.value(strEnabled, false).toBool());
+    settings.endGroup();
+
+    settings.beginGroup(strBridge);
+    m_ui->comboBoxBridgeMode->setCurrentIndex(settings.value(strMode, Bridge::TcpServer).toInt());
+    m_ui->lineEditBridgeHost->setText(settings.value(strHost, DEFAULT_HOST).toString());
+    m_ui->spinBoxBridgePort->setValue(settings.value(strPort, DEFAULT_PORT).toInt());
+    m_ui->spinBoxBridgeTap->setValue(settings.value(strTap, 16).toInt());
     settings.endGroup();
 
+    settings.beginGroup(strResponder);
+    const int rules = settings.value(strCount, 0).toInt();
+    for (int i = 0; i < rules; ++i) {
+        responderAddRule({settings.value(QString(strPatternNum).arg(i+1)).toString(),
+                          settings.value(QString(strReplyNum).arg(i+1)).toString(),
+                          settings.value(QString(strCrcNum).arg(i+1), 0).toInt(),
+                          settings.value(QString(strDelayNum).arg(i+1), 0).toInt(),
+                          settings.value(QString(strEnabledNum).arg(i+1), true).toBool()});
+    }
+    m_ui->pushButtonResponder->setChecked(settings.value(strEnabled, false).toBool());
+    settings.endGroup();
+    responderApply();
+
     settings.beginGroup(strCommands);
     for (int i = 0; i < m_commandControls.size(); ++i) {
         m_commandControls[i].lineEditCommand->setText(settings.value(QString(strValueNum).arg(i+1), defaultCommand[i%COMMAND_HOT_COUNT]).toString());
         m_commandControls[i].comboBoxCrc->setCurrentIndex(settings.value(QString(strCrcNum).arg(i+1), 0).toInt());
-        m_commandControls[i].spinBoxInterval->setValue(settings.value(QString(strIntervalNum).arg(i+1), 1000).toInt());
+        m_commandControls[i].spinBoxInterval->setValue(settings.value(QString(strIntervalNum).arg(i+1), 1000).toDouble());
     }
     m_ui->checkBoxCrc->setChecked(settings.value(strCrc, true).toBool());
     m_ui->checkBoxInterval->setChecked(settings.value("Interval", true).toBool());
     settings.endGroup();
 
     settings.beginGroup(strSettings);
-    m_settings.type = static_cast<DialogSettings::ConnectionType>(settings.value(strType, DialogSettings::Serial).toInt());
+    m_settings.type = static_cast<Connection::Type>(settings.value(strType, Connection::Serial).toInt());
     m_settings.timeoutWrite = settings.value(strTimeoutWrite, DEFAULT_TIMEOUT_WRITE).toInt();
     m_settings.name = settings.value(strName, "").toString();
     m_settings.baudRate = settings.value(strBaud, QSerialPort::Baud38400).toInt();
@@ -1111,7 +1681,31 @@ void MainWindow::readSettings() {
     m_settings.linefeedChar = settings.value(strLinefeedChar, DEFAULT_LINEFEED_CHAR).toUInt();
     m_settings.localEcho = settings.value(strLocalEcho, true).toBool();
     m_settings.timeStamp = settings.value(strTimeStamp, false).toBool();
+    m_settings.timeDelta = settings.value(strTimeDelta, false).toBool();
+    m_settings.gapThreshold = settings.value(strGapThreshold, 0).toInt();
+    m_settings.scrollback = settings.value(strScrollback, DEFAULT_SCROLLBACK).toInt();
+    m_settings.refreshRate = settings.value(strRefreshRate, DEFAULT_REFRESH_RATE).toInt();
+    m_settings.framing = static_cast<Connection::Framing>(settings.value(strFraming, Connection::FrameNone).toInt());
+    m_settings.frameDelimiter = settings.value(strFrameDelimiter, DEFAULT_FRAME_DELIMITER).toString();
+    m_settings.frameLengthOffset = settings.value(strFrameLengthOffset, 0).toInt();
+    m_settings.frameLengthSize = settings.value(strFrameLengthSize, 1).toInt();
+    m_settings.frameLengthBigEndian = settings.value(strFrameLengthBigEndian, false).toBool();
+    m_settings.frameLengthAdjust = settings.value(strFrameLengthAdjust, 0).toInt();
+    m_settings.frameGap = settings.value(strFrameGap, DEFAULT_FRAME_GAP).toInt();
+    m_settings.frameCrc = settings.value(strFrameCrc, 0).toInt();
+    m_settings.sessionLog = settings.value(strSessionLog, false).toBool();
+    m_settings.sessionLogDir = settings.value(strSessionLogDir,
+        QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QString("/logs/%1").arg(m_session)).toString();
+    m_settings.sessionLogSegmentSize = settings.value(strSessionLogSegmentSize, DEFAULT_SESSION_LOG_SEGMENT_SIZE).toInt();
+    m_settings.sessionLogSegmentTime = settings.value(strSessionLogSegmentTime, DEFAULT_SESSION_LOG_SEGMENT_TIME).toInt();
+    m_settings.sessionLogKeep = settings.value(strSessionLogKeep, DEFAULT_SESSION_LOG_KEEP).toInt();
+    m_settings.sessionLogCompress = settings.value(strSessionLogCompress, false).toBool();
     settings.endGroup();
+    m_console->setScrollback(qsizetype(m_settings.scrollback) * 1024 * 1024);
+    m_accumulator->setRate(m_settings.refreshRate);
+    m_converter.setSettings(m_settings);
+    m_sessionLog->setSettings(m_settings);
+    m_latency.setFramed(m_settings.framing != Connection::FrameNone);
 
     settings.beginGroup(strWindow);
     restoreGeometry(settings.value(strGeometry).toByteArray());
@@ -1128,6 +1722,7 @@ void MainWindow::readSettings() {
 
 void MainWindow::writeSettings() {
     QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    beginSession(settings);
 
     settings.beginGroup(strWindow);
     settings.setValue(strGeometry, saveGeometry());
@@ -1148,6 +1743,44 @@ void MainWindow::writeSettings() {
     settings.setValue(strTo, m_ui->spinBoxEnumerateTo->value());
     settings.setValue(strInterval, m_ui->spinBoxEnumerateInterval->value());
     settings.setValue(strCrc, m_ui->comboBoxEnumerateCrc->currentIndex());
+    settings.setValue(strMode, m_ui->comboBoxEnumerateMode->currentIndex());
+    settings.setValue(strResponse, m_ui->lineEditEnumerateResponse->text());
+    settings.setValue(strWindow, m_ui->spinBoxEnumerateWindow->value());
+    settings.setValue(strTimeout, m_ui->spinBoxEnumerateTimeout->value());
+    settings.endGroup();
+
+    settings.beginGroup(strLatency);
+    settings.setValue(strResponse, m_ui->lineEditLatencyResponse->text());
+    settings.setValue(strTimeout, m_ui->spinBoxLatencyTimeout->value());
+    settings.setValue(strEnabled, m_ui->checkBoxLatency->isChecked());
+    settings.endGroup();
+
+    settings.beginGroup(strBridge);
+    settings.setValue(strMode, m_ui->comboBoxBridgeMode->currentIndex());
+    settings.setValue(strHost, m_ui->lineEditBridgeHost->text());
+    settings.setValue(strPort, m_ui->spinBoxBridgePort->value());
+    settings.setValue(strTap, m_ui->spinBoxBridgeTap->value());
+    settings.endGroup();
+
+    settings.beginGroup(strResponder);
+    const Responder::Rules rules = responderRules();
+    const int count = settings.value(strCount, 0).toInt();
+    for (int i = rules.size(); i < count; ++i) {
+        settings.remove(QString(strPatternNum).arg(i+1));
+        settings.remove(QString(strReplyNum).arg(i+1));
+        settings.remove(QString(strCrcNum).arg(i+1));
+        settings.remove(QString(strDelayNum).arg(i+1));
+        settings.remove(QString(strEnabledNum).arg(i+1));
+    }
+    settings.setValue(strCount, rules.size());
+    for (int i = 0; i < rules.size(); ++i) {
+        settings.setValue(QString(strPatternNum).arg(i+1), rules.at(i).pattern);
+        settings.setValue(QString(strReplyNum).arg(i+1), rules.at(i).reply);
+        settings.setValue(QString(strCrcNum).arg(i+1), rules.at(i).crc);
+        settings.setValue(QString(strDelayNum).arg(i+1), rules.at(i).delay);
+        settings.setValue(QString(strEnabledNum).arg(i+1), rules.at(i).enabled);
+    }
+    settings.setValue(strEnabled, m_ui->pushButtonResponder->isChecked());
     settings.endGroup();
 
     settings.beginGroup(strCommands);
@@ -1180,6 +1813,24 @@ void MainWindow::writeSettings() {
     settings.setValue(strLinefeedChar, m_settings.linefeedChar);
     settings.setValue(strLocalEcho, m_settings.localEcho);
     settings.setValue(strTimeStamp, m_settings.timeStamp);
+    settings.setValue(strTimeDelta, m_settings.timeDelta);
+    settings.setValue(strGapThreshold, m_settings.gapThreshold);
+    settings.setValue(strScrollback, m_settings.scrollback);
+    settings.setValue(strRefreshRate, m_settings.refreshRate);
+    settings.setValue(strFraming, m_settings.framing);
+    settings.setValue(strFrameDelimiter, m_settings.frameDelimiter);
+    settings.setValue(strFrameLengthOffset, m_settings.frameLengthOffset);
+    settings.setValue(strFrameLengthSize, m_settings.frameLengthSize);
+    settings.setValue(strFrameLengthBigEndian, m_settings.frameLengthBigEndian);
+    settings.setValue(strFrameLengthAdjust, m_settings.frameLengthAdjust);
+    settings.setValue(strFrameGap, m_settings.frameGap);
+    settings.setValue(strFrameCrc, m_settings.frameCrc);
+    settings.setValue(strSessionLog, m_settings.sessionLog);
+    settings.setValue(strSessionLogDir, m_settings.sessionLogDir);
+    settings.setValue(strSessionLogSegmentSize, m_settings.sessionLogSegmentSize);
+    settings.setValue(strSessionLogSegmentTime, m_settings.sessionLogSegmentTime);
+    settings.setValue(strSessionLogKeep, m_settings.sessionLogKeep);
+    settings.setValue(strSessionLogCompress, m_settings.sessionLogCompress);
     settings.endGroup();
 
     settings.setValue(strDirectory, m_dir);
@@ -1187,8 +1838,7 @@ void MainWindow::writeSettings() {
     settings.setValue(strConnected, isOpen());
 }
 
-void MainWindow::readSerialSignals() {
-    auto ps = m_serial->pinoutSignals();
+void MainWindow::readSerialSignals(QSerialPort::PinoutSignals ps) {
     m_labelLedCts->setLed(ps & QSerialPort::ClearToSendSignal);
     m_labelLedDsr->setLed(ps & QSerialPort::DataSetReadySignal);
     m_labelLedCd->setLed(ps & QSerialPort::DataCarrierDetectSignal);
@@ -1198,10 +1848,5 @@ void MainWindow::readSerialSignals() {
 }
 
 bool MainWindow::isOpen() const {
-    switch (m_settings.type) {
-    case DialogSettings::Tcp: return m_tcp->isOpen(); break;
-    case DialogSettings::UdpUnicast:
-    case DialogSettings::UdpBroadcast: return (m_udp->state() == QAbstractSocket::BoundState);
-    default: return m_serial->isOpen();
-    }
+    return m_transport->isOpen();
 }
@@ -3,15 +3,25 @@
 
 #include <QMainWindow>
 #include <QSerialPort>
-#include <QTcpSocket>
-#include <QUdpSocket>
+#include <QAbstractSocket>
 #include <QSettings>
 #include "settings.h"
+#include "transport.h"
 #include "console.h"
 #include "find.h"
 #include "actionbutton.h"
 #include "labelled.h"
 #include "crc.h"
+#include "accumulator.h"
+#include "filesender.h"
+#include "hexformatter.h"
+#include "scheduler.h"
+#include "enumerator.h"
+#include "latency.h"
+#include "command.h"
+#include "converter.h"
+#include "bridge.h"
+#include "sessionlog.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -20,8 +30,11 @@ class QLineEdit;
 class QToolButton;
 class QAction;
 class QSpinBox;
+class QDoubleSpinBox;
 class QTimer;
 class QComboBox;
+class QThread;
+class IoPool;
 
 namespace Ui {
 class MainWindow;
@@ -35,10 +48,12 @@ class MainWindow : public QMainWindow
 
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(IoPool *pool, int session = 0, QWidget *parent = nullptr);
     ~MainWindow();
 
     bool isOpen() const;
+    int session() const;
+    static QString sessionGroup(int session);       // группа параметров сессии, для первой - пусто
 
 private slots:
     void openFile();
@@ -58,17 +73,16 @@ private slots:
     void connected();
     void disconnected();
 
-    void serialReadyRead();
-    void serialErrorOccurred(QSerialPort::SerialPortError error);
+    void transportReadyRead();
+    void sendFileProgress(qint64 written, qint64 total);
+    void sendFileFinished(bool completed);
+    void setCapture(bool enabled);
+    void captureError(const QString &message);
+    void replayCapture();
+    void transportErrorOccurred(const QString &message);
 
     void socketStateUpdate(QAbstractSocket::SocketState state);
-    void socketErrorOccurred(QAbstractSocket::SocketError error);
-    void socketReadyRead();
-
-    void udpReadyRead();
-
-    void bytesWritten(qint64 bytes);
-    void writeTimeout();
+    void socketErrorOccurred(QAbstractSocket::SocketError error, const QString &message);
 
 private:
     void serialStateUpdate();
@@ -77,6 +91,7 @@ private:
 
     void readSettings();
     void writeSettings();
+    void beginSession(QSettings &settings) const;
 
     Ui::MainWindow *m_ui = nullptr;
     Console *m_console = nullptr;
@@ -91,17 +106,24 @@ private:
     LabelLed *m_labelLedRi = nullptr;
     LabelLed *m_labelLedStd = nullptr;
     LabelLed *m_labelLedSrd = nullptr;
-    QTimer *m_timerSerialSignals = nullptr;
-    void readSerialSignals();
-
-    DialogSettings::Settings m_settings;
-    qint64 m_bytesToWrite = 0;
-    QTimer *m_timerWrite = nullptr;
-    QTimer *m_timerAddr = nullptr;
-    QSerialPort *m_serial = nullptr;
-    QTcpSocket *m_tcp = nullptr;
-    QUdpSocket *m_udp = nullptr;
+    void readSerialSignals(QSerialPort::PinoutSignals pinout);
+
+    int m_session;
+    Connection::Settings m_settings;
+    Scheduler *m_scheduler = nullptr;
+    IoPool *m_pool = nullptr;
+    QThread *m_threadIo = nullptr;                  // из m_pool
+    Transport *m_transport = nullptr;
+    Accumulator *m_accumulator = nullptr;
     Crc *m_crc = nullptr;
+    FileSender *m_fileSender = nullptr;
+    Enumerator *m_enumerator = nullptr;
+    QTimer *m_timerReplay = nullptr;
+    CaptureReader m_replay;
+    qint64 m_replayPage = 0;                        // байт данных, осталось вывести на странице
+    void replayNextPage(int value);
+    LatencyMeter m_latency;
+    QTimer *m_timerLatency = nullptr;
     QString m_dir;
 
 
@@ -110,23 +132,52 @@ private:
         QLineEdit *lineEditCommand;
         ActionButton *actionButtonSend;
         QAction *actionSend;
-        QSpinBox *spinBoxInterval;
+        QDoubleSpinBox *spinBoxInterval;            // мс
         ActionButton *actionButtonSendInterval;
         QAction *actionSendInterval;
-        QTimer *timer;
         QComboBox *comboBoxCrc;
+        QByteArray command;                         // команда с CRC, готовая к отправке
     } CommandControls;
 
     QVector<CommandControls> m_commandControls;
 
-    QByteArray strToCmd(QString value);
-    QByteArray convertData(const QByteArray &data);
+    void compileCommand(int idx);
+    Converter m_converter;
+    void openCapture(const QString &fileName);
 
     int m_addr;
-    QByteArray addrToCmd(QString value);
-    QByteArray addrToBin(int value, int digits, QDataStream::ByteOrder byteOrder);
     void addrRangeUpdate(int type, int digits);
     void addrStart(bool value);
+    void addrModeUpdate(int mode);
+    void addrFinished();
+    void addrExport();
+
+    void updateLatency();
+    QString commandName(const QByteArray &command) const;
+
+    Bridge *m_bridge = nullptr;                     // в m_threadIo
+    QTimer *m_timerBridge = nullptr;
+    QString m_bridgePeer;
+    void bridgeStart(bool enabled);
+    void bridgeStateUpdate(bool active);
+    void bridgeReadyRead();
+    void updateBridge();
+
+    QTimer *m_timerStatistics = nullptr;
+    Transport::Statistics m_statistics;             // предыдущий отсчёт
+    qint64 m_statisticsTime = 0;                    // Timestamp::now() предыдущего отсчёта
+    QVector<double> m_statisticsPeak;               // по строкам tableWidgetStatistics
+    void updateStatistics();
+    void resetStatistics();
+
+    void responderAddRule(const Responder::Rule &rule);
+    Responder::Rules responderRules() const;
+    void responderApply();                          // передать правила транспорту
+    void responderLoad();
+    void responderSave();
+
+    SessionLog *m_sessionLog = nullptr;             // свой поток записи
+    void sessionLogError(const QString &message);
 
     void setToolStatusTip(QAction *widget, QString tip = "");
 };
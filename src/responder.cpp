@@ -0,0 +1,183 @@
+#include "responder.h"
+#include "command.h"
+#include "crc.h"
+
+#include <QFile>
+#include <QObject>
+#include <QStringList>
+#include <algorithm>
+
+void Responder::setRules(const Rules &rules) {
+    Crc crc;
+    m_actions.clear();
+    m_stride = classify(rules, m_classes);
+    const size_t stride = size_t(m_stride);
+    m_next.assign(stride, -1);
+    std::vector<std::vector<qint32>> outputs(1);
+
+    // бор образцов
+    for (int i = 0; i < rules.size(); ++i) {
+        const Rule &rule = rules.at(i);
+        QByteArray reply = Command::fromString(rule.reply);
+        m_actions.append({crc.addCrc(reply, uint(qMax(rule.crc, 0))), qMax(rule.delay, 0)});
+        const QByteArray pattern = Command::fromString(rule.pattern);
+        if (!rule.enabled || pattern.isEmpty()) continue;
+        qint32 state = 0;
+        for (const char c : pattern) {
+            const size_t cls = m_classes[uchar(c)];
+            qint32 &next = m_next[size_t(state) * stride + cls];
+            if (next < 0) {
+                next = qint32(outputs.size());
+                outputs.emplace_back();
+                m_next.resize(m_next.size() + stride, -1);
+            }
+            state = m_next[size_t(state) * stride + cls]; // resize мог переместить таблицу
+        }
+        outputs[state].push_back(i);
+    }
+
+    // обход в ширину: ссылки неудачи заменяются прямыми переходами,
+    // совпадения состояния дополняются совпадениями его суффикса
+    const size_t states = outputs.size();
+    std::vector<qint32> fail(states, 0);
+    std::vector<qint32> queue;
+    queue.reserve(states);
+    for (size_t c = 0; c < stride; ++c) {
+        qint32 &next = m_next[c];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.push_back(next);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const qint32 state = queue[head];
+        const std::vector<qint32> &suffix = outputs[fail[state]];
+        outputs[state].insert(outputs[state].end(), suffix.begin(), suffix.end());
+        for (size_t c = 0; c < stride; ++c) {
+            qint32 &next = m_next[size_t(state) * stride + c];
+            const qint32 fallback = m_next[size_t(fail[state]) * stride + c];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    m_outputBegin.assign(states + 1, 0);
+    m_outputs.clear();
+    for (size_t state = 0; state < states; ++state) {
+        std::sort(outputs[state].begin(), outputs[state].end()); // одновременные совпадения - в порядке правил
+        m_outputs.insert(m_outputs.end(), outputs[state].begin(), outputs[state].end());
+        m_outputBegin[state + 1] = qint32(m_outputs.size());
+    }
+    reset();
+}
+
+bool Responder::isEmpty() const {
+    return m_outputs.empty();
+}
+
+void Responder::reset() {
+    m_state = 0;
+}
+
+void Responder::feed(const char *data, qsizetype size, QVector<int> &matches) {
+    if (isEmpty()) return;
+    const qint32 *next = m_next.data();
+    const qint32 *begin = m_outputBegin.data();
+    const quint16 *classes = m_classes.data();
+    const size_t stride = size_t(m_stride);
+    qint32 state = m_state;
+    for (const char *end = data + size; data < end; ++data) {
+        state = next[size_t(state) * stride + classes[uchar(*data)]];
+        for (qint32 k = begin[state]; k < begin[state + 1]; ++k) matches.append(m_outputs[size_t(k)]);
+    }
+    m_state = state;
+}
+
+const Responder::Action &Responder::action(int idx) const {
+    return m_actions.at(idx);
+}
+
+QString Responder::validate(const Rules &rules) {
+    qint64 total = 0;
+    for (const Rule &rule : rules) {
+        if (rule.enabled) total += Command::fromString(rule.pattern).size();
+    }
+    Classes classes;
+    const int stride = classify(rules, classes);
+    if ((total + 1) * stride > RESPONDER_MAX_TABLE) {   // состояний не больше, чем байт в образцах, и корень
+        return QObject::tr("Слишком длинные образцы: %1 байт из %2 разных значений, таблица переходов превысит %3 МБ")
+            .arg(total).arg(stride - 1).arg(RESPONDER_MAX_TABLE * sizeof(qint32) / (1024 * 1024));
+    }
+    return QString();
+}
+
+int Responder::classify(const Rules &rules, Classes &classes) {
+    classes.fill(0);
+    int count = 1;
+    for (const Rule &rule : rules) {
+        if (!rule.enabled) continue;
+        for (const char c : Command::fromString(rule.pattern)) {
+            if (!classes[uchar(c)]) classes[uchar(c)] = quint16(count++);
+        }
+    }
+    return count;
+}
+
+QString Responder::load(const QString &fileName, Rules &rules) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QObject::tr("Ошибка открытия '%1': %2").arg(fileName, file.errorString());
+    }
+    const QStringList crcList = Crc().list();
+    Rules result;
+    int number = 0;
+    while (!file.atEnd()) {
+        ++number;
+        QString line = QString::fromLocal8Bit(file.readLine()).remove('\n').remove('\r');
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        const bool enabled = !line.startsWith('!');
+        if (!enabled) line.remove(0, 1);
+        const QStringList fields = line.split('\t');
+        Rule rule = {fields.value(0), fields.value(1), 0, 0, enabled};
+        bool ok = (fields.size() >= 2) && !rule.pattern.isEmpty();
+        if (ok && fields.size() > 2) rule.delay = fields.at(2).toInt(&ok);
+        if (ok && fields.size() > 3) {
+            rule.crc = crcList.indexOf(fields.at(3));
+            ok = (rule.crc >= 0);
+        }
+        if (!ok || rule.delay < 0) {
+            return QObject::tr("'%1', строка %2: ожидается образец<TAB>ответ[<TAB>задержка, мс[<TAB>CRC]]").arg(fileName).arg(number);
+        }
+        result.append(rule);
+    }
+    rules = result;
+    return validate(rules);
+}
+
+QString Responder::save(const QString &fileName, const Rules &rules) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        return QObject::tr("Ошибка записи в '%1': %2").arg(fileName, file.errorString());
+    }
+    const QStringList crcList = Crc().list();
+    QByteArray text;
+    for (const Rule &rule : rules) {
+        QString pattern = rule.pattern;
+        if (pattern.startsWith('#') || pattern.startsWith('!')) {   // первый символ - кодом, чтобы не стал признаком
+            pattern.replace(0, 1, QStringLiteral("\\%1").arg(pattern.at(0).unicode(), 2, 16, QLatin1Char('0')));
+        }
+        QString line = pattern + '\t' + rule.reply + '\t' + QString::number(rule.delay);
+        if (rule.crc > 0) line += '\t' + crcList.value(rule.crc);
+        if (!rule.enabled) line.prepend('!');
+        text.append(line.toLocal8Bit()).append('\n');
+    }
+    if (file.write(text) != text.size()) {
+        return QObject::tr("Ошибка записи в '%1': %2").arg(fileName, file.errorString());
+    }
+    return QString();
+}
@@ -0,0 +1,62 @@
+#ifndef RESPONDER_H
+#define RESPONDER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <vector>
+
+#define RESPONDER_MAX_TABLE     (4 * 1024 * 1024)   // переходов в таблице автомата (по 4 байта): состояний * классов байт
+
+// Автоответчик: "в приёме встретился образец - через задержку отправить ответ".
+// Образцы всех правил компилируются в один автомат Ахо-Корасик с полной таблицей переходов:
+// поток приёма проверяется за один переход на байт, без возвратов и через границы блоков.
+// Столбцы таблицы - не байты, а классы: каждый байт из образцов - свой класс, все прочие - общий нулевой.
+class Responder
+{
+public:
+    // Правило в виде, в котором его задаёт пользователь
+    typedef struct {
+        QString pattern;                            // \XX - байт, как в командах
+        QString reply;
+        int crc;                                    // индекс в Crc::list(), добавляется к ответу
+        int delay;                                  // мс
+        bool enabled;
+    } Rule;
+
+    typedef QVector<Rule> Rules;
+
+    // Подготовленный ответ
+    typedef struct {
+        QByteArray reply;                           // с CRC
+        int delay;
+    } Action;
+
+    void setRules(const Rules &rules);
+    bool isEmpty() const;
+    void reset();                                   // начало потока
+    // номера правил, образцы которых закончились в блоке, - в matches, в порядке байт
+    void feed(const char *data, qsizetype size, QVector<int> &matches);
+    const Action &action(int idx) const;
+
+    static QString validate(const Rules &rules);    // пусто - правила допустимы
+    // Файл правил: строка - образец<TAB>ответ[<TAB>задержка, мс[<TAB>CRC]], # - комментарий, ! - правило выключено
+    static QString load(const QString &fileName, Rules &rules); // пусто - успешно
+    static QString save(const QString &fileName, const Rules &rules);
+
+private:
+    typedef std::array<quint16, 256> Classes;       // байт -> класс
+
+    static int classify(const Rules &rules, Classes &classes); // число классов
+
+    QVector<Action> m_actions;                      // по номерам правил
+    Classes m_classes{};
+    int m_stride = 1;                               // число классов
+    std::vector<qint32> m_next;                     // состояние * m_stride + класс -> состояние
+    std::vector<qint32> m_outputBegin;              // совпадения состояния: m_outputs[begin[s]..begin[s + 1])
+    std::vector<qint32> m_outputs;
+    qint32 m_state = 0;
+};
+
+#endif // RESPONDER_H
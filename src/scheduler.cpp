@@ -0,0 +1,155 @@
+#include "scheduler.h"
+#include "timestamp.h"
+
+#include <QDeadlineTimer>
+#include <cmath>
+
+static Scheduler::Stats makeStats(qint64 count, qint64 missed, qint64 min, qint64 max, double sum, double sumSq) {
+    Scheduler::Stats s = {count, missed, 0, 0, 0.0, 0.0};
+    if (count > 0) {
+        s.min = min;
+        s.max = max;
+        s.mean = sum / count;
+        s.stddev = std::sqrt(qMax(0.0, sumSq / count - s.mean * s.mean));
+    }
+    return s;
+}
+
+Scheduler::Scheduler(QObject *parent):
+    QThread(parent)
+{
+    start(QThread::TimeCriticalPriority);
+}
+
+Scheduler::~Scheduler() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_wake.wakeAll();
+    }
+    wait();
+}
+
+void Scheduler::schedule(int id, qint64 interval, const QByteArray &data) {
+    QMutexLocker locker(&m_mutex);
+    Entry entry = {};
+    entry.interval = qMax<qint64>(interval, 1);
+    entry.deadline = Timestamp::now() + entry.interval; // первое срабатывание - через интервал, как у QTimer
+    entry.data = data;
+    m_entries.insert(id, entry);
+    m_finished.remove(id);
+    m_wake.wakeAll();
+}
+
+void Scheduler::setData(int id, const QByteArray &data) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(id);
+    if (it != m_entries.end()) it->data = data;
+}
+
+void Scheduler::setInterval(int id, qint64 interval) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) return;
+    // новый интервал отсчитывается от последнего срабатывания
+    it->deadline += qMax<qint64>(interval, 1) - it->interval;
+    it->interval = qMax<qint64>(interval, 1);
+    m_wake.wakeAll();
+}
+
+void Scheduler::cancel(int id) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) return;
+    m_finished.insert(id, makeStats(it->count, it->missed, it->min, it->max, it->sum, it->sumSq));
+    m_entries.erase(it);
+    m_wake.wakeAll();
+}
+
+void Scheduler::cancelAll() {
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        m_finished.insert(it.key(), makeStats(it->count, it->missed, it->min, it->max, it->sum, it->sumSq));
+    }
+    m_entries.clear();
+    m_wake.wakeAll();
+}
+
+bool Scheduler::isActive(int id) const {
+    QMutexLocker locker(&m_mutex);
+    return m_entries.contains(id);
+}
+
+Scheduler::Stats Scheduler::stats(int id) const {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(id);
+    if (it != m_entries.cend()) return makeStats(it->count, it->missed, it->min, it->max, it->sum, it->sumSq);
+    return m_finished.value(id, makeStats(0, 0, 0, 0, 0.0, 0.0));
+}
+
+QString Scheduler::statsToString(const Stats &stats) {
+    return tr("отправлено %1, опоздание: ср. %2 мкс, σ %3 мкс, мин. %4 мкс, макс. %5 мкс, пропущено %6")
+            .arg(stats.count)
+            .arg(stats.mean / 1000.0, 0, 'f', 1)
+            .arg(stats.stddev / 1000.0, 0, 'f', 1)
+            .arg(stats.min / 1000.0, 0, 'f', 1)
+            .arg(stats.max / 1000.0, 0, 'f', 1)
+            .arg(stats.missed);
+}
+
+void Scheduler::run() {
+    QVector<QByteArray> sends;
+    QVector<int> timeouts;
+    QMutexLocker locker(&m_mutex);
+    while (!m_quit) {
+        qint64 next = -1;
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            if (next < 0 || it->deadline < next) next = it->deadline;
+        }
+        if (next < 0) {
+            m_wake.wait(&m_mutex);
+            continue;
+        }
+
+        qint64 now = Timestamp::now();
+        if (next - now > SCHEDULER_SPIN) {
+            // сон до начала активного участка; изменения расписания будят поток
+            QDeadlineTimer deadline(Qt::PreciseTimer);
+            deadline.setPreciseRemainingTime(0, next - now - SCHEDULER_SPIN, Qt::PreciseTimer);
+            m_wake.wait(&m_mutex, deadline);
+            continue;
+        }
+        if (now < next) {
+            locker.unlock();
+            while (Timestamp::now() < next) QThread::yieldCurrentThread();
+            locker.relock();
+            now = Timestamp::now();
+        }
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->deadline > now) continue;
+            const qint64 late = now - it->deadline;
+            it->min = it->count ? qMin(it->min, late) : late;
+            it->max = it->count ? qMax(it->max, late) : late;
+            it->sum += late;
+            it->sumSq += double(late) * late;
+            it->count++;
+            // опоздание больше интервала - пропуск сроков без «догоняющей» пачки
+            const qint64 skipped = late / it->interval;
+            it->missed += skipped;
+            it->deadline += (skipped + 1) * it->interval;
+            if (it->data.isEmpty()) {
+                timeouts.append(it.key());
+            } else {
+                sends.append(it->data);
+            }
+        }
+
+        locker.unlock();
+        for (const QByteArray &data : std::as_const(sends)) emit send(data);
+        for (int id : std::as_const(timeouts)) emit timeout(id);
+        sends.clear();
+        timeouts.clear();
+        locker.relock();
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+
+#define SCHEDULER_SPIN          200000              // нс, последний участок ожидания - активный
+
+// Единый планировщик циклических отправок в отдельном потоке.
+// Сроки абсолютные (монотонное время Timestamp): следующий = предыдущий срок + интервал,
+// поэтому задержки отдельных срабатываний не накапливаются.
+class Scheduler : public QThread
+{
+    Q_OBJECT
+
+public:
+    // Опоздание срабатывания относительно срока, нс
+    typedef struct {
+        qint64 count;                               // срабатываний
+        qint64 missed;                              // пропущено сроков (опоздание больше интервала)
+        qint64 min;
+        qint64 max;
+        double mean;
+        double stddev;
+    } Stats;
+
+    explicit Scheduler(QObject *parent = nullptr);
+    ~Scheduler();
+
+    // data - отправлять из потока планировщика (сигнал send), пустые - сигнал timeout(id)
+    void schedule(int id, qint64 interval, const QByteArray &data = QByteArray());
+    void setData(int id, const QByteArray &data);
+    void setInterval(int id, qint64 interval);      // нс
+    void cancel(int id);
+    void cancelAll();
+
+    bool isActive(int id) const;
+    Stats stats(int id) const;
+    static QString statsToString(const Stats &stats);
+
+signals:
+    void send(const QByteArray &data);
+    void timeout(int id);
+
+protected:
+    void run() override;
+
+private:
+    typedef struct {
+        qint64 interval;
+        qint64 deadline;
+        QByteArray data;
+        qint64 count;
+        qint64 missed;
+        qint64 min;
+        qint64 max;
+        double sum;
+        double sumSq;
+    } Entry;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QHash<int, Entry> m_entries;
+    QHash<int, Stats> m_finished;                   // статистика остановленных
+    bool m_quit = false;
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,152 @@
+#include "searcher.h"
+
+#include <QMutexLocker>
+
+Searcher::Searcher(QObject *parent):
+    QObject(parent),
+    m_buffer(1)
+{
+}
+
+int Searcher::restart() {
+    return m_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+bool Searcher::read(Batch &batch) {
+    QMutexLocker locker(&m_mutex);
+    if (m_batches.empty()) {
+        m_notified = false;
+        return false;
+    }
+    batch = std::move(m_batches.front());
+    m_batches.pop_front();
+    return true;
+}
+
+void Searcher::start(const LineBuffer &snapshot, const QRegularExpression &re, int generation) {
+    m_buffer = snapshot;                            // даже для устаревшего поколения: следом может прийти rescan()
+    m_log.reset();
+    if (!isCurrent(generation)) return;
+    m_re = re;
+    m_re.optimize();                                // компиляция (JIT) один раз на поиск
+    m_next = 0;
+    scan(generation);
+}
+
+void Searcher::rescan(const QRegularExpression &re, int generation) {
+    if (!isCurrent(generation)) return;
+    m_re = re;
+    m_re.optimize();
+    m_next = 0;
+    scan(generation);
+}
+
+void Searcher::startLog(const LogFile::MappingPtr &log, const QRegularExpression &re, int generation) {
+    if (!isCurrent(generation)) return;
+    m_buffer = LineBuffer(1);
+    m_log = log;
+    m_re = re;
+    m_re.optimize();
+    scanLog(generation);
+    m_log.reset();
+}
+
+void Searcher::append(const QByteArray &data, int generation) {
+    m_buffer.append(data);                          // устаревшее поколение не просматривает, но копию ведёт
+    if (isCurrent(generation)) scan(generation);
+}
+
+void Searcher::clear() {
+    m_buffer.clear();
+    m_next = 0;
+}
+
+void Searcher::setCapacity(qsizetype capacity) {
+    m_buffer.setCapacity(capacity);
+    m_next = 0;
+}
+
+void Searcher::stop(int generation) {
+    if (!isCurrent(generation)) return;
+    m_buffer = LineBuffer(1);
+    m_log.reset();
+    m_re = QRegularExpression();
+}
+
+bool Searcher::isCurrent(int generation) const {
+    return m_generation.load(std::memory_order_acquire) == generation;
+}
+
+void Searcher::scan(int generation) {
+    const qint64 first = m_buffer.droppedLines();
+    const qint64 last = first + m_buffer.lineCount() - 1;
+    qint64 line = qMax(m_next, first);
+    Batch batch = {generation, line, Matches(), line, false};
+
+    for (; line <= last; ++line) {
+        if (line - batch.from >= SEARCHER_BATCH_LINES) {
+            if (!isCurrent(generation)) return;     // новый поиск - результаты не нужны
+            batch.scanned = line;
+            const qint64 next = line;
+            push(std::move(batch));
+            batch = {generation, next, Matches(), next, false};
+        }
+        const QString text = QString::fromLocal8Bit(m_buffer.line(line - first));
+        QRegularExpressionMatchIterator it = m_re.globalMatch(text);
+        while (it.hasNext()) {
+            const QRegularExpressionMatch match = it.next();
+            if (match.capturedLength() > 0) batch.matches.append({line, int(match.capturedStart()), int(match.capturedLength())});
+        }
+    }
+
+    // последняя строка может дополниться - при следующем поступлении она просматривается заново
+    m_next = last;
+    batch.scanned = last;
+    batch.done = true;
+    push(std::move(batch));
+}
+
+// Файл не дополняется: строки просматриваются подряд, без индекса
+void Searcher::scanLog(int generation) {
+    const char *data = m_log->data;
+    const qint64 size = m_log->size;
+    qint64 pos = 0;
+    qint64 nl = -1;
+    qint64 line = 0;
+    Batch batch = {generation, 0, Matches(), 0, false};
+
+    for (;; ++line) {
+        if (line - batch.from >= SEARCHER_BATCH_LINES) {
+            if (!isCurrent(generation)) return;
+            batch.scanned = line;
+            const qint64 next = line;
+            push(std::move(batch));
+            batch = {generation, next, Matches(), next, false};
+        }
+        const qint64 next = LogFile::nextLine(data, size, pos, nl);
+        const qint64 end = LogFile::lineEnd(data, pos, (next < 0) ? size : next);
+        const QString text = QString::fromLocal8Bit(data + pos, end - pos);
+        QRegularExpressionMatchIterator it = m_re.globalMatch(text);
+        while (it.hasNext()) {
+            const QRegularExpressionMatch match = it.next();
+            if (match.capturedLength() > 0) batch.matches.append({line, int(match.capturedStart()), int(match.capturedLength())});
+        }
+        if (next < 0) break;
+        pos = next;
+    }
+
+    batch.scanned = line + 1;
+    batch.done = true;
+    push(std::move(batch));
+}
+
+void Searcher::push(Batch &&batch) {
+    bool notify;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_batches.push_back(std::move(batch));
+        notify = !m_notified;
+        m_notified = true;
+    }
+    if (notify) emit readyRead();
+}
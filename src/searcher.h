@@ -0,0 +1,77 @@
+#ifndef SEARCHER_H
+#define SEARCHER_H
+
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QRegularExpression>
+#include <atomic>
+#include <deque>
+#include "linebuffer.h"
+#include "logfile.h"
+
+#define SEARCHER_BATCH_LINES    4096                // строк между проверкой отмены и передачей результатов
+
+// Поиск в отдельном потоке по копии буфера консоли.
+// Копия снимается один раз при начале поиска и дальше дополняется и очищается вместе с консолью,
+// поэтому номера строк совпадают, новые данные просматриваются по мере поступления,
+// а смена образца просматривает ту же копию заново, не копируя буфер.
+// Открытый в консоли файл просматривается по его отображению, один раз.
+class Searcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef struct {
+        qint64 line;                                // абсолютный номер строки, как в Console
+        int column;
+        int length;
+    } Match;
+
+    typedef QVector<Match> Matches;
+
+    // Результаты прохода: найденное заменяет прежние вхождения начиная со строки from
+    typedef struct {
+        int generation;
+        qint64 from;
+        Matches matches;
+        qint64 scanned;                             // строки до scanned просмотрены
+        bool done;                                  // просмотр дошёл до конца буфера
+    } Batch;
+
+    explicit Searcher(QObject *parent = nullptr);
+
+    int restart();                                  // из потока GUI: отменить проход, новое поколение
+    bool read(Batch &batch);                        // поток GUI
+
+public slots:
+    // поток поиска; generation - результат restart()
+    void start(const LineBuffer &snapshot, const QRegularExpression &re, int generation);
+    void rescan(const QRegularExpression &re, int generation);  // новый образец по той же копии
+    void startLog(const LogFile::MappingPtr &log, const QRegularExpression &re, int generation);
+    void append(const QByteArray &data, int generation);        // копия дополняется при любом поколении
+    void clear();                                   // вслед за Console::clear()
+    void setCapacity(qsizetype capacity);           // вслед за Console::setScrollback()
+    void stop(int generation);                      // освободить копию буфера
+
+signals:
+    void readyRead();                               // есть результаты
+
+private:
+    bool isCurrent(int generation) const;
+    void scan(int generation);
+    void scanLog(int generation);
+    void push(Batch &&batch);
+
+    LineBuffer m_buffer;
+    LogFile::MappingPtr m_log;                      // держит отображение до конца просмотра
+    QRegularExpression m_re;
+    qint64 m_next = 0;                              // первая строка, не просмотренная до конца
+    std::atomic<int> m_generation{0};
+
+    QMutex m_mutex;
+    std::deque<Batch> m_batches;
+    bool m_notified = false;                        // под m_mutex
+};
+
+#endif // SEARCHER_H
@@ -0,0 +1,190 @@
+#include "sessionlog.h"
+#include "timestamp.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtEndian>
+
+SessionLog::SessionLog(int session, QObject *parent):
+    QObject(parent),
+    m_start(Timestamp::now()),
+    m_prefix(QString("%1%2-%3-%4-").arg(SESSIONLOG_PREFIX,
+                                        QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"),
+                                        QString::number(QCoreApplication::applicationPid()),
+                                        QString::number(session)))
+{
+    m_settings.sessionLog = false;
+    m_settings.sessionLogSegmentSize = 0;
+    m_settings.sessionLogSegmentTime = 0;
+    m_settings.sessionLogKeep = 0;
+    m_settings.sessionLogCompress = false;
+    m_current = m_settings;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+SessionLog::~SessionLog() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_enabled.store(false, std::memory_order_relaxed);
+        m_wake.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+}
+
+void SessionLog::setSettings(const Connection::Settings &settings) {
+    QMutexLocker locker(&m_mutex);
+    // прочие параметры подключения на журнал не влияют
+    if (settings.sessionLog == m_settings.sessionLog &&
+        settings.sessionLogDir == m_settings.sessionLogDir &&
+        settings.sessionLogSegmentSize == m_settings.sessionLogSegmentSize &&
+        settings.sessionLogSegmentTime == m_settings.sessionLogSegmentTime &&
+        settings.sessionLogKeep == m_settings.sessionLogKeep &&
+        settings.sessionLogCompress == m_settings.sessionLogCompress &&
+        (m_enabled.load(std::memory_order_relaxed) || !settings.sessionLog)) return;
+    m_settings = settings;
+    m_changed = true;
+    m_enabled.store(settings.sessionLog && !settings.sessionLogDir.isEmpty(), std::memory_order_relaxed);
+    m_wake.wakeOne();
+}
+
+bool SessionLog::isEnabled() const {
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+void SessionLog::append(Capture::Direction direction, int transport, qint64 timestamp, const char *data, qint64 size) {
+    if (!m_enabled.load(std::memory_order_relaxed) || size <= 0) return;
+    uchar header[CAPTURE_CHUNK_HEADER_SIZE];
+    Capture::chunkHeader(header, timestamp - m_start, size, direction, transport);
+
+    QMutexLocker locker(&m_mutex);
+    const qint64 used = m_active.size();
+    if (used + CAPTURE_CHUNK_HEADER_SIZE + size > SESSIONLOG_BUFFER) {
+        m_dropped.fetch_add(size, std::memory_order_relaxed); // диск не успевает - ввод-вывод не ждёт
+        return;
+    }
+    m_active.append(reinterpret_cast<const char *>(header), CAPTURE_CHUNK_HEADER_SIZE);
+    m_active.append(data, size);
+    if (used < SESSIONLOG_FLUSH_SIZE && m_active.size() >= SESSIONLOG_FLUSH_SIZE) m_wake.wakeOne();
+}
+
+qint64 SessionLog::written() const {
+    return m_written.load(std::memory_order_relaxed);
+}
+
+qint64 SessionLog::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void SessionLog::run() {
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        if (!m_stop && !m_changed && m_active.size() < SESSIONLOG_FLUSH_SIZE) {
+            if (m_active.isEmpty() && !m_enabled.load(std::memory_order_relaxed)) {
+                m_wake.wait(&m_mutex);
+            } else {
+                m_wake.wait(&m_mutex, SESSIONLOG_FLUSH_TIME);
+            }
+        }
+        // заполненный буфер уходит на запись, пустой - под новые блоки
+        m_spare.swap(m_active);
+        const bool changed = m_changed;
+        const bool stop = m_stop;
+        m_changed = false;
+        if (changed) m_current = m_settings;
+        locker.unlock();
+
+        if (changed) closeSegment();
+        if (!m_spare.isEmpty() && m_current.sessionLog && !write(m_spare, Timestamp::now())) {
+            closeSegment();
+            locker.relock();
+            m_enabled.store(false, std::memory_order_relaxed);
+            locker.unlock();
+            emit error(m_errorString);
+        }
+        m_spare.resize(0);                          // ёмкость сохраняется
+        if (!m_current.sessionLog) closeSegment();
+
+        locker.relock();
+        if (stop) break;
+    }
+    m_spare.swap(m_active);                         // пришедшее за время последней записи
+    locker.unlock();
+    if (!m_spare.isEmpty() && m_current.sessionLog) write(m_spare, Timestamp::now());
+    closeSegment();
+}
+
+bool SessionLog::write(const QByteArray &block, qint64 now) {
+    if (m_file.isOpen()) {
+        const bool full = (m_current.sessionLogSegmentSize > 0) &&
+                          (m_file.pos() >= qint64(m_current.sessionLogSegmentSize) * 1024 * 1024);
+        const bool expired = (m_current.sessionLogSegmentTime > 0) &&
+                             (now - m_segmentStart >= qint64(m_current.sessionLogSegmentTime) * 60 * 1000000000);
+        const bool inflated = m_current.sessionLogCompress && (m_segmentData + block.size() > CAPTURE_MAX_INFLATED);
+        if (full || expired || inflated) closeSegment();
+    }
+    if (!m_file.isOpen() && !openSegment(now)) return false;
+    const qint64 pos = m_file.pos();
+    if (!writeData(block.constData(), block.size()) || !m_file.flush()) {
+        m_errorString = tr("Ошибка записи журнала в '%1': %2").arg(m_file.fileName(), m_file.errorString());
+        return false;
+    }
+    m_written.fetch_add(m_file.pos() - pos, std::memory_order_relaxed);
+    m_segmentData += block.size();
+    return true;
+}
+
+bool SessionLog::writeData(const char *data, qint64 size) {
+    if (!m_current.sessionLogCompress) return m_file.write(data, size) == size;
+    // кадр сжимается независимо: сегмент читается и после обрыва записи
+    const QByteArray frame = qCompress(reinterpret_cast<const uchar *>(data), size);
+    uchar length[4];
+    qToLittleEndian<quint32>(quint32(frame.size()), length);
+    return (m_file.write(reinterpret_cast<const char *>(length), sizeof(length)) == sizeof(length)) &&
+           (m_file.write(frame) == frame.size());
+}
+
+bool SessionLog::openSegment(qint64 now) {
+    const QDir dir(m_current.sessionLogDir);
+    if (!dir.mkpath(".")) {
+        m_errorString = tr("Ошибка создания папки журнала '%1'").arg(dir.path());
+        return false;
+    }
+    m_file.setFileName(dir.filePath(QString("%1%2.%3").arg(m_prefix,
+                                                         QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz"),
+                                                         CAPTURE_EXTENSION)));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_errorString = tr("Ошибка открытия журнала '%1': %2").arg(m_file.fileName(), m_file.errorString());
+        return false;
+    }
+    uchar header[CAPTURE_FILE_HEADER_SIZE];
+    Capture::fileHeader(header, m_start);
+    const bool ok = (!m_current.sessionLogCompress || m_file.write(CAPTURE_MAGIC_Z, CAPTURE_MAGIC_SIZE) == CAPTURE_MAGIC_SIZE) &&
+                    writeData(reinterpret_cast<const char *>(header), sizeof(header));
+    if (!ok) {
+        m_errorString = tr("Ошибка записи журнала в '%1': %2").arg(m_file.fileName(), m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    m_segmentStart = now;
+    m_segmentData = sizeof(header);
+    removeOld();
+    return true;
+}
+
+void SessionLog::closeSegment() {
+    if (m_file.isOpen()) m_file.close();
+}
+
+// Имена сегментов сеанса упорядочены по времени создания; сегменты других сеансов не трогаются
+void SessionLog::removeOld() {
+    if (m_current.sessionLogKeep <= 0) return;
+    QDir dir(m_current.sessionLogDir);
+    const QStringList segments = dir.entryList({QString("%1*.%2").arg(m_prefix, CAPTURE_EXTENSION)}, QDir::Files, QDir::Name);
+    for (qsizetype i = 0; i + m_current.sessionLogKeep < segments.size(); ++i) dir.remove(segments.at(i));
+}
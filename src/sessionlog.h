@@ -0,0 +1,76 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <QObject>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include "capture.h"
+#include "connection.h"
+
+class QThread;
+
+#define SESSIONLOG_BUFFER       (8 * 1024 * 1024)   // байт в буфере; запись не успевает - блоки отбрасываются
+#define SESSIONLOG_FLUSH_SIZE   (1024 * 1024)       // байт в буфере, при которых запись начинается сразу
+#define SESSIONLOG_FLUSH_TIME   1000                // мс, наибольшая задержка записи на диск
+#define SESSIONLOG_PREFIX       "session-"        // далее начало, процесс и номер сеанса: сеансы в одной папке не удаляют чужие сегменты
+
+// Непрерывный журнал сеанса: все принятые и переданные блоки в формате захвата.
+// Блок копируется в активный буфер под коротким замком; поток записи меняет буферы местами
+// и пишет заполненный на диск, сжимая его отдельным кадром, если задано.
+// Журнал делится на сегменты по размеру и времени, старые сегменты этого сеанса удаляются.
+// Сжатый сегмент при чтении распаковывается целиком, поэтому он не больше CAPTURE_MAX_INFLATED до сжатия.
+// Метки всех сегментов отсчитываются от одного начала, поэтому каждый сегмент - полноценный захват.
+class SessionLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionLog(int session = 0, QObject *parent = nullptr); // session - номер окна сеанса, входит в имена сегментов
+    ~SessionLog();                                  // буфер дописывается на диск
+
+    void setSettings(const Connection::Settings &settings);
+    bool isEnabled() const;
+
+    // любой поток, не ждёт диска; timestamp - Timestamp::now()
+    void append(Capture::Direction direction, int transport, qint64 timestamp, const char *data, qint64 size);
+
+    qint64 written() const;                         // байт записано в сегменты
+    qint64 dropped() const;                         // байт блоков, не поместившихся в буфер
+
+signals:
+    void error(const QString &message);             // из потока записи; журнал выключается до новых параметров
+
+private:
+    // поток записи
+    void run();
+    bool write(const QByteArray &block, qint64 now);
+    bool writeData(const char *data, qint64 size);  // со сжатием
+    bool openSegment(qint64 now);
+    void closeSegment();
+    void removeOld();
+
+    QThread *m_thread = nullptr;
+    qint64 m_start = 0;                             // Timestamp::now(), начало отсчёта меток
+    QString m_prefix;                               // начало имён сегментов сеанса
+    std::atomic<bool> m_enabled{false};
+    std::atomic<qint64> m_written{0};
+    std::atomic<qint64> m_dropped{0};
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QByteArray m_active;                            // под m_mutex: заполняется блоками
+    Connection::Settings m_settings;                // под m_mutex
+    bool m_changed = false;                         // под m_mutex: начать новый сегмент с новыми параметрами
+    bool m_stop = false;                            // под m_mutex
+
+    QByteArray m_spare;                             // записывается на диск
+    Connection::Settings m_current;                 // параметры текущего сегмента
+    QFile m_file;
+    QString m_errorString;
+    qint64 m_segmentStart = 0;
+    qint64 m_segmentData = 0;                       // байт в сегменте до сжатия
+};
+
+#endif // SESSIONLOG_H
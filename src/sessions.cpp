@@ -0,0 +1,171 @@
+#include "sessions.h"
+#include "mainwindow.h"
+#include "iopool.h"
+
+#include <QMdiArea>
+#include <QMdiSubWindow>
+#include <QMenu>
+#include <QMenuBar>
+#include <QAction>
+#include <QActionGroup>
+#include <QKeySequence>
+#include <QCloseEvent>
+#include <QSettings>
+#include <QCoreApplication>
+#include <QIcon>
+
+const char* strSessions = "Sessions";
+const char* strSessionsIds = "Ids";
+const char* strSessionsView = "View";
+const char* strSessionsGeometry = "Geometry";
+
+SessionsWindow::SessionsWindow(QWidget *parent):
+    QMainWindow(parent),
+    m_pool(new IoPool),
+    m_mdi(new QMdiArea(this)),
+    m_menu(new QMenu(tr("Сессии"), this))
+{
+    setCentralWidget(m_mdi);
+    setWindowIcon(QIcon(":/app"));
+    m_mdi->setDocumentMode(true);
+    m_mdi->setTabsClosable(true);
+    m_mdi->setTabsMovable(true);
+
+    // menu
+    m_actionNew = m_menu->addAction(tr("Новая сессия"), this, &SessionsWindow::newSession);
+    m_actionNew->setShortcut(QKeySequence("Ctrl+Shift+T"));
+    m_actionNew->setStatusTip(tr("Открыть ещё одну сессию с отдельным подключением"));
+    m_actionClose = m_menu->addAction(tr("Закрыть сессию"), this, &SessionsWindow::closeSession);
+    m_actionClose->setShortcut(QKeySequence("Ctrl+Shift+W"));
+    m_actionClose->setStatusTip(tr("Закрыть текущую сессию и удалить её параметры"));
+    m_menu->addSeparator();
+    QActionGroup *group = new QActionGroup(this);
+    m_actionTabs = m_menu->addAction(tr("Вкладки"), this, [=]() { setViewMode(Tabs); });
+    m_actionTabs->setStatusTip(tr("Показывать сессии на вкладках"));
+    m_actionGrid = m_menu->addAction(tr("Сетка"), this, [=]() { setViewMode(Grid); });
+    m_actionGrid->setStatusTip(tr("Показывать все сессии одновременно"));
+    for (QAction *action : {m_actionTabs, m_actionGrid}) {
+        action->setCheckable(true);
+        group->addAction(action);
+    }
+    addActions({m_actionNew, m_actionClose});
+    menuBar()->hide();                              // меню - в строке меню каждой сессии
+
+    connect(m_mdi, &QMdiArea::subWindowActivated, this, &SessionsWindow::updateTitle);
+
+    // settings
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    settings.beginGroup(strSessions);
+    restoreGeometry(settings.value(strSessionsGeometry).toByteArray());
+    const QStringList ids = settings.value(strSessionsIds, QStringList("0")).toStringList();
+    const int mode = settings.value(strSessionsView, Tabs).toInt();
+    settings.endGroup();
+
+    for (const QString &id : ids) {
+        bool ok;
+        const int value = id.toInt(&ok);
+        if (ok && (value >= 0) && !m_ids.contains(value)) addSession(value);
+    }
+    if (!m_ids.contains(0)) addSession(0);          // первая сессия есть всегда
+    setViewMode(mode);
+    if (!m_mdi->subWindowList().isEmpty()) m_mdi->setActiveSubWindow(m_mdi->subWindowList().first());
+}
+
+SessionsWindow::~SessionsWindow() {
+    // транспорты сессий освобождают потоки до удаления IoPool
+    m_closing = true;
+    const QList<QMdiSubWindow*> windows = m_mdi->subWindowList();
+    for (QMdiSubWindow *window : windows) delete window;
+    delete m_pool;
+}
+
+void SessionsWindow::closeEvent(QCloseEvent *event) {
+    m_closing = true;
+    writeSettings();
+    QMainWindow::closeEvent(event);
+}
+
+bool SessionsWindow::eventFilter(QObject *watched, QEvent *event) {
+    // первую сессию закрыть нельзя, только выйти из программы
+    if ((event->type() == QEvent::Close) && !m_closing) {
+        QMdiSubWindow *window = qobject_cast<QMdiSubWindow*>(watched);
+        MainWindow *session = window ? qobject_cast<MainWindow*>(window->widget()) : nullptr;
+        if (session && (session->session() == 0)) {
+            event->ignore();
+            return true;
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void SessionsWindow::newSession() {
+    int id = 0;
+    for (int value : std::as_const(m_ids)) id = qMax(id, value + 1);
+    MainWindow *session = addSession(id);
+    if (m_actionGrid->isChecked()) m_mdi->tileSubWindows();
+    m_mdi->setActiveSubWindow(qobject_cast<QMdiSubWindow*>(session->parentWidget()));
+    writeSettings();
+}
+
+void SessionsWindow::closeSession() {
+    QMdiSubWindow *window = m_mdi->activeSubWindow();
+    if (window) window->close();
+}
+
+void SessionsWindow::setViewMode(int mode) {
+    if (mode == Grid) {
+        m_actionGrid->setChecked(true);
+        m_mdi->setViewMode(QMdiArea::SubWindowView);
+        m_mdi->tileSubWindows();
+    } else {
+        m_actionTabs->setChecked(true);
+        m_mdi->setViewMode(QMdiArea::TabbedView);
+    }
+}
+
+void SessionsWindow::updateTitle() {
+    QMdiSubWindow *window = m_mdi->activeSubWindow();
+    const QString title = QString("%1 v%2").arg(QCoreApplication::applicationName(), QCoreApplication::applicationVersion());
+    setWindowTitle(window ? QString("%1 - %2").arg(window->windowTitle(), title) : title);
+    MainWindow *session = window ? qobject_cast<MainWindow*>(window->widget()) : nullptr;
+    m_actionClose->setEnabled(session && session->session());
+}
+
+MainWindow *SessionsWindow::addSession(int id) {
+    MainWindow *session = new MainWindow(m_pool, id);
+    session->setWindowFlags(Qt::Widget);            // вложенное окно со своими меню и панелями
+    QList<QAction*> actions = session->menuBar()->actions();
+    session->menuBar()->insertMenu(actions.isEmpty() ? nullptr : actions.last(), m_menu);
+
+    QMdiSubWindow *window = m_mdi->addSubWindow(session);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->setWindowIcon(windowIcon());
+    window->setWindowTitle(session->windowTitle());
+    window->installEventFilter(this);
+    connect(session, &QWidget::windowTitleChanged, this, [=](const QString &title) {
+        window->setWindowTitle(title);
+        if (m_mdi->activeSubWindow() == window) updateTitle();
+    });
+    connect(session, &QObject::destroyed, this, [=]() {
+        // параметры уже записаны деструктором сессии
+        if (m_closing || !id) return;
+        m_ids.removeOne(id);
+        QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+        settings.remove(MainWindow::sessionGroup(id));
+        writeSettings();
+    });
+    m_ids.append(id);
+    session->show();
+    return session;
+}
+
+void SessionsWindow::writeSettings() {
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    settings.beginGroup(strSessions);
+    QStringList ids;
+    for (int id : std::as_const(m_ids)) ids.append(QString::number(id));
+    settings.setValue(strSessionsIds, ids);
+    settings.setValue(strSessionsView, m_actionGrid->isChecked() ? Grid : Tabs);
+    settings.setValue(strSessionsGeometry, saveGeometry());
+    settings.endGroup();
+}
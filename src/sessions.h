@@ -0,0 +1,53 @@
+#ifndef SESSIONS_H
+#define SESSIONS_H
+
+#include <QMainWindow>
+
+class QMdiArea;
+class QMdiSubWindow;
+class QMenu;
+class QAction;
+class IoPool;
+class MainWindow;
+
+// Окно нескольких сессий: у каждой свои подключение, консоль, команды и параметры,
+// транспорты всех сессий обслуживаются общими потоками IoPool.
+class SessionsWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    typedef enum {
+        Tabs = 0,
+        Grid = 1
+    } ViewMode;
+
+    explicit SessionsWindow(QWidget *parent = nullptr);
+    ~SessionsWindow();
+
+protected:
+    void closeEvent(QCloseEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void newSession();
+    void closeSession();
+    void setViewMode(int mode);
+    void updateTitle();
+
+private:
+    MainWindow *addSession(int id);
+    void writeSettings();
+
+    IoPool *m_pool = nullptr;
+    QMdiArea *m_mdi = nullptr;
+    QMenu *m_menu = nullptr;
+    QAction *m_actionNew = nullptr;
+    QAction *m_actionClose = nullptr;
+    QAction *m_actionTabs = nullptr;
+    QAction *m_actionGrid = nullptr;
+    QList<int> m_ids;                               // в порядке создания
+    bool m_closing = false;                         // выход из программы - сессии не удаляются
+};
+
+#endif // SESSIONS_H
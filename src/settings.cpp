@@ -1,6 +1,8 @@
 #include "settings.h"
 #include "ui_settings.h"
+#include "crc.h"
 
+#include <QFileDialog>
 #include <QIntValidator>
 #include <QLineEdit>
 #include <QSerialPortInfo>
@@ -27,6 +29,8 @@ DialogSettings::DialogSettings(Settings &settings, QWidget *parent):
     connect(m_ui->comboBoxType,  &QComboBox::currentIndexChanged, this, &DialogSettings::setType);
 
     connect(m_ui->checkBoxLinefeed,  &QCheckBox::toggled, m_ui->spinBoxLinefeed, &QSpinBox::setEnabled);
+    connect(m_ui->comboBoxFraming,  &QComboBox::currentIndexChanged, this, &DialogSettings::setFraming);
+    connect(m_ui->toolButtonSessionLogDir, &QToolButton::clicked, this, &DialogSettings::selectSessionLogDir);
 
     fillParameters();
     fillPortsInfo();
@@ -86,10 +90,28 @@ void DialogSettings::setDefault() {
     m_currentSettings.rts = false;
     m_currentSettings.localEcho = true;
     m_currentSettings.timeStamp = false;
+    m_currentSettings.timeDelta = false;
+    m_currentSettings.gapThreshold = 0;
     m_currentSettings.hexLog = false;
     m_currentSettings.hexAll = false;
     m_currentSettings.linefeed = true;
     m_currentSettings.linefeedChar = 13;
+    m_currentSettings.scrollback = 16;
+    m_currentSettings.refreshRate = 60;
+    m_currentSettings.framing = Connection::FrameNone;
+    m_currentSettings.frameDelimiter = "\\0D\\0A";
+    m_currentSettings.frameLengthOffset = 0;
+    m_currentSettings.frameLengthSize = 1;
+    m_currentSettings.frameLengthBigEndian = false;
+    m_currentSettings.frameLengthAdjust = 0;
+    m_currentSettings.frameGap = 20;
+    m_currentSettings.frameCrc = 0;
+    m_currentSettings.sessionLog = false;
+    //m_currentSettings.sessionLogDir = m_currentSettings.sessionLogDir;
+    m_currentSettings.sessionLogSegmentSize = 64;
+    m_currentSettings.sessionLogSegmentTime = 60;
+    m_currentSettings.sessionLogKeep = 100;
+    m_currentSettings.sessionLogCompress = false;
     setSettings(m_currentSettings);
 }
 
@@ -109,6 +131,22 @@ void DialogSettings::setType(int idx) {
 
 }
 
+void DialogSettings::selectSessionLogDir() {
+    const QString dir = QFileDialog::getExistingDirectory(this, tr("Папка журнала сеанса"), m_ui->lineEditSessionLogDir->text());
+    if (!dir.isEmpty()) m_ui->lineEditSessionLogDir->setText(dir);
+}
+
+void DialogSettings::setFraming(int idx) {
+    const auto framing = m_ui->comboBoxFraming->itemData(idx).value<Connection::Framing>();
+    const bool length = (framing == Connection::FrameLength);
+    m_ui->lineEditFrameDelimiter->setEnabled(framing == Connection::FrameDelimiter);
+    m_ui->spinBoxFrameLengthOffset->setEnabled(length);
+    m_ui->comboBoxFrameLengthSize->setEnabled(length);
+    m_ui->spinBoxFrameLengthAdjust->setEnabled(length);
+    m_ui->spinBoxFrameGap->setEnabled(framing == Connection::FrameGap);
+    m_ui->comboBoxFrameCrc->setEnabled(framing != Connection::FrameNone);
+}
+
 void DialogSettings::fillPortsInfo() {
     m_ui->comboBoxPort->clear();
     m_ui->comboBoxPort->setInsertPolicy(QComboBox::NoInsert);
@@ -174,6 +212,23 @@ void DialogSettings::fillParameters() {
     m_ui->comboBoxFlowControl->addItem(tr("Нет"), QSerialPort::NoFlowControl);
     m_ui->comboBoxFlowControl->addItem(tr("Аппаратное"), QSerialPort::HardwareControl);
     m_ui->comboBoxFlowControl->addItem(tr("Программное"), QSerialPort::SoftwareControl);
+
+    // framing
+    m_ui->comboBoxFraming->addItem(tr("Нет"), Connection::FrameNone);
+    m_ui->comboBoxFraming->addItem(tr("Разделитель"), Connection::FrameDelimiter);
+    m_ui->comboBoxFraming->addItem(tr("Длина в заголовке"), Connection::FrameLength);
+    m_ui->comboBoxFraming->addItem(tr("Пауза"), Connection::FrameGap);
+    m_ui->comboBoxFraming->addItem(QStringLiteral("SLIP"), Connection::FrameSlip);
+    m_ui->comboBoxFraming->addItem(QStringLiteral("COBS"), Connection::FrameCobs);
+
+    // размер поля длины и порядок байт: 1 - без порядка, 2, 4 - LE/BE
+    m_ui->comboBoxFrameLengthSize->addItem(tr("1 байт"), 1);
+    m_ui->comboBoxFrameLengthSize->addItem(tr("2 байта LE"), 2);
+    m_ui->comboBoxFrameLengthSize->addItem(tr("2 байта BE"), -2);
+    m_ui->comboBoxFrameLengthSize->addItem(tr("4 байта LE"), 4);
+    m_ui->comboBoxFrameLengthSize->addItem(tr("4 байта BE"), -4);
+
+    m_ui->comboBoxFrameCrc->addItems(Crc().list());
 }
 
 void DialogSettings::setSettings(Settings value) {
@@ -254,6 +309,8 @@ void DialogSettings::setSettings(Settings value) {
     // terminal
     m_ui->checkBoxLocalEcho->setChecked(m_currentSettings.localEcho);
     m_ui->checkBoxTimeStamp->setChecked(m_currentSettings.timeStamp);
+    m_ui->checkBoxTimeDelta->setChecked(m_currentSettings.timeDelta);
+    m_ui->spinBoxGap->setValue(m_currentSettings.gapThreshold);
     m_ui->groupBoxHexLog->setChecked(m_currentSettings.hexLog);
     if (m_currentSettings.hexAll) {
         m_ui->radioButtonHexAll->setChecked(true);
@@ -262,6 +319,29 @@ void DialogSettings::setSettings(Settings value) {
     }
     m_ui->checkBoxLinefeed->setChecked(m_currentSettings.linefeed);
     m_ui->spinBoxLinefeed->setValue(m_currentSettings.linefeedChar);
+    m_ui->spinBoxScrollback->setValue(m_currentSettings.scrollback);
+    m_ui->spinBoxRefreshRate->setValue(m_currentSettings.refreshRate);
+
+    // framing
+    index = m_ui->comboBoxFraming->findData(m_currentSettings.framing);
+    m_ui->comboBoxFraming->setCurrentIndex(index >= 0 ? index : 0);
+    setFraming(m_ui->comboBoxFraming->currentIndex());
+    m_ui->lineEditFrameDelimiter->setText(m_currentSettings.frameDelimiter);
+    m_ui->spinBoxFrameLengthOffset->setValue(m_currentSettings.frameLengthOffset);
+    index = m_ui->comboBoxFrameLengthSize->findData(m_currentSettings.frameLengthBigEndian && m_currentSettings.frameLengthSize > 1 ?
+                                                    -m_currentSettings.frameLengthSize : m_currentSettings.frameLengthSize);
+    m_ui->comboBoxFrameLengthSize->setCurrentIndex(index >= 0 ? index : 0);
+    m_ui->spinBoxFrameLengthAdjust->setValue(m_currentSettings.frameLengthAdjust);
+    m_ui->spinBoxFrameGap->setValue(m_currentSettings.frameGap);
+    m_ui->comboBoxFrameCrc->setCurrentIndex(qBound(0, m_currentSettings.frameCrc, m_ui->comboBoxFrameCrc->count() - 1));
+
+    // session log
+    m_ui->groupBoxSessionLog->setChecked(m_currentSettings.sessionLog);
+    m_ui->lineEditSessionLogDir->setText(m_currentSettings.sessionLogDir);
+    m_ui->spinBoxSessionLogSize->setValue(m_currentSettings.sessionLogSegmentSize);
+    m_ui->spinBoxSessionLogTime->setValue(m_currentSettings.sessionLogSegmentTime);
+    m_ui->spinBoxSessionLogKeep->setValue(m_currentSettings.sessionLogKeep);
+    m_ui->checkBoxSessionLogCompress->setChecked(m_currentSettings.sessionLogCompress);
 }
 
 void DialogSettings::updateSettings() {
@@ -301,8 +381,32 @@ void DialogSettings::updateSettings() {
     // terminal
     m_currentSettings.localEcho = m_ui->checkBoxLocalEcho->isChecked();
     m_currentSettings.timeStamp = m_ui->checkBoxTimeStamp->isChecked();
+    m_currentSettings.timeDelta = m_ui->checkBoxTimeDelta->isChecked();
+    m_currentSettings.gapThreshold = m_ui->spinBoxGap->value();
     m_currentSettings.hexLog = m_ui->groupBoxHexLog->isChecked();
     m_currentSettings.hexAll = m_ui->radioButtonHexAll->isChecked();
     m_currentSettings.linefeed = m_ui->checkBoxLinefeed->isChecked();
     m_currentSettings.linefeedChar = m_ui->spinBoxLinefeed->value();
+    m_currentSettings.scrollback = m_ui->spinBoxScrollback->value();
+    m_currentSettings.refreshRate = m_ui->spinBoxRefreshRate->value();
+
+    // framing
+    const auto framingData = m_ui->comboBoxFraming->currentData();
+    m_currentSettings.framing = framingData.value<Connection::Framing>();
+    m_currentSettings.frameDelimiter = m_ui->lineEditFrameDelimiter->text();
+    m_currentSettings.frameLengthOffset = m_ui->spinBoxFrameLengthOffset->value();
+    const int lengthSize = m_ui->comboBoxFrameLengthSize->currentData().toInt();
+    m_currentSettings.frameLengthSize = qAbs(lengthSize);
+    m_currentSettings.frameLengthBigEndian = (lengthSize < 0);
+    m_currentSettings.frameLengthAdjust = m_ui->spinBoxFrameLengthAdjust->value();
+    m_currentSettings.frameGap = m_ui->spinBoxFrameGap->value();
+    m_currentSettings.frameCrc = m_ui->comboBoxFrameCrc->currentIndex();
+
+    // session log
+    m_currentSettings.sessionLog = m_ui->groupBoxSessionLog->isChecked();
+    m_currentSettings.sessionLogDir = m_ui->lineEditSessionLogDir->text().trimmed();
+    m_currentSettings.sessionLogSegmentSize = m_ui->spinBoxSessionLogSize->value();
+    m_currentSettings.sessionLogSegmentTime = m_ui->spinBoxSessionLogTime->value();
+    m_currentSettings.sessionLogKeep = m_ui->spinBoxSessionLogKeep->value();
+    m_currentSettings.sessionLogCompress = m_ui->checkBoxSessionLogCompress->isChecked();
 }
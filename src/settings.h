@@ -2,7 +2,7 @@
 #define SETTINGS_H
 
 #include <QDialog>
-#include <QSerialPort>
+#include "connection.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -19,40 +19,8 @@ class DialogSettings : public QDialog
     Q_OBJECT
 
 public:
-    typedef enum {
-        Serial = 0,
-        Tcp = 1,
-        UdpUnicast = 2,
-        UdpBroadcast = 3
-    } ConnectionType;
-
-    typedef struct {
-        ConnectionType type;
-        int timeoutWrite;
-
-        // comport
-        QString name;
-        qint32 baudRate;
-        QSerialPort::DataBits dataBits;
-        QSerialPort::Parity parity;
-        QSerialPort::StopBits stopBits;
-        QSerialPort::FlowControl flowControl;
-        bool dtr;
-        bool rts;
-
-        // tcp
-        QString host;
-        quint16 port;
-
-        // terminal
-        bool localEcho;
-        bool timeStamp;
-        bool hexLog;
-        bool hexAll;
-        bool linefeed;
-        char linefeedChar;
-
-    } Settings;
+    typedef Connection::Type ConnectionType;
+    typedef Connection::Settings Settings;
 
     explicit DialogSettings(Settings &settings, QWidget *parent = nullptr);
     ~DialogSettings();
@@ -66,6 +34,8 @@ private slots:
     void checkCustomBaudRatePolicy(int idx);
     void setDefault();
     void setType(int idx);
+    void setFraming(int idx);
+    void selectSessionLogDir();
 
 private:
     void fillPortsInfo();
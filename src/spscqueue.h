@@ -0,0 +1,49 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Очередь без блокировок: один поток пишет, один поток читает
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // поток-производитель; при переполнении значение не перемещается
+    bool push(T &&value) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = (tail + 1) & (Capacity - 1);
+        if (next == m_head.load(std::memory_order_acquire)) return false;
+        m_items[tail] = std::move(value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // поток-потребитель
+    bool pop(T &value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        value = std::move(m_items[head]);
+        m_items[head] = T();
+        m_head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t size() const {
+        return (m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire)) & (Capacity - 1);
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    T m_items[Capacity];
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,27 @@
+#include "timestamp.h"
+
+#include <QElapsedTimer>
+#include <QDateTime>
+
+typedef struct {
+    QElapsedTimer timer;
+    qint64 epoch;                                   // нс с 1970-01-01 UTC в момент запуска
+} Clock;
+
+static const Clock &monotonicClock() {
+    static const Clock c = []() {
+        Clock r;
+        r.timer.start();
+        r.epoch = QDateTime::currentMSecsSinceEpoch() * 1000000LL;
+        return r;
+    }();
+    return c;
+}
+
+qint64 Timestamp::now() {
+    return monotonicClock().timer.nsecsElapsed();
+}
+
+qint64 Timestamp::toNSecsSinceEpoch(qint64 timestamp) {
+    return monotonicClock().epoch + timestamp;
+}
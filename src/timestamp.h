@@ -0,0 +1,15 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <QtGlobal>
+
+// Монотонное время высокого разрешения, общее для всех потоков.
+// Отсчёт - от первого обращения; привязка к системному времени фиксируется в тот же момент.
+class Timestamp
+{
+public:
+    static qint64 now();                            // нс
+    static qint64 toNSecsSinceEpoch(qint64 timestamp);
+};
+
+#endif // TIMESTAMP_H
@@ -0,0 +1,471 @@
+#include "transport.h"
+
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QTimer>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#else
+#include <sys/ioctl.h>
+#if defined(Q_OS_LINUX)
+#include <linux/serial.h>
+#endif
+#endif
+
+#define DEFAULT_SERIAL_SIGNALS_INTERVAL     100
+#define DEFAULT_FLUSH_RETRY_INTERVAL        5
+
+Transport::Transport(QObject *parent):
+    QObject(parent),
+    m_serial(new QSerialPort(this)),
+    m_tcp(new QTcpSocket(this)),
+    m_udp(new QUdpSocket(this)),
+    m_timerWrite(new QTimer(this)),
+    m_timerFlush(new QTimer(this)),
+    m_timerSerialSignals(new QTimer(this)),
+    m_timerFrame(new QTimer(this))
+{
+    // serial
+    connect(m_serial, &QSerialPort::errorOccurred, this, &Transport::serialErrorOccurred);
+    connect(m_serial, &QSerialPort::readyRead, this, &Transport::serialReadyRead);
+    connect(m_serial, &QSerialPort::bytesWritten, this, &Transport::deviceBytesWritten);
+    connect(m_serial, &QSerialPort::dataTerminalReadyChanged, this, &Transport::dataTerminalReadyChanged);
+    connect(m_serial, &QSerialPort::requestToSendChanged, this, &Transport::requestToSendChanged);
+
+    // tcp
+    connect(m_tcp, &QTcpSocket::connected, this, [=]() { setOpen(true); });
+    connect(m_tcp, &QTcpSocket::disconnected, this, [=]() { setOpen(false); });
+    connect(m_tcp, &QTcpSocket::stateChanged, this, &Transport::socketStateChanged);
+    connect(m_tcp, &QTcpSocket::errorOccurred, this, &Transport::socketError);
+    connect(m_tcp, &QTcpSocket::readyRead, this, &Transport::socketReadyRead);
+    connect(m_tcp, &QTcpSocket::bytesWritten, this, &Transport::deviceBytesWritten);
+
+    // udp
+    connect(m_udp, &QUdpSocket::stateChanged, this, &Transport::socketStateChanged);
+    connect(m_udp, &QUdpSocket::readyRead, this, &Transport::udpReadyRead);
+    connect(m_udp, &QUdpSocket::bytesWritten, this, &Transport::deviceBytesWritten);
+
+    // timers
+    connect(m_timerWrite, &QTimer::timeout, this, &Transport::writeTimeout);
+    m_timerWrite->setSingleShot(true);
+    connect(m_timerFlush, &QTimer::timeout, this, &Transport::flush);
+    m_timerFlush->setSingleShot(true);
+    m_timerFlush->setInterval(DEFAULT_FLUSH_RETRY_INTERVAL);
+    connect(m_timerSerialSignals, &QTimer::timeout, this, &Transport::readPinoutSignals);
+    connect(m_timerSerialSignals, &QTimer::timeout, this, &Transport::readLineStatus);
+    m_timerSerialSignals->setInterval(DEFAULT_SERIAL_SIGNALS_INTERVAL);
+    connect(m_timerFrame, &QTimer::timeout, this, &Transport::frameTimeout);
+    m_timerFrame->setSingleShot(true);
+    m_timerFrame->setTimerType(Qt::PreciseTimer);
+}
+
+bool Transport::isOpen() const {
+    return m_open.load(std::memory_order_acquire);
+}
+
+bool Transport::read(Chunk &chunk) {
+    if (m_queue.pop(chunk)) return true;
+    m_notified.store(false, std::memory_order_release);
+    return m_queue.pop(chunk); // данные могли прийти до сброса флага
+}
+
+Transport::Statistics Transport::statistics() const {
+    Statistics statistics;
+    for (int i = 0; i < 2; ++i) {
+        statistics.bytes[i] = m_bytes[i].load(std::memory_order_relaxed);
+        statistics.blocks[i] = m_blocks[i].load(std::memory_order_relaxed);
+    }
+    statistics.bytesToWrite = m_bytesToWriteShared.load(std::memory_order_relaxed);
+    statistics.outputQueue = m_outputQueue.load(std::memory_order_relaxed);
+    for (int i = 0; i < LineErrorCount; ++i) statistics.lineErrors[i] = m_lineErrors[i].load(std::memory_order_relaxed);
+    statistics.queued = qint64(m_queue.size()) + m_pendingShared.load(std::memory_order_relaxed);
+    statistics.badFrames = m_badFrames.load(std::memory_order_relaxed);
+    statistics.crcOk = m_crcOk.load(std::memory_order_relaxed);
+    statistics.crcFailed = m_crcFailed.load(std::memory_order_relaxed);
+    statistics.crcBytes = m_crcBytes.load(std::memory_order_relaxed);
+    statistics.responses = m_responses.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void Transport::open(const Connection::Settings &settings) {
+    m_settings = settings;
+    m_bytesToWrite = 0;
+    m_framer.setSettings(m_settings);
+    m_responder.reset();
+    resetStatistics();
+    switch (m_settings.type) {
+
+    case Connection::Tcp:
+        m_tcp->connectToHost(m_settings.host, m_settings.port);
+        break;
+
+    case Connection::UdpUnicast:
+    case Connection::UdpBroadcast:
+        if (m_udp->bind(m_settings.port, QUdpSocket::ShareAddress)) {
+            setOpen(true);
+        } else {
+            emit openError(QString(tr("Ошибка открытия порта 'UDP:%1': %2")).
+                           arg(m_settings.port).arg(m_udp->errorString()));
+        }
+        break;
+
+    default: // Connection::Serial
+        m_serial->setPortName(m_settings.name);
+        m_serial->setBaudRate(m_settings.baudRate);
+        m_serial->setDataBits(m_settings.dataBits);
+        m_serial->setParity(m_settings.parity);
+        m_serial->setStopBits(m_settings.stopBits);
+        m_serial->setFlowControl(m_settings.flowControl);
+        if (m_serial->open(QIODevice::ReadWrite)) {
+            m_serial->setDataTerminalReady(m_settings.dtr);
+            m_serial->setRequestToSend(m_settings.rts);
+            m_pinout = QSerialPort::NoSignal;
+            readPinoutSignals();
+            readLineStatus();
+            m_timerSerialSignals->start();
+            setOpen(true);
+        } else {
+            emit openError(QString(tr("Ошибка открытия порта '%1': %2")).
+                           arg(m_serial->portName()).arg(m_serial->errorString()));
+        }
+    }
+}
+
+void Transport::close() {
+    m_timerWrite->stop();
+    m_timerFrame->stop();
+    m_framer.reset();
+    ++m_responderEpoch;
+    switch (m_settings.type) {
+    case Connection::Tcp: if (m_tcp->isOpen()) m_tcp->close(); break;
+    case Connection::UdpUnicast:
+    case Connection::UdpBroadcast:
+        if (m_udp->state() == QAbstractSocket::BoundState) {
+            m_udp->close();
+        }
+        setOpen(false);
+        break;
+    default: // Connection::Serial
+        m_timerSerialSignals->stop();
+        if (m_serial->isOpen()) m_serial->close();
+        setOpen(false);
+    }
+}
+
+void Transport::write(const QByteArray &data) {
+    if (!isOpen()) return;
+    qint64 written;
+    switch (m_settings.type) {
+    case Connection::Tcp:
+        written = m_tcp->write(data);
+        break;
+    case Connection::UdpUnicast:
+        written = m_udp->writeDatagram(data, QHostAddress(m_settings.host), m_settings.port);
+        break;
+    case Connection::UdpBroadcast:
+        written = m_udp->writeDatagram(data, QHostAddress::Broadcast, m_settings.port);
+        break;
+    default: // Connection::Serial
+        written = m_serial->write(data);
+    }
+    if (written != data.size()) {
+        emit writeError(tr("Ошибка записи в '%1'!\nОшибка: '%2'").arg(deviceName(), errorString()));
+        return;
+    }
+    const qint64 timestamp = Timestamp::now();
+    m_bytes[Capture::Tx].fetch_add(written, std::memory_order_relaxed);
+    m_blocks[Capture::Tx].fetch_add(1, std::memory_order_relaxed);
+    capture(Capture::Tx, timestamp, data.constData(), data.size());
+    enqueue(Capture::Tx, data, timestamp);
+    if (m_settings.type == Connection::Serial) {
+        m_bytesToWrite += written;
+        m_timerWrite->start(m_settings.timeoutWrite);
+    }
+    updateBytesToWrite();
+}
+
+void Transport::setDataTerminalReady(bool value) {
+    if (m_serial->isOpen()) m_serial->setDataTerminalReady(value);
+}
+
+void Transport::setRequestToSend(bool value) {
+    if (m_serial->isOpen()) m_serial->setRequestToSend(value);
+}
+
+void Transport::startCapture(const QString &fileName) {
+    if (!m_capture.open(fileName)) {
+        emit captureError(tr("Ошибка записи в '%1': %2").arg(fileName, m_capture.errorString()));
+    }
+}
+
+void Transport::stopCapture() {
+    if (!m_capture.isOpen()) return;
+    m_capture.close();
+    if (m_capture.dropped() > 0) emit captureError(tr("Захват неполон: диск не успевал, потеряно %1 байт").arg(m_capture.dropped()));
+}
+
+void Transport::setResponder(const Responder::Rules &rules) {
+    m_responder.setRules(rules);
+    ++m_responderEpoch;
+}
+
+void Transport::setSessionLog(SessionLog *log) {
+    m_sessionLog = log;
+}
+
+void Transport::serialReadyRead() {
+    const qint64 timestamp = Timestamp::now();
+    received(m_serial->readAll(), timestamp);
+}
+
+void Transport::serialErrorOccurred(QSerialPort::SerialPortError error) {
+    if (error == QSerialPort::ResourceError) {
+        emit errorOccurred(m_serial->errorString());
+        close();
+    }
+}
+
+void Transport::socketReadyRead() {
+    const qint64 timestamp = Timestamp::now();
+    received(m_tcp->readAll(), timestamp);
+}
+
+void Transport::udpReadyRead() {
+    // каждая датаграмма - отдельный блок со своей меткой времени
+    while (m_udp->hasPendingDatagrams()) {
+        const qint64 timestamp = Timestamp::now();
+        QByteArray data(qsizetype(m_udp->pendingDatagramSize()), Qt::Uninitialized);
+        const qint64 size = m_udp->readDatagram(data.data(), data.size());
+        data.resize(qMax<qint64>(size, 0));
+        received(data, timestamp);
+    }
+}
+
+void Transport::socketError(QAbstractSocket::SocketError error) {
+    emit socketErrorOccurred(error, m_tcp->errorString());
+}
+
+void Transport::deviceBytesWritten(qint64 bytes) {
+    m_bytesToWrite -= bytes;
+    if (m_bytesToWrite <= 0) {
+        m_bytesToWrite = 0;
+        m_timerWrite->stop();
+    }
+    updateBytesToWrite();
+    emit bytesWritten(bytes);
+}
+
+void Transport::writeTimeout() {
+    emit writeError(tr("Таймаут записи в порт '%1'.\nОшибка: %2").arg(m_serial->portName(), m_serial->errorString()));
+}
+
+void Transport::readPinoutSignals() {
+    const QSerialPort::PinoutSignals pinout = m_serial->pinoutSignals();
+    if (pinout == m_pinout) return;
+    m_pinout = pinout;
+    emit pinoutSignalsChanged(pinout);
+}
+
+// Буфер вывода драйвера и ошибки линии опрашиваются вместе с сигналами порта
+void Transport::readLineStatus() {
+    qint64 outputQueue = -1;
+    qint64 errors[LineErrorCount] = {-1, -1, -1, -1};
+#if defined(Q_OS_WIN)
+    // флаги сбрасываются и самим QSerialPort при чтении, поэтому счёт - не менее указанного
+    DWORD flags = 0;
+    COMSTAT stat;
+    if (ClearCommError(m_serial->handle(), &flags, &stat)) {
+        outputQueue = stat.cbOutQue;
+        if (flags & CE_FRAME) ++m_lineCounts[FramingError];
+        if (flags & CE_RXPARITY) ++m_lineCounts[ParityError];
+        if (flags & (CE_OVERRUN | CE_RXOVER)) ++m_lineCounts[OverrunError];
+        if (flags & CE_BREAK) ++m_lineCounts[BreakCondition];
+        for (int i = 0; i < LineErrorCount; ++i) errors[i] = m_lineCounts[i];
+    }
+#else
+    int queued = 0;
+    if (::ioctl(m_serial->handle(), TIOCOUTQ, &queued) == 0) outputQueue = queued;
+#if defined(Q_OS_LINUX)
+    struct serial_icounter_struct icount = {};
+    if (::ioctl(m_serial->handle(), TIOCGICOUNT, &icount) == 0) {
+        const qint64 counts[LineErrorCount] = {icount.frame, icount.parity, qint64(icount.overrun) + icount.buf_overrun, icount.brk};
+        // счётчики драйвера - с загрузки, отсчёт ведётся от открытия
+        if (m_lineCounts[0] < 0) std::copy(counts, counts + LineErrorCount, m_lineCounts);
+        for (int i = 0; i < LineErrorCount; ++i) errors[i] = counts[i] - m_lineCounts[i];
+    }
+#endif
+#endif
+    m_outputQueue.store(outputQueue, std::memory_order_relaxed);
+    for (int i = 0; i < LineErrorCount; ++i) m_lineErrors[i].store(errors[i], std::memory_order_relaxed);
+}
+
+void Transport::frameTimeout() {
+    const qint64 timestamp = Timestamp::now();
+    m_framer.expire(timestamp, m_frames);
+    deliverFrames(timestamp);
+}
+
+void Transport::setOpen(bool value) {
+    m_open.store(value, std::memory_order_release);
+    if (value) {
+        emit opened();
+    } else {
+        m_pending.clear();
+        m_pendingShared.store(0, std::memory_order_relaxed);
+        m_timerFlush->stop();
+        emit closed();
+    }
+}
+
+void Transport::resetStatistics() {
+    for (int i = 0; i < 2; ++i) {
+        m_bytes[i].store(0, std::memory_order_relaxed);
+        m_blocks[i].store(0, std::memory_order_relaxed);
+    }
+    m_bytesToWriteShared.store(0, std::memory_order_relaxed);
+    m_outputQueue.store(-1, std::memory_order_relaxed);
+    m_badFrames.store(0, std::memory_order_relaxed);
+    m_crcOk.store(0, std::memory_order_relaxed);
+    m_crcFailed.store(0, std::memory_order_relaxed);
+    m_crcBytes.store(0, std::memory_order_relaxed);
+    m_responses.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < LineErrorCount; ++i) {
+        m_lineErrors[i].store(-1, std::memory_order_relaxed);
+#if defined(Q_OS_WIN)
+        m_lineCounts[i] = 0;
+#else
+        m_lineCounts[i] = -1;
+#endif
+    }
+}
+
+void Transport::updateBytesToWrite() {
+    qint64 bytes = 0;
+    switch (m_settings.type) {
+    case Connection::Tcp: bytes = m_tcp->bytesToWrite(); break;
+    case Connection::Serial: bytes = m_bytesToWrite; break;
+    default: break;                                 // датаграммы отправляются сразу
+    }
+    m_bytesToWriteShared.store(bytes, std::memory_order_relaxed);
+}
+
+// Принятый блок: без разбиения - как есть, иначе через Framer кадрами
+void Transport::received(const QByteArray &data, qint64 timestamp) {
+    if (data.isEmpty()) return;
+    m_bytes[Capture::Rx].fetch_add(data.size(), std::memory_order_relaxed);
+    if (!m_framer.isEnabled()) {
+        m_blocks[Capture::Rx].fetch_add(1, std::memory_order_relaxed);
+        capture(Capture::Rx, timestamp, data.constData(), data.size());
+        enqueue(Capture::Rx, data, timestamp);
+    } else {
+        m_framer.push(data.constData(), data.size(), timestamp, m_frames);
+        deliverFrames(timestamp);
+    }
+    // ответ - после передачи принятого, чтобы в консоли и захвате он шёл за запросом
+    if (!m_responder.isEmpty()) respond(data);
+}
+
+// Автоответчик - по потоку приёма, независимо от разбиения на кадры
+void Transport::respond(const QByteArray &data) {
+    m_responder.feed(data.constData(), data.size(), m_matches);
+    for (const int idx : std::as_const(m_matches)) {
+        const Responder::Action &action = m_responder.action(idx);
+        m_responses.fetch_add(1, std::memory_order_relaxed);
+        if (action.delay <= 0) {
+            write(action.reply);
+            continue;
+        }
+        const QByteArray reply = action.reply;
+        const quint64 epoch = m_responderEpoch;
+        QTimer::singleShot(action.delay, Qt::PreciseTimer, this, [this, reply, epoch]() {
+            if (epoch == m_responderEpoch) write(reply);
+        });
+    }
+    m_matches.clear();
+}
+
+// timestamp - момент завершения кадров; в захват идёт он, чтобы метки захвата не убывали
+void Transport::deliverFrames(qint64 timestamp) {
+    for (Framer::Frame &frame : m_frames) {
+        if (frame.error) m_badFrames.fetch_add(1, std::memory_order_relaxed);
+        if (frame.data.isEmpty()) continue;         // ошибка без данных - только в счётчик
+        m_blocks[Capture::Rx].fetch_add(1, std::memory_order_relaxed);
+        capture(Capture::Rx, timestamp, frame.data.constData(), frame.data.size());
+        enqueue(Capture::Rx, frame.data, frame.timestamp, verify(frame.data));
+    }
+    m_frames.clear();
+    // FrameGap: незавершённый кадр закрывается по таймеру, если данных больше нет
+    const qint64 deadline = m_framer.deadline();
+    if (deadline < 0) {
+        m_timerFrame->stop();
+    } else {
+        m_timerFrame->start(int((qMax<qint64>(deadline - Timestamp::now(), 0) + 999999) / 1000000));
+    }
+}
+
+// Контрольная сумма в конце кадра, перед разделителем
+Crc::Check Transport::verify(const QByteArray &frame) {
+    if (m_settings.frameCrc <= 0) return Crc::CheckNone;
+    qsizetype size = frame.size() - qMin(m_framer.delimiterSize(), frame.size());
+    // CR формата "-CR" может быть первым байтом разделителя
+    if (size < frame.size() && frame.at(size) == '\r' && Crc::endsWithCr(uint(m_settings.frameCrc))) ++size;
+    const Crc::Check check = Crc::verify(frame.constData(), size, uint(m_settings.frameCrc));
+    if (check == Crc::CheckNone) return check;
+    m_crcBytes.fetch_add(frame.size(), std::memory_order_relaxed);
+    if (check == Crc::CheckOk) {
+        m_crcOk.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_crcFailed.fetch_add(1, std::memory_order_relaxed);
+    }
+    return check;
+}
+
+void Transport::enqueue(Capture::Direction direction, const QByteArray &data, qint64 timestamp, Crc::Check check) {
+    if (data.isEmpty()) return;
+    // при разбиении на кадры блоки не объединяются - границы кадров сохраняются
+    if (!m_framer.isEnabled() && !m_pending.empty() && m_pending.back().direction == direction) {
+        m_pending.back().data.append(data);         // очередь заполнена - объединяем, метка первого блока
+    } else {
+        m_pending.push_back({data, timestamp, direction, check});
+    }
+    flush();
+}
+
+void Transport::flush() {
+    if (m_pending.empty()) return;
+    while (!m_pending.empty() && m_queue.push(std::move(m_pending.front()))) m_pending.pop_front();
+    m_pendingShared.store(qint64(m_pending.size()), std::memory_order_relaxed);
+    // очередь заполнена - остаток в m_pending, повтор позже
+    if (!m_pending.empty()) m_timerFlush->start();
+    if (!m_notified.exchange(true, std::memory_order_acq_rel)) emit readyRead();
+}
+
+void Transport::capture(Capture::Direction direction, qint64 timestamp, const char *data, qint64 size) {
+    if (m_sessionLog) m_sessionLog->append(direction, m_settings.type, timestamp, data, size);
+    if (!m_capture.isOpen()) return;
+    if (!m_capture.write(direction, m_settings.type, timestamp, data, size)) {
+        emit captureError(tr("Ошибка записи захвата: %1").arg(m_capture.errorString()));
+        m_capture.close();
+    }
+}
+
+QString Transport::deviceName() const {
+    switch (m_settings.type) {
+    case Connection::Tcp: return QString("TCP:%1:%2").arg(m_settings.host).arg(m_settings.port);
+    case Connection::UdpUnicast: return QString("UDP:%1:%2").arg(m_settings.host).arg(m_settings.port);
+    case Connection::UdpBroadcast: return QString("UDP:%1").arg(m_settings.port);
+    default: return m_serial->portName();
+    }
+}
+
+QString Transport::errorString() const {
+    switch (m_settings.type) {
+    case Connection::Tcp: return m_tcp->errorString();
+    case Connection::UdpUnicast:
+    case Connection::UdpBroadcast: return m_udp->errorString();
+    default: return m_serial->errorString();
+    }
+}
@@ -0,0 +1,162 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <QAbstractSocket>
+#include <atomic>
+#include <deque>
+#include "connection.h"
+#include "spscqueue.h"
+#include "capture.h"
+#include "timestamp.h"
+#include "framer.h"
+#include "crc.h"
+#include "responder.h"
+#include "sessionlog.h"
+
+QT_BEGIN_NAMESPACE
+
+class QTcpSocket;
+class QUdpSocket;
+class QTimer;
+
+QT_END_NAMESPACE
+
+#define TRANSPORT_QUEUE_SIZE    1024
+
+// Работа с устройством в отдельном потоке.
+// Принятые данные накапливаются и передаются в поток GUI через очередь без блокировок.
+class Transport : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Блок данных с меткой времени момента чтения из устройства / записи в устройство
+    typedef struct {
+        QByteArray data;
+        qint64 timestamp;                           // нс, Timestamp::now()
+        Capture::Direction direction;
+        Crc::Check check;                           // контрольная сумма кадра приёма
+    } Chunk;
+
+    typedef enum {
+        FramingError = 0,
+        ParityError = 1,
+        OverrunError = 2,                           // UART и буфер драйвера
+        BreakCondition = 3,
+        LineErrorCount = 4
+    } LineError;
+
+    // Счётчики канала с открытия; -1 - неизвестно (не последовательный порт или нет поддержки ОС)
+    typedef struct {
+        qint64 bytes[2];                            // по Capture::Direction
+        qint64 blocks[2];                           // чтений из устройства / записей, датаграмм
+        qint64 bytesToWrite;                        // передано устройству, ещё не записано
+        qint64 outputQueue;                         // байт в буфере вывода драйвера
+        qint64 lineErrors[LineErrorCount];
+        qint64 queued;                              // блоков ожидает потока GUI
+        qint64 badFrames;                           // кадров с ошибкой разбиения
+        qint64 crcOk;                               // кадров с верной контрольной суммой
+        qint64 crcFailed;
+        qint64 crcBytes;                            // байт в проверенных кадрах
+        qint64 responses;                           // ответов автоответчика
+    } Statistics;
+
+    explicit Transport(QObject *parent = nullptr);
+
+    bool isOpen() const;                            // из любого потока
+    bool read(Chunk &chunk);                        // забрать блок из очереди (поток GUI)
+    Statistics statistics() const;                  // из любого потока
+
+public slots:
+    void open(const Connection::Settings &settings);
+    void close();
+    void write(const QByteArray &data);
+    void setDataTerminalReady(bool value);
+    void setRequestToSend(bool value);
+    void startCapture(const QString &fileName);
+    void stopCapture();
+    void setResponder(const Responder::Rules &rules); // пусто - выключен
+    void setSessionLog(SessionLog *log);            // nullptr - без журнала; журнал живёт дольше подключения
+
+signals:
+    void opened();
+    void closed();
+    void readyRead();                               // в очереди есть данные
+    void bytesWritten(qint64 bytes);
+    void openError(const QString &message);
+    void writeError(const QString &message);
+    void errorOccurred(const QString &message);     // критическая ошибка порта
+    void socketStateChanged(QAbstractSocket::SocketState state);
+    void socketErrorOccurred(QAbstractSocket::SocketError error, const QString &message);
+    void dataTerminalReadyChanged(bool set);
+    void requestToSendChanged(bool set);
+    void pinoutSignalsChanged(QSerialPort::PinoutSignals pinout);
+    void captureError(const QString &message);
+
+private slots:
+    void serialReadyRead();
+    void serialErrorOccurred(QSerialPort::SerialPortError error);
+    void socketReadyRead();
+    void udpReadyRead();
+    void socketError(QAbstractSocket::SocketError error);
+    void deviceBytesWritten(qint64 bytes);
+    void writeTimeout();
+    void readPinoutSignals();
+    void readLineStatus();
+    void frameTimeout();
+
+private:
+    void setOpen(bool value);
+    void resetStatistics();
+    void updateBytesToWrite();
+    void received(const QByteArray &data, qint64 timestamp);
+    void deliverFrames(qint64 timestamp);
+    void flush();
+    void enqueue(Capture::Direction direction, const QByteArray &data, qint64 timestamp, Crc::Check check = Crc::CheckNone);
+    Crc::Check verify(const QByteArray &frame);
+    void respond(const QByteArray &data);
+    void capture(Capture::Direction direction, qint64 timestamp, const char *data, qint64 size);
+    QString deviceName() const;
+    QString errorString() const;
+
+    Connection::Settings m_settings;
+    QSerialPort *m_serial = nullptr;
+    QTcpSocket *m_tcp = nullptr;
+    QUdpSocket *m_udp = nullptr;
+    QTimer *m_timerWrite = nullptr;
+    QTimer *m_timerFlush = nullptr;
+    QTimer *m_timerSerialSignals = nullptr;
+    QTimer *m_timerFrame = nullptr;
+    qint64 m_bytesToWrite = 0;
+    QSerialPort::PinoutSignals m_pinout;
+    qint64 m_lineCounts[LineErrorCount];            // Linux - показания драйвера при открытии, Windows - накопленные
+
+    Framer m_framer;
+    Framer::Frames m_frames;                        // готовые кадры, ёмкость сохраняется между блоками
+    Responder m_responder;
+    QVector<int> m_matches;                         // сработавшие правила блока
+    quint64 m_responderEpoch = 0;                   // отложенные ответы прежних правил и подключений не отправляются
+    CaptureWriter m_capture;
+    SessionLog *m_sessionLog = nullptr;
+    std::deque<Chunk> m_pending;                    // блоки, не поместившиеся в очередь
+    SpscQueue<Chunk, TRANSPORT_QUEUE_SIZE> m_queue;
+    std::atomic<bool> m_notified{false};
+    std::atomic<bool> m_open{false};
+
+    // статистика: запись - поток транспорта, чтение - любой поток
+    std::atomic<qint64> m_bytes[2] = {{0}, {0}};
+    std::atomic<qint64> m_blocks[2] = {{0}, {0}};
+    std::atomic<qint64> m_bytesToWriteShared{0};
+    std::atomic<qint64> m_outputQueue{-1};
+    std::atomic<qint64> m_lineErrors[LineErrorCount] = {{-1}, {-1}, {-1}, {-1}};
+    std::atomic<qint64> m_pendingShared{0};         // m_pending.size()
+    std::atomic<qint64> m_badFrames{0};
+    std::atomic<qint64> m_crcOk{0};
+    std::atomic<qint64> m_crcFailed{0};
+    std::atomic<qint64> m_crcBytes{0};
+    std::atomic<qint64> m_responses{0};
+};
+
+#endif // TRANSPORT_H